@@ -0,0 +1,377 @@
+#include "agent.h"
+#include "parsers.h"
+#include "positions.h"
+#include "localization.h"
+#include "decisions.h"
+#include "intercept.h"
+#include "comm.h"
+#include "log.h"
+#include <algorithm>
+#include <cerrno>
+#include <cmath>
+#include <sys/epoll.h>
+#include <sys/timerfd.h>
+#include <unistd.h>
+#include <vector>
+
+Agent::~Agent()
+{
+    if (timerFd >= 0)
+        close(timerFd);
+}
+
+bool startAgent(Agent &agent, const std::string &team, std::uint16_t port,
+                const UdpAddress &server, std::int64_t send_offset_ns)
+{
+    agent.team = team;
+    agent.port = port;
+    agent.server = server;
+    agent.player.team = team;
+    agent.clock = CycleClock(send_offset_ns);
+    agent.metrics.team = team;
+    agent.metrics.port = port;
+
+    logSetContext(port);
+    LOG_INFO("Creating a UDP socket on local port {}", port);
+    if (!agent.socket.open(port)) {
+        LOG_ERROR("Error opening socket");
+        return false;
+    }
+    LOG_INFO("Socket created");
+
+    agent.timerFd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+    if (agent.timerFd < 0) {
+        LOG_ERROR("Error creating cycle timer");
+        return false;
+    }
+
+    sendInitCommand(agent.socket, agent.server, team, agent.goalie);
+    LOG_INFO("Waiting for an init message from server...");
+    return true;
+}
+
+// Programa el temporizador en el instante de envío del ciclo actual
+static void armCycleTimer(Agent &agent)
+{
+    std::int64_t deadline = agent.clock.sendDeadline();
+    itimerspec spec{};
+    spec.it_value.tv_sec = deadline / 1'000'000'000;
+    spec.it_value.tv_nsec = deadline % 1'000'000'000;
+    timerfd_settime(agent.timerFd, TFD_TIMER_ABSTIME, &spec, nullptr);
+}
+
+// Con el balón controlado, encarga la búsqueda de la cadena de acciones hasta
+// poco antes del envío del ciclo
+static void startPlanning(Agent &agent)
+{
+    if (agent.planner && agent.initialized && hasBall(agent.player))
+        agent.plan.submit(*agent.planner, PlanWorld::from(agent.player), agent.clock.sendDeadline() - PLAN_GUARD_NS);
+}
+
+static void handleSeeMsg(Agent &agent, std::string_view msg)
+{
+    PlayerInfo &player = agent.player;
+
+    LOG_DEBUG("Received message: {}", msg);
+    std::int64_t t0 = monotonicNowNs();
+    parseSeeMsg(msg, player);
+    std::int64_t t1 = monotonicNowNs();
+    LOG_DEBUG("SeeInfo(time={}, ball=({}, {}, {}), flags={}, lines={}, players={})",
+              player.see.time, player.see.ball.dist, player.see.ball.dir, player.see.ball.visible,
+              player.see.numFlags, player.see.numLines, player.see.players.size);
+    // Posición y orientación a partir de todas las banderas vistas (ya parseadas en player.see)
+    PoseEstimate pose = localize(player.see.visibleFlags());
+    agent.metrics.record(MetricStage::Parse, t1 - t0);
+    agent.metrics.record(MetricStage::Localize, monotonicNowNs() - t1);
+    if (player.see.time < agent.lastServerTime)
+        agent.metrics.add(MetricCounter::StaleSees);
+
+    if (pose.valid) {
+        // Actualizar la posición y la orientación del jugador
+        player.x_abs = static_cast<float>(pose.pos.x);
+        player.y_abs = static_cast<float>(pose.pos.y);
+        // La pose da la dirección de la cara; el cuerpo está head_angle más allá (sentido horario)
+        player.dir_abs = static_cast<float>(normalizaAngulo(pose.dir + player.sense.headAngle));
+
+        LOG_INFO("Pos: ({}, {}) | Dir: {}º | flags={} rejected={} sigma=({}, {}, {}º)",
+                 pose.pos.x, pose.pos.y, pose.dir, pose.flagsUsed, pose.flagsRejected,
+                 std::sqrt(pose.covXX), std::sqrt(pose.covYY), std::sqrt(pose.varDir));
+    }
+    agent.motion.onSee(player, pose.valid);
+    agent.view.onSee(player);
+    agent.metrics.add(MetricCounter::Sees);
+    agent.freshEstimate = true;  // Actuar en el próximo envío con la pose recién observada
+    agent.estimateReceiveNs = agent.receiveNs;
+    startPlanning(agent);
+}
+
+// Parámetros del servidor y tipo actual del jugador para la estima de movimiento
+// (el tipo 0 de rcssserver mientras no lleguen sus player_type)
+static void configureMotion(Agent &agent)
+{
+    PlayerTypeParams type{};
+    for (const PlayerTypeParams &t : agent.playerTypes) {
+        if (t.id == agent.player.playerType)
+            type = t;
+    }
+    agent.motion.configure(agent.serverParams, type);
+}
+
+// Goles del marcador del árbitro (goal_l_N, goal_r_N) en los contadores: el
+// resultado del partido sin depender de los registros del servidor
+static void countGoals(Agent &agent, int left, int right)
+{
+    const bool weAreLeft = agent.player.side == Side::Left;
+    if (left > 0)
+        agent.metrics.add(weAreLeft ? MetricCounter::GoalsFor : MetricCounter::GoalsAgainst, static_cast<std::uint64_t>(left));
+    if (right > 0)
+        agent.metrics.add(weAreLeft ? MetricCounter::GoalsAgainst : MetricCounter::GoalsFor, static_cast<std::uint64_t>(right));
+}
+
+void handleServerMessage(Agent &agent, std::string_view msg, const UdpAddress &sender)
+{
+    if (agent.trace.isOpen())
+        agent.trace.record(TraceDirection::In, monotonicNowNs(), msg);
+
+    if (msg.rfind("(see", 0) == 0) {
+        handleSeeMsg(agent, msg);
+    } else if (msg.rfind("(sense_body", 0) == 0) {
+        // Inicio de ciclo: reajustar la fase y programar el envío
+        agent.clock.onSenseBody(monotonicNowNs());
+        agent.senseReceiveNs = agent.receiveNs;
+        if (!agent.synch)
+            armCycleTimer(agent);
+
+        const CycleStats &st = agent.clock.stats();
+        if (st.cycles % 100 == 0) {
+            LOG_INFO("[CYCLE] cycles={} sent={} noCommand={} duplicates={} staleDropped={} logDropped={}",
+                     st.cycles, st.commandsSent, st.cyclesWithoutCommand, st.duplicateCommands,
+                     agent.receiver.stats().totalDropped(), logDroppedCount());
+        }
+        agent.trace.flush();
+        agent.metrics.publish(st, agent.receiver.stats());
+
+        // Estima a estima: proyectar pose y balón para decidir también en los ciclos sin see
+        std::int64_t t0 = monotonicNowNs();
+        parseSenseMsg(msg, agent.player);
+        agent.metrics.record(MetricStage::Parse, monotonicNowNs() - t0);
+
+        // Un salto en el tiempo del servidor son ciclos cuyo sense_body no llegó
+        int time = agent.player.sense.time;
+        if (agent.lastServerTime >= 0 && time > agent.lastServerTime + 1)
+            agent.metrics.add(MetricCounter::MissedCycles, static_cast<std::uint64_t>(time - agent.lastServerTime - 1));
+        agent.lastServerTime = std::max(agent.lastServerTime, time);
+
+        if (agent.motion.onSenseBody(agent.player)) {
+            agent.freshEstimate = true;
+            agent.estimateReceiveNs = agent.receiveNs;
+            startPlanning(agent);
+        }
+        LOG_DEBUG("SenseInfo(time={}, stamina={}, speed={}, headAngle={}) | Pos: ({}, {}) | Dir: {}º",
+                  agent.player.sense.time, agent.player.sense.stamina, agent.player.sense.speed,
+                  agent.player.sense.headAngle, agent.player.x_abs, agent.player.y_abs, agent.player.dir_abs);
+    } else if (msg.rfind("(hear", 0) == 0) {
+        LOG_DEBUG("Received message: {}", msg);
+        std::int64_t t0 = monotonicNowNs();
+        const int scoreLeft = agent.gameState.scoreLeft, scoreRight = agent.gameState.scoreRight;
+        parseHearMsg(msg, agent.player, agent.gameState);
+        agent.motion.onHear(agent.player, agent.gameState.time);
+        agent.metrics.record(MetricStage::Parse, monotonicNowNs() - t0);
+        countGoals(agent, agent.gameState.scoreLeft - scoreLeft, agent.gameState.scoreRight - scoreRight);
+        agent.lastServerTime = std::max(agent.lastServerTime, agent.gameState.time);
+        LOG_DEBUG("GameState(time: {}, playMode: {}, scoreLeft: {}, scoreRight: {})",
+                  agent.gameState.time, toString(agent.gameState.playMode),
+                  agent.gameState.scoreLeft, agent.gameState.scoreRight);
+    } else if (msg.rfind("(think", 0) == 0) {
+        // Fin de la percepción del ciclo: se decide al terminar el lote
+        agent.thinkPending = agent.synch;
+    } else if (msg.rfind("(server_param", 0) == 0) {
+        parseServerParam(msg, agent.serverParams);
+        configureMotion(agent);
+    } else if (msg.rfind("(player_param", 0) == 0) {
+        parsePlayerParam(msg, agent.serverParams);
+    } else if (msg.rfind("(player_type", 0) == 0) {
+        // Llegan tras el init, uno por tipo: con el último se construyen las tablas de alcance
+        PlayerTypeParams type;
+        parsePlayerType(msg, type);
+        agent.playerTypes.push_back(type);
+        if (agent.playerTypes.size() == static_cast<std::size_t>(agent.serverParams.playerTypes)) {
+            configureInterceptModel(agent.serverParams, agent.playerTypes);
+            configureMotion(agent);
+        }
+    } else if (msg.rfind("(change_player_type", 0) == 0) {
+        parseChangePlayerTypeMsg(msg, agent.player);
+        configureMotion(agent);
+        LOG_INFO("Player type change: {} (own type {})", msg, static_cast<int>(agent.player.playerType));
+    } else if (!agent.initialized && msg.rfind("(init", 0) == 0) {
+        LOG_INFO("Received message: {}", msg);
+
+        // Usar el puerto específico del servidor para las comunicaciones posteriores
+        agent.server.port = sender.port;
+
+        // Parsear el mensaje de inicialización y configurar el jugador
+        parseInitMsg(msg, agent.player, agent.gameState);
+        agent.initialized = true;
+        LOG_INFO("Player(team: {}, side: {}, number: {}, initialPosition: ({}, {}))",
+                 agent.player.team, toString(agent.player.side), agent.player.number,
+                 agent.player.initialPosition.x, agent.player.initialPosition.y);
+
+        // El see llega con el sense_body (también en modo asíncrono): el
+        // planificador de la vista cuenta con sees alineados con el ciclo
+        sendMoveCommand(agent.socket, agent.server, agent.player);
+        sendSynchSeeCommand(agent.socket, agent.server);
+    }
+
+    if (agent.receiveNs > 0)
+        agent.metrics.record(MetricStage::Handle, monotonicNowNs() - agent.receiveNs);
+}
+
+CommandFrame decideCycleCommands(Agent &agent)
+{
+    CommandFrame frame;
+
+    // Sin estimación nueva (ni see ni sense_body) no hay decisión (el ciclo queda sin comando)
+    if (!agent.initialized || !agent.freshEstimate)
+        return frame;
+
+    // Con el balón: la mejor cadena encontrada hasta ahora (o una búsqueda corta aquí)
+    const ActionChain *plan = nullptr;
+    if (hasBall(agent.player)) {
+        PlanStats stats;
+        plan = &agent.plan.collect(agent.player, stats);
+        agent.metrics.record(MetricStage::Plan, stats.ns);
+        agent.metrics.add(MetricCounter::PlanSearches);
+        agent.metrics.add(MetricCounter::PlanNodes, stats.nodes);
+        agent.metrics.add(MetricCounter::PlanNs, static_cast<std::uint64_t>(std::max<std::int64_t>(stats.ns, 0)));
+        agent.metrics.add(MetricCounter::PlanDepth, static_cast<std::uint64_t>(stats.depth));
+        if (!plan->empty()) {
+            LOG_DEBUG("[PLAN] nodes={} depth={} us={} first={} value={}", stats.nodes, stats.depth, stats.ns / 1000,
+                      toString(plan->actions[0].kind), plan->value);
+        }
+    }
+
+    frame.body = decideAction(agent.player, agent.gameState, plan);
+
+    // Antigüedad del balón sobre el que se ha decidido
+    const BallEstimate &ball = agent.motion.ball();
+    if (ball.valid) {
+        agent.metrics.add(MetricCounter::BallKnown);
+        agent.metrics.add(MetricCounter::BallAgeSum, static_cast<std::uint64_t>(std::max(agent.player.sense.time - ball.time, 0)));
+    } else {
+        agent.metrics.add(MetricCounter::BallUnknown);
+    }
+
+    agent.view.decide(agent.player, agent.motion, frame);
+
+    // Un compañero habla en cada ciclo: el balón o los rivales que tiene a la vista
+    int time = agent.player.sense.time;
+    if (isSayTurn(time, agent.player.number))
+        frame.say = composeSay(agent.player, agent.motion.ball(), time);
+    agent.freshEstimate = false;
+    return frame;
+}
+
+void onCycleDeadline(Agent &agent)
+{
+    std::int64_t t0 = monotonicNowNs();
+    CommandFrame frame = decideCycleCommands(agent);
+    std::int64_t t1 = monotonicNowNs();
+
+    if (frame.empty()) {
+        if (agent.initialized)
+            agent.metrics.add(MetricCounter::EmptyDecisions);
+        return;
+    }
+    agent.metrics.record(MetricStage::Decide, t1 - t0);
+
+    if (!frame.body.empty() && agent.clock.claimSend()) {
+        sendCommandFrame(agent.socket, agent.server, frame);
+        std::int64_t sent = monotonicNowNs();
+        agent.metrics.record(MetricStage::Send, sent - t1);
+        if (agent.estimateReceiveNs > 0)
+            agent.metrics.record(MetricStage::ReceiveToSend, sent - agent.estimateReceiveNs);
+        if (agent.senseReceiveNs > 0)
+            agent.metrics.record(MetricStage::CycleToSend, sent - agent.senseReceiveNs);
+        agent.motion.onCommandSent(frame.body);
+
+        if (agent.trace.isOpen()) {
+            char buf[COMMAND_MAX_SIZE];
+            std::size_t n = frame.serialize(buf, sizeof(buf));
+            agent.trace.record(TraceDirection::Out, monotonicNowNs(), std::string_view(buf, n));
+        }
+    }
+}
+
+void onThink(Agent &agent)
+{
+    agent.thinkPending = false;
+    onCycleDeadline(agent);
+    sendDoneCommand(agent.socket, agent.server);
+    if (agent.receiveNs > 0)
+        agent.metrics.record(MetricStage::Think, monotonicNowNs() - agent.receiveNs);
+}
+
+// Registro en epoll: a qué agente pertenece el descriptor y de qué tipo es
+struct LoopSource
+{
+    Agent *agent;
+    bool isTimer;
+};
+
+int runAgentLoop(std::span<Agent *const> agents)
+{
+    int epfd = epoll_create1(EPOLL_CLOEXEC);
+    if (epfd < 0) {
+        LOG_ERROR("Error creating epoll instance");
+        return 1;
+    }
+
+    std::vector<LoopSource> sources;
+    sources.reserve(agents.size() * 2);
+    for (Agent *agent : agents) {
+        sources.push_back({agent, false});
+        sources.push_back({agent, true});
+    }
+    for (auto &src : sources) {
+        epoll_event ev{};
+        ev.events = EPOLLIN;
+        ev.data.ptr = &src;
+        int fd = src.isTimer ? src.agent->timerFd : src.agent->socket.fd();
+        epoll_ctl(epfd, EPOLL_CTL_ADD, fd, &ev);
+    }
+
+    std::vector<epoll_event> events(sources.size());
+
+    // Bucle principal: despertar con cada datagrama o con el vencimiento del ciclo
+    while (true) {
+        int n = epoll_wait(epfd, events.data(), static_cast<int>(events.size()), -1);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            LOG_ERROR("Error waiting for events");
+            break;
+        }
+
+        for (int i = 0; i < n; ++i) {
+            auto *src = static_cast<LoopSource *>(events[i].data.ptr);
+            Agent &agent = *src->agent;
+            logSetContext(agent.port);
+            if (!src->isTimer) {
+                // Vaciar la cola del socket quedándonos con la percepción más reciente.
+                // La recepción se fecha al despertar, antes de leer el lote.
+                agent.receiveNs = monotonicNowNs();
+                agent.receiver.drain(agent.socket, [&agent](std::string_view msg, const UdpAddress &sender) {
+                    handleServerMessage(agent, msg, sender);
+                });
+                if (agent.thinkPending)
+                    onThink(agent);
+            } else {
+                std::uint64_t expirations;
+                if (read(agent.timerFd, &expirations, sizeof(expirations)) > 0)
+                    onCycleDeadline(agent);
+            }
+        }
+    }
+
+    close(epfd);
+    return 1;
+}
@@ -0,0 +1,87 @@
+#pragma once
+
+#include "types.h"
+#include "net.h"
+#include "cycle.h"
+#include "motion.h"
+#include "trace.h"
+#include "metrics.h"
+#include "planner.h"
+#include "view.h"
+#include <cstdint>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Tamaño de línea de caché: cada agente empieza en su propia línea para que
+// los hilos del runtime no compartan líneas al escribir estados distintos
+inline constexpr std::size_t CACHE_LINE_SIZE = 64;
+
+// Estado completo de un jugador conectado al servidor
+struct alignas(CACHE_LINE_SIZE) Agent
+{
+    Agent() = default;
+    ~Agent();
+    Agent(const Agent &) = delete;
+    Agent &operator=(const Agent &) = delete;
+
+    std::string team;
+    std::uint16_t port{0};
+    bool goalie{false};       // Se presenta como portero en el (init ...)
+
+    UdpSocket socket;
+    ServerReceiver receiver;  // Búfer de recepción reutilizado entre ciclos
+    UdpAddress server{};      // Puerto 6000 hasta el init; después, el puerto propio que asigna el servidor
+    int timerFd{-1};          // timerfd que marca el instante de envío dentro del ciclo
+
+    PlayerInfo player{};
+    GameState gameState{};
+    CycleClock clock{};
+    MotionModel motion{};     // Proyección de la pose entre dos see
+    ViewScheduler view{};     // Anchura de vista y cuello para el próximo see
+    TraceWriter trace;        // Grabación del tráfico (sólo si se pide con --record)
+    AgentMetrics metrics;     // Latencias por etapa y contadores, servidos por el runtime
+
+    // Instantes de recepción (monotónicos, ns) para las latencias de extremo a extremo
+    std::int64_t receiveNs{0};          // despertar con datagramas pendientes (0 sin socket, ej: replay)
+    std::int64_t senseReceiveNs{0};     // sense_body del ciclo actual
+    std::int64_t estimateReceiveNs{0};  // datagrama que produjo la estimación pendiente de decidir
+    int lastServerTime{-1};             // último tiempo del servidor visto en sense_body o hear
+
+    PlannerPool *planner{nullptr};  // Grupo de búsqueda del proceso; sin él se planifica al decidir
+    PlanJob plan;                   // Búsqueda de la cadena de acciones con balón del ciclo
+
+    ServerParams serverParams{};              // server_param y player_param
+    std::vector<PlayerTypeParams> playerTypes;  // player_type recibidos; completos, configuran la intercepción
+
+    bool initialized{false};  // Se ha recibido (init ...)
+    bool freshEstimate{false};  // Hay una pose nueva (see o sense_body) desde la última decisión
+
+    // Modo síncrono del servidor (synch_mode): no hay temporizador; se decide al
+    // recibir (think) y se contesta (done) para que el servidor avance
+    bool synch{false};
+    bool thinkPending{false};  // Llegó (think) en el lote de datagramas en curso
+};
+
+// Abre el socket y el temporizador del agente y envía el (init ...)
+bool startAgent(Agent &agent, const std::string &team, std::uint16_t port,
+                const UdpAddress &server, std::int64_t send_offset_ns);
+
+// Procesa un mensaje recibido del servidor (init, see, sense_body, hear...)
+void handleServerMessage(Agent &agent, std::string_view msg, const UdpAddress &sender);
+
+// Decide los comandos del ciclo a partir de la estimación actual. Devuelve un
+// frame vacío si no hay estimación nueva desde la última decisión.
+CommandFrame decideCycleCommands(Agent &agent);
+
+// Llamado cuando vence el temporizador del ciclo: decide y envía un único comando
+void onCycleDeadline(Agent &agent);
+
+// Modo síncrono: tras procesar el lote que trae (think), decide, envía y cierra con (done)
+void onThink(Agent &agent);
+
+// Bucle de eventos de uno o varios agentes: epoll sobre los sockets y los
+// timerfd de ciclo de todos ellos (en modo síncrono, sólo los sockets).
+// No retorna salvo error.
+int runAgentLoop(std::span<Agent *const> agents);
@@ -0,0 +1,37 @@
+#pragma once
+
+#include <charconv>
+#include <cstdint>
+#include <limits>
+#include <string>
+#include <string_view>
+#include <system_error>
+
+// Lectura de opciones numéricas de la línea de comandos sin excepciones
+// (std::from_chars): un error de escritura en un argumento se contesta con
+// el uso del programa, no con std::terminate.
+
+// Convierte todo text en out si es un número dentro de [lo, hi]; si no,
+// devuelve false y deja out como estaba
+template <typename T>
+bool parseArg(std::string_view text, T &out, T lo = std::numeric_limits<T>::lowest(),
+              T hi = std::numeric_limits<T>::max())
+{
+    T value{};
+    const char *end = text.data() + text.size();
+    auto [ptr, ec] = std::from_chars(text.data(), end, value);
+    if (text.empty() || ec != std::errc{} || ptr != end || value < lo || value > hi)
+        return false;
+    out = value;
+    return true;
+}
+
+// "nombre[:puerto]" (un host o un equipo): port se queda con su valor si no se indica
+inline bool parseNameAndPort(std::string_view text, std::string &name, std::uint16_t &port)
+{
+    auto colon = text.find(':');
+    name = std::string(text.substr(0, colon));
+    if (colon == std::string_view::npos)
+        return !name.empty();
+    return !name.empty() && parseArg<std::uint16_t>(text.substr(colon + 1), port, 1);
+}
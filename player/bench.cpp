@@ -0,0 +1,681 @@
+// player_bench: microbenchmarks del pipeline parse -> localize -> decide.
+//
+// Mide cada función caliente por separado y el pipeline completo sobre un
+// corpus de mensajes con distinta visibilidad (pocas banderas, campo completo,
+// muchos jugadores) y, opcionalmente, sobre una grabación de --record.
+// Compara además los kernels geométricos por lotes con las funciones escalares,
+// comprueba la cota de error de sus aproximaciones y el error de la
+// localización frente a la pose real en vistas sintéticas, mide la intercepción de
+// todo el campo con tipos heterogéneos, los nodos/s del planificador y el
+// códec de say.
+// Informa ns/op y reservas de memoria/op, puede escribir JSON y comparar con
+// una línea base guardada (falla si alguna etapa empeora más de la tolerancia).
+//
+//   player_bench [--corpus grabacion.rstrace] [--json salida.json]
+//                [--compare base.json] [--tolerance 0.15] [--min-time-ms 100]
+//                [--formation formation.conf]
+#include "args.h"
+#include "parsers.h"
+#include "positions.h"
+#include "localization.h"
+#include "decisions.h"
+#include "command.h"
+#include "flags.h"
+#include "trace.h"
+#include "formation.h"
+#include "geometry.h"
+#include "intercept.h"
+#include "planner.h"
+#include "comm.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <new>
+#include <random>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// --- Contador de reservas ------------------------------------------------------
+
+static std::atomic<std::uint64_t> allocations{0};
+
+void *operator new(std::size_t size)
+{
+    allocations.fetch_add(1, std::memory_order_relaxed);
+    if (void *p = std::malloc(size ? size : 1))
+        return p;
+    throw std::bad_alloc();
+}
+
+void operator delete(void *p) noexcept { std::free(p); }
+void operator delete(void *p, std::size_t) noexcept { std::free(p); }
+
+// Impide que el compilador elimine un resultado que no se usa
+template <typename T>
+static void keep(const T &value)
+{
+    asm volatile("" : : "r"(&value) : "memory");
+}
+
+// --- Corpus ------------------------------------------------------------------
+
+struct CorpusMessage
+{
+    std::string name;
+    std::string see;
+};
+
+// Mensaje see en el formato del servidor (versión 19) visto desde una pose:
+// banderas dentro del cono de visión, el balón y numPlayers jugadores
+static std::string makeSeeMessage(int time, Point pos, double face, double halfView, int numPlayers)
+{
+    std::string msg = "(see " + std::to_string(time);
+    char buf[128];
+
+    auto relative = [&](Point p, double &dist, double &dir) {
+        double dx = p.x - pos.x, dy = p.y - pos.y;
+        dist = std::round(std::hypot(dx, dy) * 10) / 10;
+        dir = -std::round(normalizaAngulo(std::atan2(dy, dx) * 180.0 / M_PI - face));
+        return std::fabs(dir) <= halfView;
+    };
+
+    double dist, dir;
+    for (const FlagDef &f : FLAG_TABLE) {
+        if (!relative(f.pos, dist, dir))
+            continue;
+        std::snprintf(buf, sizeof(buf), " ((%.*s) %.1f %.0f)", static_cast<int>(f.name.size()), f.name.data(), dist, dir);
+        msg += buf;
+    }
+
+    if (relative({pos.x + 8, pos.y - 3}, dist, dir)) {
+        std::snprintf(buf, sizeof(buf), " ((b) %.1f %.0f -0.2 1.5)", dist, dir);
+        msg += buf;
+    }
+
+    for (int i = 0; i < numPlayers; ++i) {
+        Point p{pos.x + 4.0 + 3.0 * (i % 6), pos.y - 15.0 + 5.0 * (i / 2 % 6)};
+        if (!relative(p, dist, dir))
+            continue;
+        const char *team = (i % 2) ? "RayoCayetano" : "RealSuciedad";
+        std::snprintf(buf, sizeof(buf), " ((p \"%s\" %d%s) %.1f %.0f 0.1 -0.5 %d 0)",
+                      team, i / 2 + 1, i == 1 ? " goalie" : "", dist, dir, 10 * (i % 7) - 30);
+        msg += buf;
+    }
+
+    if (relative({52.5, pos.y}, dist, dir)) {
+        std::snprintf(buf, sizeof(buf), " ((l r) %.1f %.0f)", dist, dir);
+        msg += buf;
+    }
+    msg += ")";
+    return msg;
+}
+
+static std::vector<CorpusMessage> builtinCorpus()
+{
+    return {
+        // Cerca de la banda mirando fuera: sólo un puñado de banderas
+        {"few_flags", "(see 120 ((f t r 30) 21.3 -17) ((f t r 40) 28.5 -5 0 0) ((f r t) 42.1 20) ((b) 14.9 31 -0.3 2.1))"},
+        {"normal_view", makeSeeMessage(240, {-10.0, 5.0}, 5.0, 45.0, 4)},
+        {"full_field", makeSeeMessage(360, {-40.0, 0.0}, 0.0, 90.0, 0)},
+        {"many_players", makeSeeMessage(480, {-20.0, 0.0}, 0.0, 90.0, 22)},
+    };
+}
+
+static constexpr std::string_view SENSE_MSG =
+    "(sense_body 240 (view_mode high normal) (stamina 7632.5 0.93 125400) (speed 0.42 -8) "
+    "(head_angle 0) (kick 12) (dash 183) (turn 41) (say 0) (turn_neck 0) (catch 0) (move 1) "
+    "(change_focus 0) (change_view 0) (arm (movable 0) (expires 0) (target 0 0) (count 0)) "
+    "(focus (target none) (count 0)) (tackle (expires 0) (count 0)) (collision none) "
+    "(foul  (charged 0) (card none)) (focus_point 0 0))";
+
+static constexpr std::string_view HEAR_MSG = "(hear 240 referee kick_in_l)";
+
+// --- Medición ----------------------------------------------------------------
+
+struct BenchResult
+{
+    std::string name;
+    double nsPerOp{0};
+    double allocsPerOp{0};
+};
+
+static double minTimeMs = 100.0;
+
+// Ejecuta f en lotes hasta sumar minTimeMs; repite 5 veces y se queda con el mejor lote
+template <typename F>
+static BenchResult run(const std::string &name, F &&f)
+{
+    std::uint64_t iters = 1;
+    while (true) {
+        auto t0 = std::chrono::steady_clock::now();
+        for (std::uint64_t i = 0; i < iters; ++i) f();
+        double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+        if (ms >= minTimeMs / 10 || iters >= (1ull << 30)) break;
+        iters *= 4;
+    }
+
+    double best = 1e300;
+    std::uint64_t allocs = 0;
+    for (int rep = 0; rep < 5; ++rep) {
+        std::uint64_t a0 = allocations.load(std::memory_order_relaxed);
+        auto t0 = std::chrono::steady_clock::now();
+        for (std::uint64_t i = 0; i < iters * 2; ++i) f();
+        double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - t0).count();
+        allocs = allocations.load(std::memory_order_relaxed) - a0;
+        best = std::min(best, ns / static_cast<double>(iters * 2));
+    }
+
+    BenchResult r{name, best, static_cast<double>(allocs) / static_cast<double>(iters * 2)};
+    std::printf("%-36s %12.1f ns/op %10.2f allocs/op\n", r.name.c_str(), r.nsPerOp, r.allocsPerOp);
+    return r;
+}
+
+static void benchMessage(const CorpusMessage &m, std::vector<BenchResult> &out)
+{
+    const std::string prefix = m.name + "/";
+
+    PlayerInfo player;
+    player.team = "RealSuciedad";
+    player.side = Side::Left;
+    player.number = 9;
+    player.initialPosition = calcKickOffPosition(player.number);
+    GameState game;
+    game.playMode = PlayMode::PlayOn;
+
+    parseSeeMsg(m.see, player);
+    std::vector<FlagInfo> flags(player.see.visibleFlags().begin(), player.see.visibleFlags().end());
+    auto best = getTwoBestFlags(std::span<const FlagInfo>(flags));
+    Point p1 = flagPosition(best.first.id), p2 = flagPosition(best.second.id);
+    Point last{-10.0, 0.0};
+
+    out.push_back(run(prefix + "parseSeeMsg", [&] { parseSeeMsg(m.see, player); keep(player.see); }));
+    out.push_back(run(prefix + "parseVisibleFlags", [&] {
+        std::array<FlagInfo, SeeInfo::MAX_FLAGS> v;
+        std::size_t n = parseVisibleFlags(m.see, v);
+        keep(n);
+        keep(v);
+    }));
+    out.push_back(run(prefix + "getTwoBestFlags", [&] {
+        auto r = getTwoBestFlags(std::span<const FlagInfo>(flags));
+        keep(r);
+    }));
+    out.push_back(run(prefix + "corteCircunferencias", [&] {
+        std::array<Point, 2> pts;
+        int n = corteCircunferencias(p1.x, p1.y, best.first.dist, p2.x, p2.y, best.second.dist, pts);
+        keep(n);
+        keep(pts);
+    }));
+    out.push_back(run(prefix + "calcularPosicionJugador", [&] {
+        Point r = calcularPosicionJugador(best, last);
+        keep(r);
+    }));
+    out.push_back(run(prefix + "localize", [&] {
+        PoseEstimate e = localize(std::span<const FlagInfo>(flags));
+        keep(e);
+    }));
+    out.push_back(run(prefix + "formationLookup", [&] {
+        FormationSlot s = activeFormation().lookup(player.side, FormationSet::PlayOn, {12.0, -7.0}, player.number);
+        keep(s);
+    }));
+    out.push_back(run(prefix + "decideAction", [&] { Command c = decideAction(player, game); keep(c); }));
+
+    // Pipeline completo de un see: parsear, localizarse, decidir y serializar
+    out.push_back(run(prefix + "end_to_end", [&] {
+        parseSeeMsg(m.see, player);
+        PoseEstimate e = localize(player.see.visibleFlags());
+        if (e.valid) {
+            player.x_abs = static_cast<float>(e.pos.x);
+            player.y_abs = static_cast<float>(e.pos.y);
+            player.dir_abs = static_cast<float>(e.dir);
+        }
+        CommandFrame frame;
+        frame.body = decideAction(player, game);
+        char buf[COMMAND_MAX_SIZE];
+        std::size_t n = frame.serialize(buf, sizeof(buf));
+        keep(n);
+        keep(buf);
+    }));
+}
+
+// --- Geometría por lotes ----------------------------------------------------------
+
+static constexpr std::size_t GEOMETRY_TARGETS = 64;
+
+// Error máximo de las aproximaciones rápidas frente a libm; false si supera la cota documentada
+static bool checkGeometryError()
+{
+    double atanErr = 0, sinCosErr = 0;
+    for (int i = 0; i < 720; ++i) {
+        for (double r : {0.01, 1.0, 37.5, 110.0}) {
+            double a = (i * 0.5 - 180.0 + 0.123) * M_PI / 180.0;
+            float y = static_cast<float>(r * std::sin(a)), x = static_cast<float>(r * std::cos(a));
+            double ref = std::atan2(static_cast<double>(y), static_cast<double>(x)) * 180.0 / M_PI;
+            atanErr = std::max(atanErr, std::fabs(normalizaAngulo(fastAtan2Deg(y, x) - ref)));
+        }
+    }
+    for (int i = -3600; i <= 3600; ++i) {
+        float deg = static_cast<float>(i) * 0.25f + 0.07f;
+        float s, c;
+        fastSinCosDeg(deg, s, c);
+        double a = static_cast<double>(deg) * M_PI / 180.0;
+        sinCosErr = std::max({sinCosErr, std::fabs(s - std::sin(a)), std::fabs(c - std::cos(a))});
+    }
+
+    bool ok = atanErr <= FAST_ATAN2_MAX_ERROR_DEG && sinCosErr <= FAST_SINCOS_MAX_ERROR;
+    std::printf("geometry: %s x%zu, atan2 max error %.2e deg (bound %.0e), sincos %.2e (bound %.0e)%s\n",
+                geometryIsa(), geometryLanes(), atanErr, FAST_ATAN2_MAX_ERROR_DEG, sinCosErr, FAST_SINCOS_MAX_ERROR,
+                ok ? "" : "  OUT OF BOUNDS");
+    return ok;
+}
+
+// --- Precisión de la localización ----------------------------------------------
+
+static constexpr int LOCALIZATION_VIEWS = 20'000;
+static constexpr double QUANTIZE_STEP_LANDMARK = 0.01;
+
+// Cuantización de distancias de rcssserver: log(d) en pasos de qstep, luego 0.1
+static double quantizeDist(double d, double qstep)
+{
+    double q = std::exp(std::rint(std::log(d + 1e-10) / qstep) * qstep);
+    return std::rint(q / 0.1) * 0.1;
+}
+
+// Error medio de posición (m) y de orientación (grados) frente a la pose real
+struct PoseError
+{
+    double pos{0.0};
+    double dir{0.0};
+    int n{0};
+
+    void add(Point est, double estDir, Point truth, double truthDir)
+    {
+        pos += std::hypot(est.x - truth.x, est.y - truth.y);
+        dir += std::fabs(normalizaAngulo(estDir - truthDir));
+        ++n;
+    }
+    double meanPos() const { return n ? pos / n : 0.0; }
+    double meanDir() const { return n ? dir / n : 0.0; }
+};
+
+// localize() frente a las dos mejores banderas (getTwoBestFlags +
+// calcularPosicionJugador + calcularOrientacion) sobre vistas sintéticas con
+// la cuantización del servidor (distancia logarítmica y 0.1 m, dirección a 1
+// grado), poses al azar con semilla fija y vista normal. Se repite con una
+// bandera por vista con la distancia corrompida. false si localize() es peor
+// que el método de dos banderas sin corrupción.
+static bool checkLocalizationError()
+{
+    std::mt19937 rng(20'000);
+    std::uniform_real_distribution<double> ux(-50.0, 50.0), uy(-32.0, 32.0), uface(-180.0, 180.0);
+    std::uniform_real_distribution<double> ucorrupt(5.0, 20.0);
+    PoseError wls, twoFlags, wlsCorrupt, twoFlagsCorrupt;
+
+    std::vector<FlagInfo> flags;
+    for (int v = 0; v < LOCALIZATION_VIEWS; ++v) {
+        const Point truth{ux(rng), uy(rng)};
+        const double face = uface(rng);
+        flags.clear();
+        for (std::size_t f = 0; f < FLAG_COUNT && flags.size() < SeeInfo::MAX_FLAGS; ++f) {
+            const Point pos = FLAG_TABLE[f].pos;
+            double dir = -normalizaAngulo(std::atan2(pos.y - truth.y, pos.x - truth.x) * 180.0 / M_PI - face);
+            if (std::fabs(dir) > 45.0)
+                continue;
+            double dist = quantizeDist(std::hypot(pos.x - truth.x, pos.y - truth.y), QUANTIZE_STEP_LANDMARK);
+            flags.push_back(FlagInfo{static_cast<FlagId>(f), dist, std::rint(dir), true, pos});
+        }
+        if (flags.size() < 3)
+            continue;
+
+        // El método de dos banderas parte de la pose real para elegir entre los dos cortes
+        auto measure = [&](PoseError &ls, PoseError &two) {
+            PoseEstimate e = localize(std::span<const FlagInfo>(flags));
+            if (e.valid)
+                ls.add(e.pos, e.dir, truth, face);
+            auto best = getTwoBestFlags(std::span<const FlagInfo>(flags));
+            Point p = calcularPosicionJugador(best, truth);
+            two.add(p, calcularOrientacion(p, best.first), truth, face);
+        };
+        measure(wls, twoFlags);
+
+        std::size_t bad = std::uniform_int_distribution<std::size_t>(0, flags.size() - 1)(rng);
+        flags[bad].dist += ucorrupt(rng);
+        measure(wlsCorrupt, twoFlagsCorrupt);
+    }
+
+    bool ok = wls.meanPos() <= twoFlags.meanPos() && wls.meanDir() <= twoFlags.meanDir();
+    std::printf("localization: %d views, mean error %.3f m / %.3f deg (two flags %.3f m / %.3f deg); "
+                "one corrupted flag %.3f m / %.3f deg (two flags %.3f m / %.3f deg)%s\n",
+                wls.n, wls.meanPos(), wls.meanDir(), twoFlags.meanPos(), twoFlags.meanDir(), wlsCorrupt.meanPos(),
+                wlsCorrupt.meanDir(), twoFlagsCorrupt.meanPos(), twoFlagsCorrupt.meanDir(), ok ? "" : "  WORSE THAN TWO FLAGS");
+    return ok;
+}
+
+// Las funciones escalares actuales (double, un objetivo por llamada) frente a
+// los kernels por lotes sobre GEOMETRY_TARGETS objetivos repartidos por el campo
+static void benchGeometry(std::vector<BenchResult> &out)
+{
+    const Point origin{-10.0, 5.0};
+    const double heading = 30.0;
+
+    alignas(32) std::array<float, GEOMETRY_TARGETS> x, y, dist, dir, outX, outY, angles;
+    std::array<double, GEOMETRY_TARGETS> dx, dy, ddist, ddir, dangles;
+    for (std::size_t i = 0; i < GEOMETRY_TARGETS; ++i) {
+        x[i] = static_cast<float>(-50.0 + 100.0 * static_cast<double>((i * 37) % GEOMETRY_TARGETS) / GEOMETRY_TARGETS);
+        y[i] = static_cast<float>(-32.0 + 64.0 * static_cast<double>((i * 11) % GEOMETRY_TARGETS) / GEOMETRY_TARGETS);
+        angles[i] = static_cast<float>(static_cast<double>(i) * 23.7 - 700.0);
+        dx[i] = x[i];
+        dy[i] = y[i];
+        dangles[i] = angles[i];
+    }
+    toPolar(origin, static_cast<float>(heading), x, y, dist, dir);
+    for (std::size_t i = 0; i < GEOMETRY_TARGETS; ++i) {
+        ddist[i] = dist[i];
+        ddir[i] = dir[i];
+    }
+
+    const std::string n = "/" + std::to_string(GEOMETRY_TARGETS);
+    out.push_back(run("geometry/scalar_polar" + n, [&] {
+        for (std::size_t i = 0; i < GEOMETRY_TARGETS; ++i) {
+            ddist[i] = std::hypot(dx[i] - origin.x, dy[i] - origin.y);
+            ddir[i] = normalizaAngulo(std::atan2(dy[i] - origin.y, dx[i] - origin.x) * 180.0 / M_PI - heading);
+        }
+        keep(ddist);
+        keep(ddir);
+    }));
+    out.push_back(run("geometry/batch_polar" + n, [&] {
+        toPolar(origin, static_cast<float>(heading), x, y, dist, dir);
+        keep(dist);
+        keep(dir);
+    }));
+    out.push_back(run("geometry/scalar_cartesian" + n, [&] {
+        for (std::size_t i = 0; i < GEOMETRY_TARGETS; ++i) {
+            double a = (ddir[i] + heading) * M_PI / 180.0;
+            dx[i] = origin.x + ddist[i] * std::cos(a);
+            dy[i] = origin.y + ddist[i] * std::sin(a);
+        }
+        keep(dx);
+        keep(dy);
+    }));
+    out.push_back(run("geometry/batch_cartesian" + n, [&] {
+        toCartesian(origin, static_cast<float>(heading), dist, dir, outX, outY);
+        keep(outX);
+        keep(outY);
+    }));
+    out.push_back(run("geometry/scalar_normalize" + n, [&] {
+        std::array<double, GEOMETRY_TARGETS> a;
+        for (std::size_t i = 0; i < GEOMETRY_TARGETS; ++i)
+            a[i] = normalizaAngulo(dangles[i]);
+        keep(a);
+    }));
+    out.push_back(run("geometry/batch_normalize" + n, [&] {
+        alignas(32) std::array<float, GEOMETRY_TARGETS> a;
+        std::memcpy(a.data(), angles.data(), sizeof(a));
+        normalizeAngles(a);
+        keep(a);
+    }));
+}
+
+// --- Intercepción -----------------------------------------------------------------
+
+// Tipos heterogéneos como los que genera el servidor a partir de los de por defecto
+static std::vector<PlayerTypeParams> benchPlayerTypes()
+{
+    std::vector<PlayerTypeParams> types(MAX_PLAYER_TYPES);
+    for (std::size_t i = 1; i < types.size(); ++i) {
+        double f = static_cast<double>(i) / types.size();
+        types[i].id = static_cast<int>(i);
+        types[i].playerSpeedMax = 1.05 + 0.15 * f;
+        types[i].playerDecay = 0.4 + 0.2 * f;
+        types[i].inertiaMoment = 5.0 + 5.0 * f;
+        types[i].dashPowerRate = 0.006 - 0.0018 * f;
+        types[i].kickableMargin = 0.7 + 0.2 * f;
+        types[i].effortMax = 1.0 - 0.2 * f;
+    }
+    return types;
+}
+
+// Construcción de las tablas de todos los tipos y una consulta con 22 jugadores
+static void benchIntercept(std::vector<BenchResult> &out)
+{
+    std::vector<PlayerTypeParams> types = benchPlayerTypes();
+    auto start = std::chrono::steady_clock::now();
+    auto model = std::make_unique<InterceptModel>(ServerParams{}, types);
+    double buildMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    std::printf("intercept: tables for %zu types built in %.1f ms\n", types.size(), buildMs);
+
+    std::array<Interceptor, 22> who;
+    std::array<InterceptResult, 22> res;
+    for (std::size_t i = 0; i < who.size(); ++i) {
+        Interceptor &p = who[i];
+        p.pos = {-45.0 + 90.0 * static_cast<double>((i * 7) % 22) / 22, -30.0 + 60.0 * static_cast<double>((i * 5) % 22) / 22};
+        p.bodyDir = static_cast<float>(i * 33.0 - 180.0);
+        p.bodyKnown = i % 3 != 0;
+        p.speed = static_cast<float>(0.1 * (i % 8));
+        p.type = static_cast<std::uint8_t>(i % MAX_PLAYER_TYPES);
+        p.team = i < 11 ? TeamSide::Own : TeamSide::Opp;
+    }
+    const Point ballPos{5.0, -3.0}, ballVel{-1.8, 0.9};
+
+    out.push_back(run("intercept/solve/22", [&] {
+        model->solve(ballPos, ballVel, who, res);
+        keep(res);
+    }));
+}
+
+// --- Planificador -----------------------------------------------------------------
+
+// Búsqueda síncrona (PLAN_SYNC_NODES nodos) con el balón en el medio campo rival,
+// 10 compañeros y 11 rivales a la vista
+static void benchPlanner(std::vector<BenchResult> &out)
+{
+    PlanWorld world;
+    world.ball = {20.0, 5.0};
+    world.players[0] = Interceptor{{19.5, 5.0}, 0.0f, true, 0.3f, 0, TeamSide::Own, 9};
+    world.size = 1;
+    for (int i = 0; i < 21; ++i) {
+        Interceptor &p = world.players[world.size++];
+        p.pos = {-30.0 + 80.0 * ((i * 7) % 21) / 21.0, -30.0 + 60.0 * ((i * 5) % 21) / 21.0};
+        p.bodyDir = static_cast<float>(i * 37 % 360 - 180);
+        p.bodyKnown = i % 2 == 0;
+        p.team = i < 10 ? TeamSide::Own : TeamSide::Opp;
+    }
+
+    auto search = std::make_unique<ChainSearch>();
+    search->start(world);
+    while (search->nodes() < PLAN_SYNC_NODES && search->step(1)) {
+    }
+    const ActionChain &best = search->best();
+    std::printf("planner: %llu nodes, depth %d, best %s x%d value %.3f\n",
+                static_cast<unsigned long long>(search->nodes()), search->depth(),
+                best.empty() ? "-" : toString(best.actions[0].kind), best.depth, best.value);
+
+    out.push_back(run("planner/search/" + std::to_string(PLAN_SYNC_NODES), [&] {
+        search->start(world);
+        while (search->nodes() < PLAN_SYNC_NODES && search->step(1)) {
+        }
+        keep(search->best());
+    }));
+}
+
+// --- Comunicación ----------------------------------------------------------------
+
+// Codificar un mensaje de balón y parsear el hear de un compañero que lo trae
+static void benchComm(std::vector<BenchResult> &out)
+{
+    SayMessage msg;
+    msg.time = 240;
+    msg.ballPos = {12.34, -5.67};
+    msg.ballVel = {1.2, -0.4};
+    msg.sender = {8.5, -3.0};
+    msg.claim = 4;
+    char text[SAY_MAX_SIZE];
+    encodeSay(msg, text);
+    const std::string hear = "(hear 241 -30 our 7 \"" + std::string(text, SAY_MAX_SIZE) + "\")";
+
+    out.push_back(run("comm/encodeSay", [&] {
+        std::size_t n = encodeSay(msg, text);
+        keep(n);
+        keep(text);
+    }));
+
+    PlayerInfo player;
+    player.number = 9;
+    GameState game;
+    out.push_back(run("comm/parseHearMsg", [&] { parseHearMsg(hear, player, game); keep(player.heard); }));
+}
+
+// --- JSON --------------------------------------------------------------------
+
+static void writeJson(const std::string &path, const std::vector<BenchResult> &results)
+{
+    std::ofstream out(path);
+    out << "{\n  \"benchmarks\": [\n";
+    for (std::size_t i = 0; i < results.size(); ++i) {
+        const BenchResult &r = results[i];
+        out << "    {\"name\": \"" << r.name << "\", \"ns_per_op\": " << r.nsPerOp
+            << ", \"allocs_per_op\": " << r.allocsPerOp << "}" << (i + 1 < results.size() ? "," : "") << "\n";
+    }
+    out << "  ]\n}\n";
+}
+
+// Lee el JSON que escribe writeJson (un objeto por línea)
+static std::vector<BenchResult> readJson(const std::string &path)
+{
+    std::vector<BenchResult> results;
+    std::ifstream in(path);
+    std::string line;
+    auto field = [](const std::string &l, const std::string &key) -> std::string {
+        auto at = l.find("\"" + key + "\":");
+        if (at == std::string::npos) return {};
+        at = l.find_first_not_of(" \"", at + key.size() + 3);
+        auto end = l.find_first_of(",\"}", at);
+        return l.substr(at, end - at);
+    };
+    while (std::getline(in, line)) {
+        std::string name = field(line, "name");
+        if (name.empty()) continue;
+        results.push_back({name, std::atof(field(line, "ns_per_op").c_str()),
+                           std::atof(field(line, "allocs_per_op").c_str())});
+    }
+    return results;
+}
+
+// Devuelve el número de etapas que empeoran respecto a la línea base
+static int compare(const std::vector<BenchResult> &base, const std::vector<BenchResult> &now, double tolerance)
+{
+    int regressions = 0;
+    std::printf("\n%-36s %12s %12s %8s\n", "benchmark", "base ns", "now ns", "change");
+    for (const BenchResult &b : base) {
+        auto it = std::find_if(now.begin(), now.end(), [&](const BenchResult &r) { return r.name == b.name; });
+        if (it == now.end())
+            continue;
+        double change = b.nsPerOp > 0 ? it->nsPerOp / b.nsPerOp - 1.0 : 0.0;
+        bool slower = change > tolerance;
+        bool moreAllocs = it->allocsPerOp > b.allocsPerOp + 0.01;
+        std::printf("%-36s %12.1f %12.1f %+7.1f%%%s%s\n", b.name.c_str(), b.nsPerOp, it->nsPerOp,
+                    change * 100.0, slower ? "  SLOWER" : "", moreAllocs ? "  MORE ALLOCS" : "");
+        if (slower || moreAllocs)
+            ++regressions;
+    }
+    return regressions;
+}
+
+static void printUsage(const char *prog)
+{
+    std::printf("Usage: %s [--corpus FILE.rstrace] [--json OUT] [--compare BASE] [--tolerance F] [--min-time-ms MS]"
+                " [--formation FILE]\n", prog);
+}
+
+int main(int argc, char *argv[])
+{
+    std::string corpusPath, jsonPath, baselinePath;
+    double tolerance = 0.15;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string_view arg = argv[i];
+        if (i + 1 >= argc) {
+            printUsage(argv[0]);
+            return 1;
+        }
+        std::string value = argv[++i];
+        bool ok = true;
+        if (arg == "--corpus")              corpusPath = value;
+        else if (arg == "--json")           jsonPath = value;
+        else if (arg == "--compare")        baselinePath = value;
+        else if (arg == "--tolerance")      ok = parseArg(value, tolerance, 0.0);
+        else if (arg == "--min-time-ms")    ok = parseArg(value, minTimeMs, 0.0);
+        else if (arg == "--formation") {
+            if (!loadActiveFormation(value)) {
+                std::printf("Cannot load formation %s\n", value.c_str());
+                return 1;
+            }
+        } else {
+            ok = false;
+        }
+        if (!ok) {
+            printUsage(argv[0]);
+            return 1;
+        }
+    }
+
+    std::vector<CorpusMessage> corpus = builtinCorpus();
+
+    // Con una grabación, se añaden el see más corto, el mediano y el más largo
+    if (!corpusPath.empty()) {
+        TraceReader trace;
+        if (!trace.load(corpusPath)) {
+            std::printf("Cannot read trace %s\n", corpusPath.c_str());
+            return 1;
+        }
+        std::vector<std::string_view> sees;
+        for (const TraceRecord &rec : trace.records())
+            if (rec.dir == TraceDirection::In && rec.data.rfind("(see", 0) == 0)
+                sees.push_back(rec.data);
+        std::sort(sees.begin(), sees.end(), [](auto a, auto b) { return a.size() < b.size(); });
+        if (!sees.empty()) {
+            corpus.push_back({"trace_min", std::string(sees.front())});
+            corpus.push_back({"trace_median", std::string(sees[sees.size() / 2])});
+            corpus.push_back({"trace_max", std::string(sees.back())});
+        }
+    }
+
+    if (!checkGeometryError() || !checkLocalizationError())
+        return 3;
+
+    std::vector<BenchResult> results;
+    for (const CorpusMessage &m : corpus)
+        benchMessage(m, results);
+    benchGeometry(results);
+    benchIntercept(results);
+    benchPlanner(results);
+    benchComm(results);
+
+    PlayerInfo player;
+    GameState game;
+    results.push_back(run("parseSenseMsg", [&] { parseSenseMsg(SENSE_MSG, player); keep(player.sense); }));
+    results.push_back(run("parseHearMsg", [&] { parseHearMsg(HEAR_MSG, player, game); keep(game); }));
+
+    if (!jsonPath.empty())
+        writeJson(jsonPath, results);
+
+    if (!baselinePath.empty()) {
+        std::vector<BenchResult> base = readJson(baselinePath);
+        if (base.empty()) {
+            std::printf("Cannot read baseline %s\n", baselinePath.c_str());
+            return 1;
+        }
+        int regressions = compare(base, results, tolerance);
+        if (regressions > 0) {
+            std::printf("%d benchmark(s) regressed beyond %.0f%%\n", regressions, tolerance * 100.0);
+            return 2;
+        }
+    }
+    return 0;
+}
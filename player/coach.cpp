@@ -0,0 +1,298 @@
+#include "coach.h"
+#include "flags.h"
+#include "sexpr.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <limits>
+
+// Peso de cada ciclo en las medias móviles de posición de los rivales (~10 s de
+// memoria), para las líneas de su formación
+static constexpr double LINE_ALPHA = 0.01;
+
+// Distancia al balón para contar la posesión de un equipo
+static constexpr double POSSESSION_DIST = 1.5;
+
+// Ciclos tras reanudarse el juego en los que se mira a dónde fue un saque rival
+static constexpr int SET_PIECE_HORIZON = 15;
+
+// Muestras que esperan al hilo de análisis como mucho (un minuto de partido)
+static constexpr std::size_t ANALYZER_MAX_PENDING = 600;
+
+// Prefijo de los consejos: los freeform de otros entrenadores se ignoran
+static constexpr std::string_view ADVICE_TAG = "rs1";
+
+// --- see_global ---------------------------------------------------------------
+
+bool parseSeeGlobalMsg(std::string_view msg, std::string_view ourTeam, Side ourSide, GlobalWorld &out)
+{
+    SExprCursor cur(msg);
+    if (!cur.consume('(') || cur.atom() != "see_global")
+        return false;
+    cur.number(out.time);
+    for (auto &team : out.players)
+        for (auto &p : team)
+            p.present = false;
+
+    const int ourIndex = ourSide == Side::Right ? 1 : 0;
+
+    // ((nombre) números... [marcadores]); el servidor da y y los ángulos en sentido horario
+    while (cur.consume('(')) {
+        if (!cur.consume('(')) {
+            cur.skipList();
+            continue;
+        }
+        std::string_view name = cur.untilClose();
+        double nums[8];
+        int n = 0;
+        while (n < 8 && cur.number(nums[n]))
+            ++n;
+        cur.skipList();   // marcadores (t, k, y, r) y ')'
+        if (name.empty())
+            continue;
+
+        if (name[0] == 'b' && n >= 4) {
+            out.ball = {nums[0], -nums[1]};
+            out.ballVel = {nums[2], -nums[3]};
+        } else if (name[0] == 'p' && n >= 6) {
+            SExprCursor who(name);
+            who.atom(); // 'p'
+            std::string_view team = who.atom();
+            int unum = toInt(who.atom(), -1);
+            if (unum < 1 || unum > 11)
+                continue;
+            GlobalPlayer &p = out.players[team == ourTeam ? ourIndex : 1 - ourIndex][unum - 1];
+            p.present = true;
+            p.goalie = who.atom() == "goalie";
+            p.pos = {nums[0], -nums[1]};
+            p.vel = {nums[2], -nums[3]};
+            p.body = -nums[4];
+            p.neck = nums[5];
+        }
+    }
+    return true;
+}
+
+// --- Consejos -----------------------------------------------------------------
+
+std::size_t encodeAdvice(const CoachAdvice &advice, char *out)
+{
+    char zone[12] = "-";
+    if (advice.setPieceZone >= 0)
+        std::snprintf(zone, sizeof(zone), "%d", advice.setPieceZone);
+    int n = std::snprintf(out, COACH_SAY_MAX_SIZE, "%.*s L%d P%d F%d%d%d K%s", static_cast<int>(ADVICE_TAG.size()),
+                          ADVICE_TAG.data(), static_cast<int>(std::lround(advice.offsideLine * 10.0)),
+                          advice.possession, advice.opponentLines[0], advice.opponentLines[1],
+                          advice.opponentLines[2], zone);
+    return n > 0 ? std::min(static_cast<std::size_t>(n), COACH_SAY_MAX_SIZE - 1) : 0;
+}
+
+bool decodeAdvice(std::string_view text, CoachAdvice &out)
+{
+    SExprCursor cur(text);
+    if (cur.atom() != ADVICE_TAG)
+        return false;
+
+    CoachAdvice a = out;
+    for (std::string_view tok = cur.atom(); !tok.empty(); tok = cur.atom()) {
+        std::string_view value = tok.substr(1);
+        switch (tok[0]) {
+            case 'L': a.offsideLine = toInt(value, 0) / 10.0; break;
+            case 'P': a.possession = std::clamp(toInt(value, 50), 0, 100); break;
+            case 'F':
+                if (value.size() == 3)
+                    for (int i = 0; i < 3; ++i)
+                        a.opponentLines[i] = static_cast<std::int8_t>(value[i] - '0');
+                break;
+            case 'K': a.setPieceZone = toInt(value, -1); break;
+            default: break;
+        }
+    }
+    out = a;
+    return true;
+}
+
+// --- Análisis -----------------------------------------------------------------
+
+static bool isTheirSetPiece(PlayMode mode)
+{
+    return mode == PlayMode::TheirKickIn || mode == PlayMode::TheirFreeKick ||
+           mode == PlayMode::TheirIndirectFreeKick || mode == PlayMode::TheirCorner ||
+           mode == PlayMode::TheirGoalKick;
+}
+
+void TeamAnalysis::observe(const GlobalWorld &world, PlayMode mode)
+{
+    const auto &opp = world.players[opponentIndex()];
+
+    // Posición media de cada rival y penúltimo defensor del ciclo (el portero cuenta)
+    double first = -std::numeric_limits<double>::infinity(), second = first;
+    for (std::size_t k = 0; k < opp.size(); ++k) {
+        if (!opp[k].present)
+            continue;
+        double x = ownX(opp[k].pos.x);
+        oppX_[k] = oppSeen_[k] ? oppX_[k] + LINE_ALPHA * (x - oppX_[k]) : x;
+        oppSeen_[k] = true;
+        if (opp[k].goalie)
+            oppGoalie_ = static_cast<int>(k);
+        if (x > first) {
+            second = first;
+            first = x;
+        } else if (x > second) {
+            second = x;
+        }
+    }
+    if (std::isfinite(second)) {
+        offsideLine_ = second;
+        lineSeen_ = true;
+    }
+
+    // Posesión: el equipo del jugador más cercano al balón, si lo tiene a mano
+    if (mode == PlayMode::PlayOn) {
+        double best = POSSESSION_DIST;
+        int owner = -1;
+        for (int t = 0; t < 2; ++t) {
+            for (const GlobalPlayer &p : world.players[t]) {
+                double d = std::hypot(p.pos.x - world.ball.x, p.pos.y - world.ball.y);
+                if (p.present && d < best) {
+                    best = d;
+                    owner = t;
+                }
+            }
+        }
+        if (owner >= 0)
+            ++possession_[owner == opponentIndex() ? 1 : 0];
+    }
+
+    // Saques rivales: zona del balón poco después de reanudarse el juego
+    if (isTheirSetPiece(mode))
+        theirSetPiece_ = true;
+    else if (mode != PlayMode::PlayOn)
+        theirSetPiece_ = false;
+    if (mode == PlayMode::PlayOn && lastMode_ != PlayMode::PlayOn && theirSetPiece_) {
+        setPieceTime_ = world.time;
+        theirSetPiece_ = false;
+    }
+    if (setPieceTime_ >= 0 && world.time - setPieceTime_ >= SET_PIECE_HORIZON) {
+        double x = ownX(world.ball.x), y = ownY(world.ball.y);
+        int third = x < -PITCH_HALF_LENGTH / 3.0 ? 0 : x < PITCH_HALF_LENGTH / 3.0 ? 1 : 2;
+        int lane = y > PITCH_HALF_WIDTH / 3.0 ? 0 : y < -PITCH_HALF_WIDTH / 3.0 ? 2 : 1;
+        ++setPieceZones_[third * 3 + lane];
+        setPieceTime_ = -1;
+    }
+    lastMode_ = mode;
+}
+
+CoachAdvice TeamAnalysis::advice() const
+{
+    CoachAdvice a;
+    a.offsideLine = lineSeen_ ? offsideLine_ : PITCH_HALF_LENGTH;
+
+    int total = possession_[0] + possession_[1];
+    a.possession = total > 0 ? static_cast<int>(std::lround(100.0 * possession_[0] / total)) : 50;
+
+    // Líneas rivales: jugadores de campo de su portería hacia la nuestra,
+    // cortados por los dos huecos más grandes
+    std::array<double, 11> xs{};
+    std::size_t n = 0;
+    for (std::size_t k = 0; k < oppX_.size(); ++k) {
+        if (oppSeen_[k] && static_cast<int>(k) != oppGoalie_)
+            xs[n++] = oppX_[k];
+    }
+    if (n >= 3) {
+        std::sort(xs.begin(), xs.begin() + n, std::greater<>());
+        std::size_t cut1 = 1, cut2 = 2;
+        double gap1 = -1.0, gap2 = -1.0;
+        for (std::size_t i = 1; i < n; ++i) {
+            double gap = xs[i - 1] - xs[i];
+            if (gap > gap1) {
+                gap2 = gap1;
+                cut2 = cut1;
+                gap1 = gap;
+                cut1 = i;
+            } else if (gap > gap2) {
+                gap2 = gap;
+                cut2 = i;
+            }
+        }
+        if (cut1 > cut2)
+            std::swap(cut1, cut2);
+        a.opponentLines = {static_cast<std::int8_t>(cut1), static_cast<std::int8_t>(cut2 - cut1),
+                           static_cast<std::int8_t>(n - cut2)};
+    }
+
+    auto most = std::max_element(setPieceZones_.begin(), setPieceZones_.end());
+    a.setPieceZone = *most > 0 ? static_cast<int>(most - setPieceZones_.begin()) : -1;
+    return a;
+}
+
+// --- Hilo de análisis ---------------------------------------------------------
+
+CoachAnalyzer::CoachAnalyzer(Side side) : analysis_(side)
+{
+    pending_.reserve(ANALYZER_MAX_PENDING);
+    work_.reserve(ANALYZER_MAX_PENDING);
+    thread_ = std::thread([this] { run(); });
+}
+
+CoachAnalyzer::~CoachAnalyzer()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stop_ = true;
+    }
+    wake_.notify_one();
+    thread_.join();
+}
+
+void CoachAnalyzer::submit(const GlobalWorld &world, PlayMode mode)
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        // Si el análisis se queda atrás se pierden ciclos, nunca se bloquea la red
+        if (pending_.size() >= ANALYZER_MAX_PENDING)
+            return;
+        pending_.push_back({world, mode});
+    }
+    wake_.notify_one();
+}
+
+std::uint64_t CoachAnalyzer::latest(std::uint64_t version, CoachAdvice &out) const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (version_ > version)
+        out = advice_;
+    return version_;
+}
+
+void CoachAnalyzer::run()
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (true) {
+        wake_.wait(lock, [this] { return stop_ || !pending_.empty(); });
+        if (stop_)
+            return;
+        work_.swap(pending_);
+        lock.unlock();
+
+        for (const Sample &s : work_)
+            analysis_.observe(s.world, s.mode);
+        work_.clear();
+        CoachAdvice advice = analysis_.advice();
+
+        lock.lock();
+        advice_ = advice;
+        ++version_;
+    }
+}
+
+// --- Cupo de mensajes ---------------------------------------------------------
+
+bool CoachSayBudget::allowed(PlayMode mode, int time) const
+{
+    if (sent_ >= COACH_SAY_MAX || time - lastSent_ < COACH_SAY_MIN_INTERVAL)
+        return false;
+    if (mode == PlayMode::PlayOn)
+        return time % COACH_FREEFORM_WAIT_PERIOD < COACH_FREEFORM_SEND_PERIOD;
+    return true;
+}
@@ -0,0 +1,147 @@
+#pragma once
+
+#include "types.h"
+#include <array>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+// Entrenador en línea: modelo exacto del partido a partir de see_global,
+// análisis de equipo y consejos por (say (freeform "...")).
+//
+// El servidor manda al entrenador con (eye on) el estado completo en cada
+// ciclo, sin ruido, así que el análisis global (formación rival, posesión,
+// a dónde sacan los rivales) se hace una vez en lugar de una por jugador. Lo
+// que sale de él es un consejo corto que los jugadores guardan en
+// PlayerInfo::advice. El servidor limita los freeform: en play_on sólo en
+// una ventana de COACH_FREEFORM_SEND_PERIOD ciclos de cada
+// COACH_FREEFORM_WAIT_PERIOD, y como mucho COACH_SAY_MAX por partido.
+
+inline constexpr int COACH_FREEFORM_SEND_PERIOD = 20;    // freeform_send_period
+inline constexpr int COACH_FREEFORM_WAIT_PERIOD = 600;   // freeform_wait_period
+inline constexpr int COACH_SAY_MAX = 128;                // say_coach_cnt_max
+inline constexpr int COACH_SAY_MIN_INTERVAL = 50;        // reparte el cupo a lo largo del partido
+inline constexpr std::size_t COACH_SAY_MAX_SIZE = 128;   // say_coach_msg_size
+
+// Antigüedad máxima de un consejo para usarlo: la línea del fuera de juego es
+// la del ciclo en que se dijo y deja de valer enseguida
+inline constexpr int COACH_ADVICE_MAX_AGE = COACH_FREEFORM_SEND_PERIOD;
+
+// Jugador en see_global, en el convenio del equipo (y hacia la banda
+// superior, ángulos antihorarios)
+struct GlobalPlayer
+{
+    bool present{false};
+    bool goalie{false};
+    Point pos{};
+    Point vel{};
+    double body{0.0};      // grados, antihorario
+    double neck{0.0};      // relativo al cuerpo, convenio del servidor
+};
+
+// Estado exacto de un ciclo
+struct GlobalWorld
+{
+    int time{0};
+    Point ball{};
+    Point ballVel{};
+    std::array<std::array<GlobalPlayer, 11>, 2> players{};   // [0] izquierdo, [1] derecho; por dorsal - 1
+};
+
+// (see_global T ((g l) ...) ((b) x y vx vy) ((p "Team" 3 [goalie]) x y vx vy body neck ...) ...).
+// El lado de cada jugador sale de su nombre de equipo comparado con el
+// nuestro. false si no es un see_global.
+bool parseSeeGlobalMsg(std::string_view msg, std::string_view ourTeam, Side ourSide, GlobalWorld &out);
+
+// Consejo en texto para freeform, ej: "rs1 L-125 P54 F442 K7". Devuelve los
+// caracteres escritos (como mucho COACH_SAY_MAX_SIZE).
+std::size_t encodeAdvice(const CoachAdvice &advice, char *out);
+
+// false si el texto no es un consejo nuestro; time no se toca
+bool decodeAdvice(std::string_view text, CoachAdvice &out);
+
+// Análisis acumulado del partido desde el lado side
+class TeamAnalysis
+{
+public:
+    explicit TeamAnalysis(Side side) : side_(side) {}
+
+    // Un ciclo del partido con el modo de juego ya normalizado a nuestro/suyo
+    void observe(const GlobalWorld &world, PlayMode mode);
+
+    // Consejo con lo observado hasta ahora (la parte costosa: las líneas rivales)
+    CoachAdvice advice() const;
+
+private:
+    // x en coordenadas propias (hacia la portería rival)
+    double ownX(double x) const { return side_ == Side::Left ? x : -x; }
+    double ownY(double y) const { return side_ == Side::Left ? y : -y; }
+    int opponentIndex() const { return side_ == Side::Left ? 1 : 0; }
+
+    Side side_;
+    std::array<double, 11> oppX_{};          // media móvil de la x propia de cada rival
+    std::array<bool, 11> oppSeen_{};
+    int oppGoalie_{-1};                       // índice del portero rival si se ha visto
+    double offsideLine_{0.0};                 // penúltimo defensor en el último ciclo observado
+    bool lineSeen_{false};
+    std::array<int, 2> possession_{};         // ciclos de play_on con el balón de cada equipo (propio, rival)
+
+    // Saques rivales: dónde está el balón SET_PIECE_HORIZON ciclos después
+    std::array<int, 9> setPieceZones_{};
+    int setPieceTime_{-1};                    // ciclo en que se reanudó el juego tras un saque rival
+    bool theirSetPiece_{false};
+    PlayMode lastMode_{PlayMode::Unknown};
+};
+
+// Hilo de análisis: el bucle de red le pasa cada ciclo y recoge el último
+// consejo sin esperar
+class CoachAnalyzer
+{
+public:
+    explicit CoachAnalyzer(Side side);
+    ~CoachAnalyzer();
+
+    CoachAnalyzer(const CoachAnalyzer &) = delete;
+    CoachAnalyzer &operator=(const CoachAnalyzer &) = delete;
+
+    void submit(const GlobalWorld &world, PlayMode mode);
+
+    // Copia el último consejo si hay uno más nuevo que version; devuelve su versión
+    std::uint64_t latest(std::uint64_t version, CoachAdvice &out) const;
+
+private:
+    struct Sample
+    {
+        GlobalWorld world;
+        PlayMode mode;
+    };
+
+    void run();
+
+    TeamAnalysis analysis_;
+    mutable std::mutex mutex_;
+    std::condition_variable wake_;
+    std::vector<Sample> pending_;
+    std::vector<Sample> work_;                // lote en análisis (se reutiliza su memoria)
+    CoachAdvice advice_{};
+    std::uint64_t version_{0};
+    bool stop_{false};
+    std::thread thread_;
+};
+
+// Cupo de freeform del entrenador
+class CoachSayBudget
+{
+public:
+    bool allowed(PlayMode mode, int time) const;
+    void onSent(int time) { lastSent_ = time; ++sent_; }
+    int sent() const { return sent_; }
+
+private:
+    int lastSent_{-COACH_SAY_MIN_INTERVAL};
+    int sent_{0};
+};
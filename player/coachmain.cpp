@@ -0,0 +1,183 @@
+// player_coach: entrenador en línea del equipo. Se conecta al puerto del
+// entrenador de rcssserver, pide el see_global de cada ciclo (eye on), lleva el
+// modelo exacto del partido y el modo de juego, y pasa cada ciclo al hilo de
+// análisis (coach.h). Cuando el cupo de freeform lo permite y el consejo ha
+// cambiado, lo dice a los jugadores. Termina con time_over, con SIGINT o si el
+// servidor deja de hablar.
+//
+//   player_coach --team NAME [--server HOST[:PORT]]     (puerto por defecto 6002)
+#include "args.h"
+#include "coach.h"
+#include "log.h"
+#include "net.h"
+#include "referee.h"
+#include "sexpr.h"
+#include <csignal>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <poll.h>
+
+// Sin mensajes del servidor durante este tiempo, el partido ha terminado
+static constexpr int SERVER_SILENCE_MS = 30'000;
+
+static volatile std::sig_atomic_t interrupted = 0;
+
+struct CoachOptions
+{
+    std::string team;
+    UdpAddress server{UdpAddress::make("127.0.0.1", 6002)};
+};
+
+struct Coach
+{
+    CoachOptions options;
+    UdpSocket socket;
+    UdpAddress server;
+    Side side{Side::Unknown};
+    GameState game{};
+    GlobalWorld world{};
+    std::unique_ptr<CoachAnalyzer> analyzer;
+    CoachSayBudget budget;
+    std::uint64_t adviceVersion{0};
+    CoachAdvice advice{};
+    char lastSaid[COACH_SAY_MAX_SIZE]{};
+    std::size_t lastSaidLen{0};
+    int cycles{0};
+    bool finished{false};
+};
+
+// Dice el consejo más reciente si ha cambiado y el cupo lo permite
+static void maybeSay(Coach &coach)
+{
+    coach.adviceVersion = coach.analyzer->latest(coach.adviceVersion, coach.advice);
+    if (coach.adviceVersion == 0 || !coach.budget.allowed(coach.game.playMode, coach.game.time))
+        return;
+
+    char text[COACH_SAY_MAX_SIZE];
+    std::size_t n = encodeAdvice(coach.advice, text);
+    if (n == coach.lastSaidLen && std::memcmp(text, coach.lastSaid, n) == 0)
+        return;
+    sendCoachSayCommand(coach.socket, coach.server, std::string_view(text, n));
+    std::memcpy(coach.lastSaid, text, n);
+    coach.lastSaidLen = n;
+    coach.budget.onSent(coach.game.time);
+    LOG_INFO("[COACH] t={} say {}", coach.game.time, std::string_view(text, n));
+}
+
+static void handleMessage(Coach &coach, std::string_view msg, const UdpAddress &from)
+{
+    if (msg.rfind("(see_global", 0) == 0) {
+        if (!coach.analyzer || !parseSeeGlobalMsg(msg, coach.options.team, coach.side, coach.world))
+            return;
+        coach.game.time = coach.world.time;
+        ++coach.cycles;
+        coach.analyzer->submit(coach.world, coach.game.playMode);
+        maybeSay(coach);
+    } else if (msg.rfind("(hear", 0) == 0) {
+        // (hear TIME referee MODE); los demás hear no interesan al entrenador
+        SExprCursor cur(msg);
+        cur.consume('(');
+        cur.atom();
+        int time = 0;
+        cur.number(time);
+        if (cur.atom() != "referee")
+            return;
+        std::string_view token = cur.atom();
+        applyReferee(decodeReferee(token, coach.side), coach.side, coach.game);
+        LOG_INFO("[COACH] t={} referee {}", time, token);
+        if (coach.game.playMode == PlayMode::TimeOver)
+            coach.finished = true;
+    } else if (msg.rfind("(init", 0) == 0 && !coach.analyzer) {
+        // (init l ok) o (init r ok): a partir de aquí el servidor contesta desde este puerto
+        SExprCursor cur(msg);
+        cur.consume('(');
+        cur.atom();
+        std::string_view sideTok = cur.atom();
+        if (sideTok != "l" && sideTok != "r") {
+            LOG_ERROR("Unexpected coach init reply: {}", msg);
+            coach.finished = true;
+            return;
+        }
+        coach.side = sideTok == "l" ? Side::Left : Side::Right;
+        coach.server.port = from.port;
+        coach.analyzer = std::make_unique<CoachAnalyzer>(coach.side);
+        sendEyeOnCommand(coach.socket, coach.server);
+        LOG_INFO("[COACH] {} connected on side {}", coach.options.team, toString(coach.side));
+    } else if (msg.rfind("(error", 0) == 0) {
+        LOG_ERROR("Server error: {}", msg);
+        std::fprintf(stderr, "%.*s\n", static_cast<int>(msg.size()), msg.data());
+    }
+}
+
+static void printUsage(const char *prog)
+{
+    std::printf("Usage: %s --team NAME [--server HOST[:PORT]]\n", prog);
+}
+
+static bool parseOptions(int argc, char *argv[], CoachOptions &o)
+{
+    for (int i = 1; i + 1 < argc; i += 2) {
+        std::string_view arg = argv[i];
+        std::string value = argv[i + 1];
+        if (arg == "--team") {
+            o.team = value;
+        } else if (arg == "--server") {
+            std::string host;
+            std::uint16_t port = 6002;
+            if (!parseNameAndPort(value, host, port))
+                return false;
+            o.server = UdpAddress::make(host.c_str(), port);
+        } else {
+            return false;
+        }
+    }
+    return argc % 2 == 1 && !o.team.empty();
+}
+
+int main(int argc, char *argv[])
+{
+    Coach coach;
+    if (!parseOptions(argc, argv, coach.options)) {
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    struct sigaction sa{};
+    sa.sa_handler = [](int) { interrupted = 1; };
+    sigaction(SIGINT, &sa, nullptr);
+    sigaction(SIGTERM, &sa, nullptr);
+
+    if (!coach.socket.open(0)) {
+        std::fprintf(stderr, "Cannot open UDP socket\n");
+        return 1;
+    }
+    coach.server = coach.options.server;
+    sendCoachInitCommand(coach.socket, coach.server, coach.options.team);
+
+    char buf[SERVER_MSG_MAX_SIZE];
+    pollfd pfd{coach.socket.fd(), POLLIN, 0};
+    while (!interrupted && !coach.finished) {
+        int ready = poll(&pfd, 1, SERVER_SILENCE_MS);
+        if (ready == 0) {
+            LOG_WARN("No messages from the server in {} ms", SERVER_SILENCE_MS);
+            break;
+        }
+        if (ready < 0)
+            continue;   // EINTR: se comprueba interrupted
+        UdpAddress from;
+        std::ptrdiff_t len;
+        while ((len = coach.socket.receive(buf, sizeof(buf), &from)) > 0)
+            handleMessage(coach, std::string_view(buf, static_cast<std::size_t>(len)), from);
+    }
+
+    std::printf("coach %s (%s): %d cycles, %d messages said, possession %d%%, opponent lines %d-%d-%d, "
+                "offside line %.1f\n", coach.options.team.c_str(), toString(coach.side), coach.cycles,
+                coach.budget.sent(), coach.advice.possession, coach.advice.opponentLines[0],
+                coach.advice.opponentLines[1], coach.advice.opponentLines[2], coach.advice.offsideLine);
+    coach.analyzer.reset();
+    logShutdown();
+    return 0;
+}
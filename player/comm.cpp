@@ -0,0 +1,300 @@
+#include "comm.h"
+#include "intercept.h"
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+
+constexpr std::uint64_t ALPHABET_SIZE = SAY_ALPHABET.size();
+static_assert(ALPHABET_SIZE == 71);
+
+// Valores distintos que caben en SAY_MAX_SIZE caracteres
+constexpr unsigned __int128 SAY_CAPACITY = [] {
+    unsigned __int128 c = 1;
+    for (std::size_t i = 0; i < SAY_MAX_SIZE; ++i)
+        c *= ALPHABET_SIZE;
+    return c;
+}();
+
+constexpr std::array<std::int8_t, 256> ALPHABET_INDEX = [] {
+    std::array<std::int8_t, 256> index{};
+    for (auto &i : index)
+        i = -1;
+    for (std::size_t i = 0; i < SAY_ALPHABET.size(); ++i)
+        index[static_cast<unsigned char>(SAY_ALPHABET[i])] = static_cast<std::int8_t>(i);
+    return index;
+}();
+
+// Cuantización uniforme a levels valores desde min
+struct Quantizer
+{
+    double min;
+    double step;
+    std::uint32_t levels;
+
+    std::uint32_t encode(double v) const
+    {
+        double q = std::nearbyint((v - min) / step);
+        return static_cast<std::uint32_t>(std::clamp(q, 0.0, static_cast<double>(levels - 1)));
+    }
+
+    double decode(std::uint32_t q) const { return min + q * step; }
+};
+
+constexpr Quantizer BALL_X{-55.0, 0.1, 1101};
+constexpr Quantizer BALL_Y{-36.0, 0.1, 721};
+constexpr Quantizer PLAYER_X{-55.0, 0.5, 221};
+constexpr Quantizer PLAYER_Y{-36.0, 0.5, 145};
+
+// Velocidad del balón con paso raíz cuadrada: ~0,001 m/ciclo cerca de cero y ~0,1 a velocidad máxima
+constexpr double VEL_MAX = 3.0;
+constexpr std::uint32_t VEL_HALF = 60;
+constexpr std::uint32_t VEL_LEVELS = 2 * VEL_HALF + 1;
+
+constexpr std::uint32_t KIND_RADIX = static_cast<std::uint32_t>(SayKind::Count);
+constexpr std::uint32_t STAMP_RADIX = 8;
+constexpr std::uint32_t CLAIM_RADIX = SAY_MAX_CLAIM + 1;
+constexpr std::uint32_t NUMBER_RADIX = 12;              // 0: dorsal desconocido
+constexpr std::uint32_t OPP_X_RADIX = PLAYER_X.levels + 1;   // el último valor: hueco vacío
+
+constexpr unsigned __int128 BALL_RANGE = static_cast<unsigned __int128>(KIND_RADIX) * STAMP_RADIX * BALL_X.levels *
+                                         BALL_Y.levels * VEL_LEVELS * VEL_LEVELS * PLAYER_X.levels *
+                                         PLAYER_Y.levels * CLAIM_RADIX;
+constexpr unsigned __int128 OPPONENT_RANGE = static_cast<unsigned __int128>(OPP_X_RADIX) * PLAYER_Y.levels * NUMBER_RADIX;
+constexpr unsigned __int128 OPPONENTS_RANGE =
+    static_cast<unsigned __int128>(KIND_RADIX) * STAMP_RADIX * OPPONENT_RANGE * OPPONENT_RANGE * OPPONENT_RANGE;
+
+static_assert(BALL_RANGE <= SAY_CAPACITY, "ball message does not fit in a say");
+static_assert(OPPONENTS_RANGE <= SAY_CAPACITY, "opponents message does not fit in a say");
+static_assert(SAY_MAX_OPPONENTS == 3, "OPPONENTS_RANGE assumes three opponents");
+
+std::uint32_t encodeVelocity(double v)
+{
+    double s = std::sqrt(std::min(std::fabs(v), VEL_MAX) / VEL_MAX);
+    auto q = static_cast<std::uint32_t>(std::nearbyint(s * VEL_HALF));
+    return v < 0 ? VEL_HALF - q : VEL_HALF + q;
+}
+
+double decodeVelocity(std::uint32_t q)
+{
+    double s = (static_cast<double>(q) - VEL_HALF) / VEL_HALF;
+    return (s < 0 ? -1.0 : 1.0) * s * s * VEL_MAX;
+}
+
+// Entero en base mixta: cada campo ocupa exactamente su número de valores
+class MixedRadixWriter
+{
+public:
+    void put(std::uint32_t digit, std::uint32_t radix)
+    {
+        value_ += digit * scale_;
+        scale_ *= radix;
+    }
+
+    std::uint64_t value() const { return value_; }
+
+private:
+    std::uint64_t value_{0};
+    std::uint64_t scale_{1};
+};
+
+class MixedRadixReader
+{
+public:
+    explicit MixedRadixReader(std::uint64_t value) : value_(value) {}
+
+    std::uint32_t take(std::uint32_t radix)
+    {
+        auto digit = static_cast<std::uint32_t>(value_ % radix);
+        value_ /= radix;
+        return digit;
+    }
+
+    bool exhausted() const { return value_ == 0; }
+
+private:
+    std::uint64_t value_;
+};
+
+} // namespace
+
+std::size_t encodeSay(const SayMessage &msg, char *out)
+{
+    MixedRadixWriter w;
+    w.put(static_cast<std::uint32_t>(msg.kind), KIND_RADIX);
+    w.put(static_cast<std::uint32_t>(((msg.time % 8) + 8) % 8), STAMP_RADIX);
+
+    if (msg.kind == SayKind::Ball) {
+        w.put(BALL_X.encode(msg.ballPos.x), BALL_X.levels);
+        w.put(BALL_Y.encode(msg.ballPos.y), BALL_Y.levels);
+        w.put(encodeVelocity(msg.ballVel.x), VEL_LEVELS);
+        w.put(encodeVelocity(msg.ballVel.y), VEL_LEVELS);
+        w.put(PLAYER_X.encode(msg.sender.x), PLAYER_X.levels);
+        w.put(PLAYER_Y.encode(msg.sender.y), PLAYER_Y.levels);
+        w.put(static_cast<std::uint32_t>(std::clamp(msg.claim, 0, SAY_MAX_CLAIM)), CLAIM_RADIX);
+    } else {
+        for (std::size_t i = 0; i < SAY_MAX_OPPONENTS; ++i) {
+            if (i < msg.opponentCount) {
+                w.put(PLAYER_X.encode(msg.opponents[i].x), OPP_X_RADIX);
+                w.put(PLAYER_Y.encode(msg.opponents[i].y), PLAYER_Y.levels);
+                int number = msg.opponentNumbers[i];
+                w.put(number >= 1 && number <= 11 ? static_cast<std::uint32_t>(number) : 0, NUMBER_RADIX);
+            } else {
+                w.put(OPP_X_RADIX - 1, OPP_X_RADIX);
+                w.put(0, PLAYER_Y.levels);
+                w.put(0, NUMBER_RADIX);
+            }
+        }
+    }
+
+    std::uint64_t v = w.value();
+    for (std::size_t i = 0; i < SAY_MAX_SIZE; ++i) {
+        out[i] = SAY_ALPHABET[v % ALPHABET_SIZE];
+        v /= ALPHABET_SIZE;
+    }
+    return SAY_MAX_SIZE;
+}
+
+bool decodeSay(std::string_view text, int hearTime, SayMessage &out)
+{
+    if (text.size() != SAY_MAX_SIZE)
+        return false;
+
+    std::uint64_t v = 0;
+    for (std::size_t i = SAY_MAX_SIZE; i-- > 0;) {
+        std::int8_t digit = ALPHABET_INDEX[static_cast<unsigned char>(text[i])];
+        if (digit < 0)
+            return false;
+        v = v * ALPHABET_SIZE + static_cast<std::uint64_t>(digit);
+    }
+
+    MixedRadixReader r(v);
+    std::uint32_t kind = r.take(KIND_RADIX);
+    int stamp = static_cast<int>(r.take(STAMP_RADIX));
+    out = SayMessage{};
+    out.kind = static_cast<SayKind>(kind);
+    out.time = hearTime - (((hearTime - stamp) % 8) + 8) % 8;
+
+    if (out.kind == SayKind::Ball) {
+        out.ballPos.x = BALL_X.decode(r.take(BALL_X.levels));
+        out.ballPos.y = BALL_Y.decode(r.take(BALL_Y.levels));
+        out.ballVel.x = decodeVelocity(r.take(VEL_LEVELS));
+        out.ballVel.y = decodeVelocity(r.take(VEL_LEVELS));
+        out.sender.x = PLAYER_X.decode(r.take(PLAYER_X.levels));
+        out.sender.y = PLAYER_Y.decode(r.take(PLAYER_Y.levels));
+        out.claim = static_cast<int>(r.take(CLAIM_RADIX));
+    } else {
+        for (std::size_t i = 0; i < SAY_MAX_OPPONENTS; ++i) {
+            std::uint32_t x = r.take(OPP_X_RADIX);
+            std::uint32_t y = r.take(PLAYER_Y.levels);
+            std::uint32_t number = r.take(NUMBER_RADIX);
+            if (x == OPP_X_RADIX - 1)
+                continue;
+            out.opponents[out.opponentCount] = {PLAYER_X.decode(x), PLAYER_Y.decode(y)};
+            out.opponentNumbers[out.opponentCount] = static_cast<std::int8_t>(number == 0 ? -1 : static_cast<int>(number));
+            ++out.opponentCount;
+        }
+    }
+    // Lo que sobra tras el último campo no puede venir de encodeSay
+    return r.exhausted();
+}
+
+bool isSayTurn(int time, int number)
+{
+    return number >= 1 && time % 11 == number - 1;
+}
+
+Command composeSay(const PlayerInfo &player, const BallEstimate &ball, int time)
+{
+    SayMessage msg;
+
+    // Rivales vistos, los más cercanos al balón primero
+    std::array<std::pair<double, std::size_t>, SeenPlayers::CAPACITY> opp;
+    std::size_t nOpp = 0;
+    const SeenPlayers &seen = player.see.players;
+    for (std::size_t i = 0; i < seen.size; ++i) {
+        if (seen.team[i] != TeamSide::Opp)
+            continue;
+        Point p = seenPlayerPosition(player, i);
+        opp[nOpp++] = {std::hypot(p.x - player.ballPos.x, p.y - player.ballPos.y), i};
+    }
+    std::sort(opp.begin(), opp.begin() + nOpp);
+
+    // El balón es lo más valioso; en turnos alternos, los rivales si se ven
+    bool ballFresh = ball.valid && ball.age <= 1;
+    bool sayOpponents = nOpp > 0 && (!ballFresh || (time / 11) % 2 == 1);
+
+    if (sayOpponents) {
+        msg.kind = SayKind::Opponents;
+        msg.time = player.see.time;
+        msg.opponentCount = std::min(nOpp, SAY_MAX_OPPONENTS);
+        for (std::size_t k = 0; k < msg.opponentCount; ++k) {
+            msg.opponents[k] = seenPlayerPosition(player, opp[k].second);
+            msg.opponentNumbers[k] = seen.number[opp[k].second];
+        }
+    } else if (ballFresh) {
+        msg.kind = SayKind::Ball;
+        msg.time = ball.time + ball.age;
+        msg.ballPos = ball.pos;
+        msg.ballVel = ball.vel;
+        msg.sender = {player.x_abs, player.y_abs};
+
+        std::array<Interceptor, 1> self;
+        std::array<InterceptResult, 1> res;
+        gatherInterceptors(player, self);
+        interceptModel().solve(ball.pos, ball.vel, self, res);
+        msg.claim = std::min(res[0].cycle, SAY_MAX_CLAIM);
+    } else {
+        return Command{};
+    }
+
+    char text[SAY_MAX_SIZE];
+    std::size_t n = encodeSay(msg, text);
+    return Command::say(std::string_view(text, n));
+}
+
+void mergeSay(HeardInfo &heard, int sender, const SayMessage &msg)
+{
+    if (msg.kind == SayKind::Ball) {
+        if (msg.time > heard.ballTime) {
+            heard.ballPos = msg.ballPos;
+            heard.ballVel = msg.ballVel;
+            heard.ballTime = msg.time;
+            heard.ballSender = sender;
+        }
+        if (sender >= 1 && sender <= 11) {
+            HeardMate &mate = heard.mates[static_cast<std::size_t>(sender)];
+            mate.pos = msg.sender;
+            mate.time = msg.time;
+            mate.claimArrival = msg.claim < SAY_MAX_CLAIM ? msg.time + msg.claim : -1;
+        }
+        return;
+    }
+
+    // Rivales: se actualiza el mismo dorsal o el más cercano (< 3 m); si no, se
+    // añade o sustituye al más antiguo
+    for (std::size_t k = 0; k < msg.opponentCount; ++k) {
+        HeardOpponent incoming{msg.opponents[k], msg.opponentNumbers[k], msg.time};
+        HeardOpponent *slot = nullptr;
+        for (std::size_t i = 0; i < heard.opponentCount && !slot; ++i) {
+            HeardOpponent &o = heard.opponents[i];
+            bool sameNumber = incoming.number >= 0 && o.number == incoming.number;
+            bool close = std::hypot(o.pos.x - incoming.pos.x, o.pos.y - incoming.pos.y) < 3.0 &&
+                         (incoming.number < 0 || o.number < 0);
+            if (sameNumber || close)
+                slot = &o;
+        }
+        if (!slot && heard.opponentCount < HeardInfo::MAX_OPPONENTS)
+            slot = &heard.opponents[heard.opponentCount++];
+        if (!slot) {
+            slot = &*std::min_element(heard.opponents.begin(), heard.opponents.end(),
+                                      [](const HeardOpponent &a, const HeardOpponent &b) { return a.time < b.time; });
+        }
+        if (incoming.time >= slot->time) {
+            if (incoming.number < 0)
+                incoming.number = slot->number;
+            *slot = incoming;
+        }
+    }
+}
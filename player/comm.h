@@ -0,0 +1,76 @@
+#pragma once
+
+#include "types.h"
+#include "command.h"
+#include "motion.h"
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+// Comunicación de equipo por say/hear.
+//
+// El servidor deja decir SAY_MAX_SIZE caracteres por ciclo y cada jugador oye
+// como mucho un mensaje de compañero por ciclo, así que habla uno solo por
+// ciclo (turnos por dorsal) y cada mensaje aprovecha todo el espacio. Cada
+// campo se cuantiza con la resolución que importa (el balón fino, los
+// jugadores a medio metro, la velocidad con paso raíz cuadrada: fino a poca
+// velocidad, que es lo habitual) y los campos se empaquetan en base mixta, sin
+// bits de relleno, en un entero que se escribe en base SAY_ALPHABET.size():
+// 10 caracteres de 71 símbolos son 61,5 bits.
+//
+//   balón:   posición (0,1 m), velocidad, posición del emisor (0,5 m) y sus
+//            ciclos hasta alcanzar el balón
+//   rivales: hasta SAY_MAX_OPPONENTS (0,5 m y dorsal si se distinguía)
+//
+// Los dos llevan el ciclo de los datos módulo 8; quien oye lo resuelve con su
+// propio tiempo.
+
+// Caracteres que acepta el servidor en say, sin espacio, comillas ni paréntesis
+inline constexpr std::string_view SAY_ALPHABET =
+    "0123456789abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ.+-*/?<>_";
+
+inline constexpr std::size_t SAY_MAX_OPPONENTS = 3;
+
+// Ciclos de intercepción que caben en el mensaje; el último significa "no llego"
+inline constexpr int SAY_MAX_CLAIM = 63;
+
+// Antigüedad máxima de lo oído para usarlo en las decisiones
+inline constexpr int HEARD_MAX_AGE = 3;
+
+enum class SayKind : std::uint8_t
+{
+    Ball, Opponents, Count
+};
+
+struct SayMessage
+{
+    SayKind kind{SayKind::Ball};
+    int time{0};                  // Ciclo al que corresponden los datos
+
+    // SayKind::Ball
+    Point ballPos{};
+    Point ballVel{};
+    Point sender{};
+    int claim{SAY_MAX_CLAIM};     // Ciclos hasta que el emisor alcanza el balón
+
+    // SayKind::Opponents
+    std::array<Point, SAY_MAX_OPPONENTS> opponents{};
+    std::array<std::int8_t, SAY_MAX_OPPONENTS> opponentNumbers{};
+    std::size_t opponentCount{0};
+};
+
+// Escribe exactamente SAY_MAX_SIZE caracteres en out
+std::size_t encodeSay(const SayMessage &msg, char *out);
+
+// false si el texto no es un mensaje nuestro (longitud, alfabeto o valor fuera de rango)
+bool decodeSay(std::string_view text, int hearTime, SayMessage &out);
+
+// Turno de palabra: un dorsal distinto en cada ciclo
+bool isSayTurn(int time, int number);
+
+// Mensaje de este jugador para el ciclo (vacío si no tiene nada reciente que contar)
+Command composeSay(const PlayerInfo &player, const BallEstimate &ball, int time);
+
+// Incorpora a heard lo que dice el compañero sender
+void mergeSay(HeardInfo &heard, int sender, const SayMessage &msg);
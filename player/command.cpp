@@ -0,0 +1,135 @@
+#include "command.h"
+#include <charconv>
+#include <cstring>
+
+// Decimales con los que se envían potencias, ángulos y coordenadas. El
+// servidor redondea los ángulos a grados y las potencias a la centésima;
+// más cifras sólo alargan el datagrama.
+static constexpr int COMMAND_PRECISION = 2;
+
+// Escritor acotado sobre un búfer de la pila; ok pasa a false al desbordar
+struct CommandWriter
+{
+    char *p;
+    char *end;
+    bool ok{true};
+
+    void text(std::string_view s)
+    {
+        if (!ok || static_cast<std::size_t>(end - p) < s.size()) {
+            ok = false;
+            return;
+        }
+        std::memcpy(p, s.data(), s.size());
+        p += s.size();
+    }
+
+    // Número en punto fijo sin ceros finales: 100, -30.5, 0.25
+    void number(double v)
+    {
+        if (!ok || p == end) {
+            ok = false;
+            return;
+        }
+        *p = ' ';
+        auto [ptr, ec] = std::to_chars(p + 1, end, v, std::chars_format::fixed, COMMAND_PRECISION);
+        if (ec != std::errc{}) {
+            ok = false;
+            return;
+        }
+        char *last = ptr;
+        while (last[-1] == '0') --last;
+        if (last[-1] == '.') --last;
+        if (last - p == 3 && p[1] == '-' && p[2] == '0') {
+            // "-0" tras el redondeo
+            p[1] = '0';
+            last = p + 2;
+        }
+        p = last;
+    }
+};
+
+Command Command::say(std::string_view msg)
+{
+    Command c{CommandType::Say};
+    c.textLen = static_cast<std::uint8_t>(msg.size() < SAY_MAX_SIZE ? msg.size() : SAY_MAX_SIZE);
+    std::memcpy(c.text.data(), msg.data(), c.textLen);
+    return c;
+}
+
+static std::string_view viewWidthName(ViewWidth w)
+{
+    switch (w) {
+        case ViewWidth::Narrow: return "narrow";
+        case ViewWidth::Wide:   return "wide";
+        default:                return "normal";
+    }
+}
+
+std::size_t serializeCommand(const Command &cmd, char *buf, std::size_t capacity)
+{
+    CommandWriter w{buf, buf + capacity};
+
+    switch (cmd.type) {
+        case CommandType::None:
+            return 0;
+        case CommandType::Dash:
+            w.text("(dash");
+            w.number(cmd.a);
+            w.number(cmd.b);
+            break;
+        case CommandType::Turn:
+            w.text("(turn");
+            w.number(cmd.a);
+            break;
+        case CommandType::Kick:
+            w.text("(kick");
+            w.number(cmd.a);
+            w.number(cmd.b);
+            break;
+        case CommandType::Move:
+            w.text("(move");
+            w.number(cmd.a);
+            w.number(cmd.b);
+            break;
+        case CommandType::Catch:
+            w.text("(catch");
+            w.number(cmd.a);
+            break;
+        case CommandType::TurnNeck:
+            w.text("(turn_neck");
+            w.number(cmd.a);
+            break;
+        case CommandType::ChangeView:
+            w.text("(change_view ");
+            w.text(viewWidthName(cmd.width));
+            w.text(cmd.quality == ViewQuality::Low ? " low" : " high");
+            break;
+        case CommandType::Say:
+            w.text("(say ");
+            w.text(std::string_view(cmd.text.data(), cmd.textLen));
+            break;
+        case CommandType::PointTo:
+            w.text("(pointto");
+            w.number(cmd.a);
+            w.number(cmd.b);
+            break;
+    }
+    w.text(")");
+
+    return w.ok ? static_cast<std::size_t>(w.p - buf) : 0;
+}
+
+std::size_t CommandFrame::serialize(char *buf, std::size_t capacity) const
+{
+    std::size_t used = 0;
+    for (const Command *cmd : {&body, &turnNeck, &changeView, &say}) {
+        if (cmd->empty())
+            continue;
+        std::size_t n = serializeCommand(*cmd, buf + used, capacity - used);
+        if (n == 0)
+            return 0;
+        used += n;
+    }
+    return used;
+}
@@ -0,0 +1,79 @@
+#pragma once
+
+#include "types.h"
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+// Tamaño máximo de un datagrama de comandos (cabe en la pila)
+inline constexpr std::size_t COMMAND_MAX_SIZE = 256;
+
+// Longitud máxima de un mensaje say (say_msg_size en rcssserver)
+inline constexpr std::size_t SAY_MAX_SIZE = 10;
+
+enum class CommandType : std::uint8_t
+{
+    None,
+    // Comandos de cuerpo: como mucho uno por ciclo
+    Dash, Turn, Kick, Move, Catch,
+    // Comandos que se pueden enviar junto al de cuerpo en el mismo ciclo
+    TurnNeck, ChangeView, Say, PointTo
+};
+
+// Comando al servidor como valor tipado, sin memoria dinámica.
+// Los significados de a y b dependen del tipo:
+//   dash: potencia, dirección | turn: momento | kick: potencia, dirección
+//   move: x, y | catch: dirección | turn_neck: ángulo | pointto: distancia, dirección
+struct Command
+{
+    CommandType type{CommandType::None};
+    double a{0.0};
+    double b{0.0};
+    ViewWidth width{ViewWidth::Normal};
+    ViewQuality quality{ViewQuality::High};
+    std::array<char, SAY_MAX_SIZE> text{};
+    std::uint8_t textLen{0};
+
+    static constexpr Command dash(double power, double dir) { return {CommandType::Dash, power, dir}; }
+    static constexpr Command turn(double moment) { return {CommandType::Turn, moment}; }
+    static constexpr Command kick(double power, double dir) { return {CommandType::Kick, power, dir}; }
+    static constexpr Command move(double x, double y) { return {CommandType::Move, x, y}; }
+    static constexpr Command catchBall(double dir) { return {CommandType::Catch, dir}; }
+    static constexpr Command turnNeck(double angle) { return {CommandType::TurnNeck, angle}; }
+    static constexpr Command pointTo(double dist, double dir) { return {CommandType::PointTo, dist, dir}; }
+
+    static constexpr Command changeView(ViewWidth width, ViewQuality quality)
+    {
+        Command c{CommandType::ChangeView};
+        c.width = width;
+        c.quality = quality;
+        return c;
+    }
+
+    // El mensaje se trunca a SAY_MAX_SIZE caracteres
+    static Command say(std::string_view msg);
+
+    bool empty() const { return type == CommandType::None; }
+    bool isBody() const { return type >= CommandType::Dash && type <= CommandType::Catch; }
+};
+
+// Escribe el comando en buf con std::to_chars. Devuelve los bytes escritos,
+// o 0 si no cabe (o si el comando está vacío).
+std::size_t serializeCommand(const Command &cmd, char *buf, std::size_t capacity);
+
+// Comandos de un ciclo: uno de cuerpo más cuello, vista y say, que el
+// servidor acepta concatenados en un único datagrama
+struct CommandFrame
+{
+    Command body{};
+    Command turnNeck{};
+    Command changeView{};
+    Command say{};
+
+    bool empty() const { return body.empty() && turnNeck.empty() && changeView.empty() && say.empty(); }
+
+    // Serializa todos los comandos del ciclo seguidos. Devuelve los bytes
+    // escritos, o 0 si no caben.
+    std::size_t serialize(char *buf, std::size_t capacity) const;
+};
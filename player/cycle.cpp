@@ -0,0 +1,54 @@
+#include "cycle.h"
+#include <time.h>
+
+std::int64_t monotonicNowNs()
+{
+    timespec ts{};
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return static_cast<std::int64_t>(ts.tv_sec) * 1'000'000'000 + ts.tv_nsec;
+}
+
+CycleClock::CycleClock(std::int64_t send_offset_ns) : offset_(send_offset_ns)
+{
+}
+
+void CycleClock::onSenseBody(std::int64_t now_ns)
+{
+    // Cerrar el ciclo anterior: ¿se envió algún comando?
+    if (cycle_ >= 0 && lastSentCycle_ != cycle_)
+        ++stats_.cyclesWithoutCommand;
+
+    if (cycle_ < 0) {
+        cycleStart_ = now_ns;
+    } else {
+        // Inicio previsto: el ciclo entero más cercano a la llegada real
+        std::int64_t elapsed = now_ns - cycleStart_;
+        std::int64_t k = (elapsed + period_ / 2) / period_;
+        if (k < 1) k = 1;
+        std::int64_t predicted = cycleStart_ + k * period_;
+        std::int64_t err = now_ns - predicted;
+
+        if (err > period_ / 4 || err < -period_ / 4) {
+            // Demasiado lejos de lo previsto (pausa del servidor, cambio de ritmo): resincronizar
+            cycleStart_ = now_ns;
+        } else {
+            // Filtro suave: la llegada tiene jitter de red y de planificación
+            cycleStart_ = predicted + err / 8;
+            period_ += err / (32 * k);
+        }
+    }
+
+    ++cycle_;
+    ++stats_.cycles;
+}
+
+bool CycleClock::claimSend()
+{
+    if (lastSentCycle_ == cycle_) {
+        ++stats_.duplicateCommands;
+        return false;
+    }
+    lastSentCycle_ = cycle_;
+    ++stats_.commandsSent;
+    return true;
+}
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <cstdint>
+
+// Duración nominal de un ciclo del servidor (simulator_step = 100 ms)
+inline constexpr std::int64_t SERVER_CYCLE_NS = 100'000'000;
+
+// Desfase por defecto dentro del ciclo al que se envía el comando de cuerpo
+inline constexpr std::int64_t DEFAULT_SEND_OFFSET_NS = 70'000'000;
+
+// Tiempo monotónico actual en nanosegundos
+std::int64_t monotonicNowNs();
+
+// Contadores de cumplimiento del ciclo
+struct CycleStats
+{
+    std::uint64_t cycles{0};                // ciclos observados (sense_body recibidos)
+    std::uint64_t commandsSent{0};          // comandos de cuerpo enviados
+    std::uint64_t cyclesWithoutCommand{0};  // ciclos cerrados sin enviar comando
+    std::uint64_t duplicateCommands{0};     // intentos de un segundo comando en el mismo ciclo
+};
+
+// Estima la fase del ciclo del servidor a partir de las llegadas de sense_body
+// (el servidor lo envía al comienzo de cada ciclo) y lleva la cuenta de los
+// comandos enviados por ciclo.
+class CycleClock
+{
+public:
+    explicit CycleClock(std::int64_t send_offset_ns = DEFAULT_SEND_OFFSET_NS);
+
+    // Registra la llegada de un sense_body y abre un ciclo nuevo
+    void onSenseBody(std::int64_t now_ns);
+
+    bool synced() const { return cycle_ >= 0; }
+    std::int64_t cycle() const { return cycle_; }
+    std::int64_t cycleStart() const { return cycleStart_; }
+    std::int64_t period() const { return period_; }
+
+    // Instante en el que toca enviar el comando del ciclo actual
+    std::int64_t sendDeadline() const { return cycleStart_ + offset_; }
+
+    // Reserva el envío del ciclo actual. Devuelve false (y lo cuenta como
+    // duplicado) si ya se envió un comando en este ciclo.
+    bool claimSend();
+
+    const CycleStats &stats() const { return stats_; }
+
+private:
+    std::int64_t offset_;
+    std::int64_t period_{SERVER_CYCLE_NS};
+    std::int64_t cycleStart_{0};
+    std::int64_t cycle_{-1};
+    std::int64_t lastSentCycle_{-1};
+    CycleStats stats_{};
+};
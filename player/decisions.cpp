@@ -1,11 +1,16 @@
 #include "decisions.h"
 #include "positions.h"
+#include "formation.h"
+#include "intercept.h"
+#include "planner.h"
+#include "comm.h"
+#include "coach.h"
+#include <algorithm>
+#include <array>
 #include <cmath>
 
 // Verifica si el jugador está dentro de su zona asignada
-bool estaEnZona(PlayerInfo& player){
-    Zona z = definirZonaJugador(player);
-
+bool estaEnZona(const PlayerInfo& player, const Zona &z){
     double margen = 1.5;  // Margen para evitar estar justo en el borde
 
     return (player.x_abs >= z.x_min + margen &&
@@ -14,61 +19,130 @@ bool estaEnZona(PlayerInfo& player){
             player.y_abs <= z.y_max - margen);
 }
 
-// Obtiene el centro de la zona del jugador
-Point centroZona(PlayerInfo& player){
-    Zona z = definirZonaJugador(player);
-    return {
-        (z.x_min + z.x_max) / 2.0,
-        (z.y_min + z.y_max) / 2.0
-    };
-}
-
 // Calcula el ángulo hacia un punto dado (en grados)
 double anguloHacia(double x, double y, double xt, double yt){
     return atan2(yt - y, xt - x) * 180.0 / M_PI;
 }
 
-std::string playOnDecision(PlayerInfo &player)
+// Distancia a la que se queda un jugador por detrás de la línea del fuera de juego
+static constexpr double OFFSIDE_MARGIN = 1.0;
+
+// Con la línea reciente del penúltimo defensor que da el entrenador, la posición y la
+// zona no pasan de ella salvo que el balón ya esté más adelante
+static void limitarFueraDeJuego(const PlayerInfo &player, FormationSlot &slot)
 {
-    std::string action_cmd{""};
+    const CoachAdvice &advice = player.advice;
+    if (advice.time < 0 || player.sense.time - advice.time > COACH_ADVICE_MAX_AGE || player.side == Side::Unknown)
+        return;
 
-    // VOLVER A ZONA
-    if (!estaEnZona(player))
-    {
-        Point centro = centroZona(player);
+    // En coordenadas propias (x hacia la portería rival) y de vuelta
+    const double sx = player.side == Side::Left ? 1.0 : -1.0;
+    // En el campo propio no hay fuera de juego
+    const double limit = std::max({advice.offsideLine, sx * player.ballPos.x, 0.0}) - OFFSIDE_MARGIN;
+    slot.home.x = sx * std::min(sx * slot.home.x, limit);
 
-        // Angulo absoluto hacia el centro (Matemático CCW)
-        double angAbs = anguloHacia(player.x_abs, player.y_abs,centro.x, centro.y);
+    double lo = sx > 0 ? slot.zone.x_min : -slot.zone.x_max;
+    double hi = std::min(sx > 0 ? slot.zone.x_max : -slot.zone.x_min, limit);
+    lo = std::min(lo, hi - 4.0);   // que siga cabiendo el margen de estaEnZona
+    slot.zone.x_min = sx > 0 ? lo : -hi;
+    slot.zone.x_max = sx > 0 ? hi : -lo;
+}
 
-        // Angulo relativo necesario (Matemático CCW)
-        double angRel = normalizaAngulo(angAbs - player.dir_abs);
+// Posición y zona del jugador según la formación para el balón visto (o el último conocido)
+FormationSlot slotFormacion(PlayerInfo &player, const GameState &gameState)
+{
+    if (player.see.ball.visible) {
+        double a = (player.dir_abs - player.sense.headAngle - player.see.ball.dir) * M_PI / 180.0;
+        player.ballPos = {player.x_abs + player.see.ball.dist * std::cos(a),
+                          player.y_abs + player.see.ball.dist * std::sin(a)};
+    }
+    FormationSlot slot = activeFormation().lookup(player.side, formationSetFor(gameState.playMode),
+                                                  player.ballPos, player.number);
+    limitarFueraDeJuego(player, slot);
+    return slot;
+}
 
-        // Invertimos el signo para el comando.
-        double cmdAngle = -angRel; 
+Command turnToFaceBall(PlayerInfo &player)
+{
+    if (!player.see.ball.visible)
+        return Command::turn(90); // Buscar balón
+    else
+        return Command::turn(player.see.ball.dir);
+}
 
-        // Si el ángulo es grande, GIRAR primero para no irse hacia atrás/lateral
-        if (std::abs(angRel) > 45.0){
-            action_cmd = "(turn " + std::to_string(cmdAngle) + ")";
-        }
-        else {
-            // Dash hacia el objetivo
-            action_cmd = "(dash 100 " + std::to_string(cmdAngle) + ")";
-        }
+// Gira hacia el punto si queda muy de lado; si no, corre hacia él
+static Command irHacia(const PlayerInfo &player, Point destino)
+{
+    // Angulo absoluto hacia el destino (Matemático CCW)
+    double angAbs = anguloHacia(player.x_abs, player.y_abs, destino.x, destino.y);
+
+    // Angulo relativo necesario (Matemático CCW)
+    double angRel = normalizaAngulo(angAbs - player.dir_abs);
+
+    // Invertimos el signo para el comando.
+    double cmdAngle = -angRel; 
+
+    // Si el ángulo es grande, GIRAR primero para no irse hacia atrás/lateral
+    if (std::abs(angRel) > 45.0)
+        return Command::turn(cmdAngle);
+
+    // Dash hacia el objetivo
+    return Command::dash(100, cmdAngle);
+}
+
+// Ciclos de ventaja que debe sacarnos un compañero para dejarle el balón
+static constexpr int INTERCEPT_MARGIN = 2;
 
-        return action_cmd;
+// Va al punto de intercepción salvo que un compañero visto llegue claramente antes
+static Command interceptar(PlayerInfo &player)
+{
+    std::array<Interceptor, INTERCEPTOR_CAPACITY> who;
+    std::array<InterceptResult, INTERCEPTOR_CAPACITY> res;
+    std::size_t n = gatherInterceptors(player, who);
+    interceptModel().solve(player.ballPos, player.ballVel, std::span(who.data(), n), res);
+
+    for (std::size_t i = 1; i < n; ++i) {
+        if (who[i].team == TeamSide::Own && res[i].cycle + INTERCEPT_MARGIN < res[0].cycle)
+            return turnToFaceBall(player);
     }
 
+    // Lo que dicen los compañeros de su propia intercepción (con su orientación, más fiable)
+    const int now = player.sense.time;
+    for (std::size_t m = 1; m < player.heard.mates.size(); ++m) {
+        const HeardMate &mate = player.heard.mates[m];
+        if (static_cast<int>(m) == player.number || mate.claimArrival < 0 || now - mate.time > HEARD_MAX_AGE)
+            continue;
+        if (mate.claimArrival + INTERCEPT_MARGIN < now + res[0].cycle)
+            return turnToFaceBall(player);
+    }
+    return irHacia(player, res[0].point);
+}
+
+Command playOnDecision(PlayerInfo &player, const GameState &gameState, const ActionChain *plan)
+{
+    Command action_cmd;
+
+    // VOLVER A ZONA (una sola consulta a la formación por ciclo)
+    FormationSlot slot = slotFormacion(player, gameState);
+    if (!estaEnZona(player, slot.zone))
+        return irHacia(player, slot.home);
+
     // COMPORTAMIENTO CON BALÓN
     
     if (!player.see.ball.visible)
     {
-        action_cmd = "(turn 90)"; // Buscar balón
+        action_cmd = Command::turn(90); // Buscar balón
     }
     else
     {
-        // Si el balón está lejos, ir hacia él
-        if (player.see.ball.dist > 1){ 
-            action_cmd = "(dash 100 " + std::to_string(player.see.ball.dir) + ")";
+        // Si el balón está lejos, ir a cortarlo
+        if (player.see.ball.dist > BALL_CONTROL_DIST){ 
+            action_cmd = interceptar(player);
+        }
+        else if (plan && !plan->empty())
+        {
+            // Primera acción de la mejor cadena del planificador
+            action_cmd = planKick(player, plan->actions[0]);
         }
         else 
         {
@@ -104,119 +178,93 @@ std::string playOnDecision(PlayerInfo &player)
             }
 
             // Ejecutamos el tiro con el ángulo decidido (sea visual o calculado)
-            action_cmd = "(kick 100 " + std::to_string(kickAngle) + ")";
+            action_cmd = Command::kick(100, kickAngle);
         }
     }
     return action_cmd;
 }
 
-std::string beforeKickOffDecision(PlayerInfo &player)
+Command beforeKickOffDecision(PlayerInfo &player)
 {
-    return "(move " + std::to_string(player.initialPosition.x) + " " + std::to_string(player.initialPosition.y) + ")";
+    return Command::move(player.initialPosition.x, player.initialPosition.y);
 }
 
-bool isOurKickOff(const PlayerInfo &player, const GameState &gameState)
-{
-    if (gameState.playMode == PlayMode::KickOff_Left && player.side == Side::Left)
-        return true;
-    if (gameState.playMode == PlayMode::KickOff_Right && player.side == Side::Right)
-        return true;
-    return false;
-}
+// --- Despacho por (modo de juego, papel) ------------------------------------------
 
-bool isOurGoalKick(const PlayerInfo &player, const GameState &gameState)
+// Papel del jugador en los saques: el portero saca de puerta y atrapa, el 10 tira los penaltis
+enum class Role : std::uint8_t
 {
-    if (gameState.playMode == PlayMode::GoalKick_Left && player.side == Side::Left)
-        return true;
-    if (gameState.playMode == PlayMode::GoalKick_Right && player.side == Side::Right)
-        return true;
-    return false;
-}
+    Field, Goalie, PenaltyTaker, Count
+};
 
-bool isOurKickIn(const PlayerInfo &player, const GameState &gameState)
+static Role roleOf(const PlayerInfo &player)
 {
-    if (gameState.playMode == PlayMode::KickIn_Left && player.side == Side::Left)
-        return true;
-    if (gameState.playMode == PlayMode::KickIn_Right && player.side == Side::Right)
-        return true;
-    return false;
+    if (player.number == 1)
+        return Role::Goalie;
+    if (player.number == 10)
+        return Role::PenaltyTaker;
+    return Role::Field;
 }
 
-bool isOurCorner(const PlayerInfo &player, const GameState &gameState)
-{
-    if (gameState.playMode == PlayMode::Corner_Left && player.side == Side::Left)
-        return true;
-    if (gameState.playMode == PlayMode::Corner_Right && player.side == Side::Right)
-        return true;
-    return false;
-}
+using Behavior = Command (*)(PlayerInfo &, const GameState &, const ActionChain *);
 
-bool isOurFreeKick(const PlayerInfo &player, const GameState &gameState)
+static Command jugar(PlayerInfo &player, const GameState &gameState, const ActionChain *plan)
 {
-    if (gameState.playMode == PlayMode::FreeKick_Left && player.side == Side::Left)
-        return true;
-    if (gameState.playMode == PlayMode::FreeKick_Right && player.side == Side::Right)
-        return true;
-    return false;
+    return playOnDecision(player, gameState, plan);
 }
+static Command colocarse(PlayerInfo &player, const GameState &, const ActionChain *) { return beforeKickOffDecision(player); }
+static Command mirarBalon(PlayerInfo &player, const GameState &, const ActionChain *) { return turnToFaceBall(player); }
+static Command esperar(PlayerInfo &, const GameState &, const ActionChain *) { return Command{}; }
 
-bool isOurPenaltyKick(const PlayerInfo &player, const GameState &gameState)
-{
-    if (gameState.playMode == PlayMode::PenaltyKick_Left && player.side == Side::Left)
-        return true;
-    if (gameState.playMode == PlayMode::PenaltyKick_Right && player.side == Side::Right)
-        return true;
-    return false;
-}
+static constexpr std::size_t ROLE_COUNT = static_cast<std::size_t>(Role::Count);
 
-std::string turnToFaceBall(PlayerInfo &player)
-{
-    if (!player.see.ball.visible)
-        return "(turn 90)"; // Buscar balón
-    else
-        return "(turn " + std::to_string(player.see.ball.dir) + ")";
-}
+// Comportamiento de cada papel en cada modo; los modos que no aparecen no envían comando
+static constexpr auto DISPATCH = [] {
+    std::array<std::array<Behavior, ROLE_COUNT>, PLAY_MODE_COUNT> t{};
+    for (auto &row : t)
+        row.fill(esperar);
+
+    auto set = [&](PlayMode m, Behavior field, Behavior goalie, Behavior taker) {
+        t[static_cast<std::size_t>(m)] = {field, goalie, taker};
+    };
+    auto all = [&](PlayMode m, Behavior b) { set(m, b, b, b); };
+
+    // Juego y colocación
+    all(PlayMode::PlayOn, jugar);
+    all(PlayMode::DropBall, jugar);
+    all(PlayMode::BeforeKickOff, colocarse);     // también tras un gol: se puede usar move
+    all(PlayMode::OurGoal, colocarse);
+    all(PlayMode::TheirGoal, colocarse);
 
-std::string decideAction(PlayerInfo &player, const GameState &gameState)
+    // Saques nuestros: juega todo el equipo, salvo los que ejecuta un solo jugador
+    for (PlayMode m : {PlayMode::OurKickOff, PlayMode::OurKickIn, PlayMode::OurCorner,
+                       PlayMode::OurFreeKick, PlayMode::OurIndirectFreeKick})
+        all(m, jugar);
+    set(PlayMode::OurGoalKick, mirarBalon, jugar, mirarBalon);
+    set(PlayMode::OurGoalieCatch, mirarBalon, jugar, mirarBalon);
+    for (PlayMode m : {PlayMode::OurPenaltyKick, PlayMode::OurPenaltySetup, PlayMode::OurPenaltyReady,
+                       PlayMode::OurPenaltyTaken})
+        set(m, mirarBalon, mirarBalon, jugar);
+
+    // Saques del rival, infracciones (el saque está por llegar) y final de penalti: atentos al balón
+    for (PlayMode m : {PlayMode::TheirKickOff, PlayMode::TheirKickIn, PlayMode::TheirCorner,
+                       PlayMode::TheirFreeKick, PlayMode::TheirIndirectFreeKick, PlayMode::TheirGoalKick,
+                       PlayMode::TheirGoalieCatch, PlayMode::TheirPenaltyKick, PlayMode::TheirPenaltySetup,
+                       PlayMode::TheirPenaltyReady, PlayMode::TheirPenaltyTaken,
+                       PlayMode::OurPenaltyMiss, PlayMode::TheirPenaltyMiss,
+                       PlayMode::OurPenaltyScore, PlayMode::TheirPenaltyScore,
+                       PlayMode::FoulByUs, PlayMode::FoulByThem, PlayMode::OffsideByUs, PlayMode::OffsideByThem,
+                       PlayMode::BackPassByUs, PlayMode::BackPassByThem,
+                       PlayMode::FreeKickFaultByUs, PlayMode::FreeKickFaultByThem,
+                       PlayMode::CatchFaultByUs, PlayMode::CatchFaultByThem,
+                       PlayMode::IllegalDefenseByUs, PlayMode::IllegalDefenseByThem,
+                       PlayMode::PenaltyFoulByUs, PlayMode::PenaltyFoulByThem})
+        all(m, mirarBalon);
+    return t;
+}();
+
+Command decideAction(PlayerInfo &player, const GameState &gameState, const ActionChain *plan)
 {
-    if (gameState.playMode == PlayMode::PlayOn) { // JUGAR NORMAL
-        return playOnDecision(player);
-    } 
-    if (gameState.playMode == PlayMode::BeforeKickOff || // TP AL SACAR [TRAS GOL]
-               gameState.playMode == PlayMode::Goal_Left ||
-               gameState.playMode == PlayMode::Goal_Right) {
-        return beforeKickOffDecision(player);
-    } 
-    if (gameState.playMode == PlayMode::KickIn_Left || // FALTAS / CORNERS / SAQUES DE BANDA / SAQUE DE CENTRO
-               gameState.playMode == PlayMode::KickIn_Right ||
-               gameState.playMode == PlayMode::Corner_Left ||
-               gameState.playMode == PlayMode::Corner_Right ||
-               gameState.playMode == PlayMode::FreeKick_Left ||
-               gameState.playMode == PlayMode::FreeKick_Right || 
-               gameState.playMode == PlayMode::KickOff_Left ||
-               gameState.playMode == PlayMode::KickOff_Right) {
-        if (isOurKickIn(player, gameState) || isOurCorner(player, gameState) || isOurFreeKick(player, gameState) || isOurKickOff(player, gameState)) {
-            return playOnDecision(player);
-        } else {
-            return turnToFaceBall(player);
-        }
-        return playOnDecision(player);
-    } if (gameState.playMode == PlayMode::GoalKick_Left || // SAQUE DE PORTERÍA
-               gameState.playMode == PlayMode::GoalKick_Right) {
-        if (isOurGoalKick(player, gameState) && player.number==1) {
-            return playOnDecision(player);
-        } else {
-            return turnToFaceBall(player);
-        }
-        return playOnDecision(player);
-    } if (gameState.playMode == PlayMode::PenaltyKick_Left || // PENALTI
-               gameState.playMode == PlayMode::PenaltyKick_Right) {
-        if (isOurPenaltyKick(player, gameState) && player.number==10) {
-            return playOnDecision(player);
-        } else {
-            return turnToFaceBall(player);
-        }
-        return playOnDecision(player);
-    }
-    return "";
-}
\ No newline at end of file
+    return DISPATCH[static_cast<std::size_t>(gameState.playMode)][static_cast<std::size_t>(roleOf(player))](
+        player, gameState, plan);
+}
@@ -1,6 +1,10 @@
 #pragma once
 
 #include "types.h"
+#include "command.h"
 
-// Decide la acción a realizar basándose en la información visual del jugador
-std::string decideAction(PlayerInfo &player, const GameState &gameState);
\ No newline at end of file
+struct ActionChain;
+
+// Decide la acción a realizar basándose en la información visual del jugador.
+// Con el balón controlado chuta según la primera acción de plan si la hay.
+Command decideAction(PlayerInfo &player, const GameState &gameState, const ActionChain *plan = nullptr);
\ No newline at end of file
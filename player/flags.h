@@ -0,0 +1,168 @@
+#pragma once
+
+#include "types.h"
+#include <array>
+#include <cstdint>
+#include <string_view>
+
+// Bandera (o portería) del campo con su posición absoluta.
+// Convenio del equipo: x positiva hacia la portería derecha, y positiva hacia la banda superior (t).
+struct FlagDef
+{
+    std::string_view name;
+    Point pos;
+};
+
+// Distancias del campo según rcssserver
+inline constexpr double PITCH_HALF_LENGTH = 52.5;
+inline constexpr double PITCH_HALF_WIDTH  = 34.0;
+inline constexpr double PITCH_MARGIN      = 5.0;     // Banderas exteriores a 5 m de las líneas
+inline constexpr double GOAL_POST_Y       = 7.01;    // goal_width / 2
+inline constexpr double PENALTY_X         = 36.0;    // 52.5 - penalty_area_length
+inline constexpr double PENALTY_Y         = 20.16;   // penalty_area_width / 2
+
+// Tabla completa de las 55 marcas del servidor. El índice en la tabla es el FlagId.
+inline constexpr std::array<FlagDef, 55> FLAG_TABLE = {{
+    // Centro
+    {"f c",      {0.0, 0.0}},
+    {"f c t",    {0.0,  PITCH_HALF_WIDTH}},
+    {"f c b",    {0.0, -PITCH_HALF_WIDTH}},
+
+    // Corners
+    {"f l t",    {-PITCH_HALF_LENGTH,  PITCH_HALF_WIDTH}},
+    {"f l b",    {-PITCH_HALF_LENGTH, -PITCH_HALF_WIDTH}},
+    {"f r t",    { PITCH_HALF_LENGTH,  PITCH_HALF_WIDTH}},
+    {"f r b",    { PITCH_HALF_LENGTH, -PITCH_HALF_WIDTH}},
+
+    // Postes de portería
+    {"f g l t",  {-PITCH_HALF_LENGTH,  GOAL_POST_Y}},
+    {"f g l b",  {-PITCH_HALF_LENGTH, -GOAL_POST_Y}},
+    {"f g r t",  { PITCH_HALF_LENGTH,  GOAL_POST_Y}},
+    {"f g r b",  { PITCH_HALF_LENGTH, -GOAL_POST_Y}},
+
+    // Áreas de penalti
+    {"f p l t",  {-PENALTY_X,  PENALTY_Y}},
+    {"f p l c",  {-PENALTY_X,  0.0}},
+    {"f p l b",  {-PENALTY_X, -PENALTY_Y}},
+    {"f p r t",  { PENALTY_X,  PENALTY_Y}},
+    {"f p r c",  { PENALTY_X,  0.0}},
+    {"f p r b",  { PENALTY_X, -PENALTY_Y}},
+
+    // Línea exterior superior
+    {"f t 0",    {  0.0, PITCH_HALF_WIDTH + PITCH_MARGIN}},
+    {"f t l 10", {-10.0, PITCH_HALF_WIDTH + PITCH_MARGIN}},
+    {"f t l 20", {-20.0, PITCH_HALF_WIDTH + PITCH_MARGIN}},
+    {"f t l 30", {-30.0, PITCH_HALF_WIDTH + PITCH_MARGIN}},
+    {"f t l 40", {-40.0, PITCH_HALF_WIDTH + PITCH_MARGIN}},
+    {"f t l 50", {-50.0, PITCH_HALF_WIDTH + PITCH_MARGIN}},
+    {"f t r 10", { 10.0, PITCH_HALF_WIDTH + PITCH_MARGIN}},
+    {"f t r 20", { 20.0, PITCH_HALF_WIDTH + PITCH_MARGIN}},
+    {"f t r 30", { 30.0, PITCH_HALF_WIDTH + PITCH_MARGIN}},
+    {"f t r 40", { 40.0, PITCH_HALF_WIDTH + PITCH_MARGIN}},
+    {"f t r 50", { 50.0, PITCH_HALF_WIDTH + PITCH_MARGIN}},
+
+    // Línea exterior inferior
+    {"f b 0",    {  0.0, -(PITCH_HALF_WIDTH + PITCH_MARGIN)}},
+    {"f b l 10", {-10.0, -(PITCH_HALF_WIDTH + PITCH_MARGIN)}},
+    {"f b l 20", {-20.0, -(PITCH_HALF_WIDTH + PITCH_MARGIN)}},
+    {"f b l 30", {-30.0, -(PITCH_HALF_WIDTH + PITCH_MARGIN)}},
+    {"f b l 40", {-40.0, -(PITCH_HALF_WIDTH + PITCH_MARGIN)}},
+    {"f b l 50", {-50.0, -(PITCH_HALF_WIDTH + PITCH_MARGIN)}},
+    {"f b r 10", { 10.0, -(PITCH_HALF_WIDTH + PITCH_MARGIN)}},
+    {"f b r 20", { 20.0, -(PITCH_HALF_WIDTH + PITCH_MARGIN)}},
+    {"f b r 30", { 30.0, -(PITCH_HALF_WIDTH + PITCH_MARGIN)}},
+    {"f b r 40", { 40.0, -(PITCH_HALF_WIDTH + PITCH_MARGIN)}},
+    {"f b r 50", { 50.0, -(PITCH_HALF_WIDTH + PITCH_MARGIN)}},
+
+    // Línea exterior izquierda
+    {"f l 0",    {-(PITCH_HALF_LENGTH + PITCH_MARGIN),   0.0}},
+    {"f l t 10", {-(PITCH_HALF_LENGTH + PITCH_MARGIN),  10.0}},
+    {"f l t 20", {-(PITCH_HALF_LENGTH + PITCH_MARGIN),  20.0}},
+    {"f l t 30", {-(PITCH_HALF_LENGTH + PITCH_MARGIN),  30.0}},
+    {"f l b 10", {-(PITCH_HALF_LENGTH + PITCH_MARGIN), -10.0}},
+    {"f l b 20", {-(PITCH_HALF_LENGTH + PITCH_MARGIN), -20.0}},
+    {"f l b 30", {-(PITCH_HALF_LENGTH + PITCH_MARGIN), -30.0}},
+
+    // Línea exterior derecha
+    {"f r 0",    { PITCH_HALF_LENGTH + PITCH_MARGIN,   0.0}},
+    {"f r t 10", { PITCH_HALF_LENGTH + PITCH_MARGIN,  10.0}},
+    {"f r t 20", { PITCH_HALF_LENGTH + PITCH_MARGIN,  20.0}},
+    {"f r t 30", { PITCH_HALF_LENGTH + PITCH_MARGIN,  30.0}},
+    {"f r b 10", { PITCH_HALF_LENGTH + PITCH_MARGIN, -10.0}},
+    {"f r b 20", { PITCH_HALF_LENGTH + PITCH_MARGIN, -20.0}},
+    {"f r b 30", { PITCH_HALF_LENGTH + PITCH_MARGIN, -30.0}},
+
+    // Porterías (centro de la línea de gol)
+    {"g l",      {-PITCH_HALF_LENGTH, 0.0}},
+    {"g r",      { PITCH_HALF_LENGTH, 0.0}},
+}};
+
+inline constexpr std::size_t FLAG_COUNT = FLAG_TABLE.size();
+static_assert(FLAG_COUNT < FLAG_NONE, "FlagId debe caber en uint8_t");
+
+// --- Hash perfecto sobre los bytes del nombre ---------------------------------
+// FNV-1a con semilla, reducido a FLAG_HASH_BITS bits. La semilla se busca en
+// tiempo de compilación de forma que las 55 marcas caigan en huecos distintos.
+
+inline constexpr unsigned FLAG_HASH_BITS = 9;
+inline constexpr std::size_t FLAG_HASH_SLOTS = std::size_t{1} << FLAG_HASH_BITS;
+
+constexpr std::uint32_t flagHash(std::string_view name, std::uint32_t seed)
+{
+    std::uint32_t h = 2166136261u ^ seed;
+    for (char c : name) {
+        h ^= static_cast<unsigned char>(c);
+        h *= 16777619u;
+    }
+    return (h * 0x9E3779B1u) >> (32 - FLAG_HASH_BITS);
+}
+
+consteval std::uint32_t findFlagHashSeed()
+{
+    for (std::uint32_t seed = 1;; ++seed) {
+        std::array<bool, FLAG_HASH_SLOTS> used{};
+        bool ok = true;
+        for (const auto &f : FLAG_TABLE) {
+            auto slot = flagHash(f.name, seed);
+            if (used[slot]) { ok = false; break; }
+            used[slot] = true;
+        }
+        if (ok) return seed;
+    }
+}
+
+inline constexpr std::uint32_t FLAG_HASH_SEED = findFlagHashSeed();
+
+consteval std::array<FlagId, FLAG_HASH_SLOTS> buildFlagHashSlots()
+{
+    std::array<FlagId, FLAG_HASH_SLOTS> slots{};
+    for (auto &s : slots) s = FLAG_NONE;
+    for (std::size_t i = 0; i < FLAG_COUNT; ++i)
+        slots[flagHash(FLAG_TABLE[i].name, FLAG_HASH_SEED)] = static_cast<FlagId>(i);
+    return slots;
+}
+
+inline constexpr std::array<FlagId, FLAG_HASH_SLOTS> FLAG_HASH_SLOTS_TABLE = buildFlagHashSlots();
+
+// Devuelve el FlagId de un nombre crudo del mensaje (ej: "f t l 40") o FLAG_NONE
+constexpr FlagId lookupFlag(std::string_view name)
+{
+    FlagId id = FLAG_HASH_SLOTS_TABLE[flagHash(name, FLAG_HASH_SEED)];
+    if (id == FLAG_NONE || FLAG_TABLE[id].name != name)
+        return FLAG_NONE;
+    return id;
+}
+
+constexpr std::string_view flagName(FlagId id)
+{
+    return id < FLAG_COUNT ? FLAG_TABLE[id].name : std::string_view{};
+}
+
+constexpr Point flagPosition(FlagId id)
+{
+    return id < FLAG_COUNT ? FLAG_TABLE[id].pos : Point{};
+}
+
+static_assert(lookupFlag("f t l 40") != FLAG_NONE);
+static_assert(flagName(lookupFlag("f p r c")) == "f p r c");
+static_assert(lookupFlag("f x") == FLAG_NONE);
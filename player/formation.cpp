@@ -0,0 +1,393 @@
+#include "formation.h"
+#include "flags.h"
+#include "log.h"
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <limits>
+#include <sstream>
+
+// Rejilla de localización: cubre el campo y sus márgenes en celdas de 2.5 m
+static constexpr double GRID_MIN_X = -PITCH_HALF_LENGTH - PITCH_MARGIN;
+static constexpr double GRID_MIN_Y = -PITCH_HALF_WIDTH - PITCH_MARGIN;
+static constexpr double GRID_CELL = 2.5;
+static constexpr int GRID_COLS = static_cast<int>(2 * (PITCH_HALF_LENGTH + PITCH_MARGIN) / GRID_CELL) + 1;
+static constexpr int GRID_ROWS = static_cast<int>(2 * (PITCH_HALF_WIDTH + PITCH_MARGIN) / GRID_CELL) + 1;
+
+// Zonas por defecto de cada dorsal (1-11) en coordenadas propias
+static constexpr Zona DEFAULT_ZONES[FORMATION_PLAYERS] = {
+    { -52.5, -40.0, -12.0,  12.0 },     // 1: Portero
+    { -52.5, -15.0,  10.0,  34.0 },     // 2-5: Defensa
+    { -52.5, -20.0,  -2.0,  20.0 },
+    { -52.5, -20.0, -20.0,   2.0 },
+    { -52.5, -15.0, -34.0, -10.0 },
+    { -35.0,  10.0, -15.0,  15.0 },     // 6-8: Medios
+    { -30.0,  25.0,  10.0,  34.0 },
+    { -30.0,  25.0, -34.0, -10.0 },
+    {  -5.0,  52.5,  10.0,  34.0 },     // 9-11: Delanteros
+    { -10.0,  52.5, -15.0,  15.0 },
+    {  -5.0,  52.5, -34.0, -10.0 }
+};
+
+static constexpr const char *FORMATION_SET_NAMES[] = {"play_on", "our_set_play", "their_set_play"};
+
+FormationSet formationSetFor(PlayMode mode)
+{
+    switch (mode) {
+        // Saques nuestros y las infracciones del rival, que terminan en saque nuestro
+        case PlayMode::OurKickOff: case PlayMode::OurKickIn: case PlayMode::OurCorner:
+        case PlayMode::OurGoalKick: case PlayMode::OurFreeKick: case PlayMode::OurIndirectFreeKick:
+        case PlayMode::OurGoalieCatch: case PlayMode::OurPenaltyKick:
+        case PlayMode::FoulByThem: case PlayMode::OffsideByThem: case PlayMode::BackPassByThem:
+        case PlayMode::FreeKickFaultByThem: case PlayMode::CatchFaultByThem: case PlayMode::IllegalDefenseByThem:
+            return FormationSet::OurSetPlay;
+        case PlayMode::TheirKickOff: case PlayMode::TheirKickIn: case PlayMode::TheirCorner:
+        case PlayMode::TheirGoalKick: case PlayMode::TheirFreeKick: case PlayMode::TheirIndirectFreeKick:
+        case PlayMode::TheirGoalieCatch: case PlayMode::TheirPenaltyKick:
+        case PlayMode::FoulByUs: case PlayMode::OffsideByUs: case PlayMode::BackPassByUs:
+        case PlayMode::FreeKickFaultByUs: case PlayMode::CatchFaultByUs: case PlayMode::IllegalDefenseByUs:
+            return FormationSet::TheirSetPlay;
+        default:
+            return FormationSet::PlayOn;
+    }
+}
+
+// --- Triangulación ------------------------------------------------------------
+
+// Pesos baricéntricos de p en el triángulo abc; false si el triángulo es degenerado
+static bool barycentric(Point p, Point a, Point b, Point c, double w[3])
+{
+    double d = (b.y - c.y) * (a.x - c.x) + (c.x - b.x) * (a.y - c.y);
+    if (std::fabs(d) < 1e-12)
+        return false;
+    w[0] = ((b.y - c.y) * (p.x - c.x) + (c.x - b.x) * (p.y - c.y)) / d;
+    w[1] = ((c.y - a.y) * (p.x - c.x) + (a.x - c.x) * (p.y - c.y)) / d;
+    w[2] = 1.0 - w[0] - w[1];
+    return true;
+}
+
+// Bowyer-Watson: O(n²), suficiente para las decenas de muestras de una formación
+static std::vector<std::array<std::uint16_t, 3>> delaunay(const std::vector<Point> &input)
+{
+    struct Tri
+    {
+        int v[3];
+        Point center;
+        double r2;
+    };
+
+    std::vector<Point> pts = input;
+    double minX = pts[0].x, maxX = pts[0].x, minY = pts[0].y, maxY = pts[0].y;
+    for (const Point &p : pts) {
+        minX = std::min(minX, p.x); maxX = std::max(maxX, p.x);
+        minY = std::min(minY, p.y); maxY = std::max(maxY, p.y);
+    }
+    double span = std::max({maxX - minX, maxY - minY, 1.0}) * 20.0;
+    double midX = (minX + maxX) / 2.0, midY = (minY + maxY) / 2.0;
+    const int n = static_cast<int>(pts.size());
+    pts.push_back({midX - span, midY - span});
+    pts.push_back({midX + span, midY - span});
+    pts.push_back({midX, midY + span});
+
+    auto makeTri = [&pts](int a, int b, int c) {
+        Point A = pts[a], B = pts[b], C = pts[c];
+        double d = 2.0 * (A.x * (B.y - C.y) + B.x * (C.y - A.y) + C.x * (A.y - B.y));
+        Tri t{{a, b, c}, {}, std::numeric_limits<double>::infinity()};
+        if (std::fabs(d) > 1e-12) {
+            double a2 = A.x * A.x + A.y * A.y, b2 = B.x * B.x + B.y * B.y, c2 = C.x * C.x + C.y * C.y;
+            t.center = {(a2 * (B.y - C.y) + b2 * (C.y - A.y) + c2 * (A.y - B.y)) / d,
+                        (a2 * (C.x - B.x) + b2 * (A.x - C.x) + c2 * (B.x - A.x)) / d};
+            t.r2 = (A.x - t.center.x) * (A.x - t.center.x) + (A.y - t.center.y) * (A.y - t.center.y);
+        }
+        return t;
+    };
+
+    std::vector<Tri> tris{makeTri(n, n + 1, n + 2)};
+    std::vector<std::array<int, 2>> edges;
+    for (int i = 0; i < n; ++i) {
+        const Point p = pts[i];
+        edges.clear();
+        std::vector<Tri> keep;
+        keep.reserve(tris.size());
+        for (const Tri &t : tris) {
+            double dx = p.x - t.center.x, dy = p.y - t.center.y;
+            if (dx * dx + dy * dy < t.r2 * (1.0 - 1e-12)) {
+                for (int e = 0; e < 3; ++e)
+                    edges.push_back({t.v[e], t.v[(e + 1) % 3]});
+            } else {
+                keep.push_back(t);
+            }
+        }
+        // El borde del hueco son las aristas que sólo pertenecen a un triángulo eliminado
+        for (std::size_t a = 0; a < edges.size(); ++a) {
+            bool shared = false;
+            for (std::size_t b = 0; b < edges.size(); ++b) {
+                if (a != b && edges[a][0] == edges[b][1] && edges[a][1] == edges[b][0]) {
+                    shared = true;
+                    break;
+                }
+            }
+            if (!shared)
+                keep.push_back(makeTri(edges[a][0], edges[a][1], i));
+        }
+        tris = std::move(keep);
+    }
+
+    std::vector<std::array<std::uint16_t, 3>> out;
+    for (const Tri &t : tris) {
+        if (t.v[0] >= n || t.v[1] >= n || t.v[2] >= n)
+            continue;
+        double w[3];
+        if (!barycentric(pts[t.v[0]], pts[t.v[0]], pts[t.v[1]], pts[t.v[2]], w))
+            continue;
+        out.push_back({static_cast<std::uint16_t>(t.v[0]), static_cast<std::uint16_t>(t.v[1]),
+                       static_cast<std::uint16_t>(t.v[2])});
+    }
+    return out;
+}
+
+void FormationTable::build(std::vector<Point> balls, std::vector<std::array<Point, FORMATION_PLAYERS>> homes)
+{
+    balls_ = std::move(balls);
+    homes_ = std::move(homes);
+    triangles_ = balls_.size() >= 3 ? delaunay(balls_) : decltype(triangles_){};
+
+    // Rejilla: triángulos cuyo rectángulo envolvente toca la celda; las celdas
+    // fuera de la envolvente convexa se quedan con el triángulo más cercano
+    cellStart_.assign(1, 0);
+    cellTriangles_.clear();
+    for (int row = 0; row < GRID_ROWS; ++row) {
+        for (int col = 0; col < GRID_COLS; ++col) {
+            double x0 = GRID_MIN_X + col * GRID_CELL, y0 = GRID_MIN_Y + row * GRID_CELL;
+            double x1 = x0 + GRID_CELL, y1 = y0 + GRID_CELL;
+            std::size_t before = cellTriangles_.size();
+            double bestDist = std::numeric_limits<double>::infinity();
+            std::uint16_t nearest = 0;
+
+            for (std::size_t t = 0; t < triangles_.size(); ++t) {
+                const auto &v = triangles_[t];
+                Point a = balls_[v[0]], b = balls_[v[1]], c = balls_[v[2]];
+                double minX = std::min({a.x, b.x, c.x}), maxX = std::max({a.x, b.x, c.x});
+                double minY = std::min({a.y, b.y, c.y}), maxY = std::max({a.y, b.y, c.y});
+                if (maxX >= x0 && minX <= x1 && maxY >= y0 && minY <= y1)
+                    cellTriangles_.push_back(static_cast<std::uint16_t>(t));
+
+                double cx = (a.x + b.x + c.x) / 3.0 - (x0 + x1) / 2.0;
+                double cy = (a.y + b.y + c.y) / 3.0 - (y0 + y1) / 2.0;
+                if (cx * cx + cy * cy < bestDist) {
+                    bestDist = cx * cx + cy * cy;
+                    nearest = static_cast<std::uint16_t>(t);
+                }
+            }
+            if (cellTriangles_.size() == before && !triangles_.empty())
+                cellTriangles_.push_back(nearest);
+            cellStart_.push_back(static_cast<std::uint32_t>(cellTriangles_.size()));
+        }
+    }
+}
+
+Point FormationTable::home(Point ball, int unum) const
+{
+    const int k = std::clamp(unum, 1, FORMATION_PLAYERS) - 1;
+    if (triangles_.empty())
+        return homes_.front()[k];
+
+    int col = std::clamp(static_cast<int>((ball.x - GRID_MIN_X) / GRID_CELL), 0, GRID_COLS - 1);
+    int row = std::clamp(static_cast<int>((ball.y - GRID_MIN_Y) / GRID_CELL), 0, GRID_ROWS - 1);
+    std::size_t cell = static_cast<std::size_t>(row) * GRID_COLS + static_cast<std::size_t>(col);
+
+    // Triángulo que contiene el balón; si ninguno lo contiene (fuera de la
+    // envolvente), el menos alejado con los pesos recortados a [0, 1]
+    double best[3] = {1.0, 0.0, 0.0};
+    double bestMin = -std::numeric_limits<double>::infinity();
+    std::size_t bestTri = cellTriangles_[cellStart_[cell]];
+    for (std::uint32_t i = cellStart_[cell]; i < cellStart_[cell + 1]; ++i) {
+        const auto &v = triangles_[cellTriangles_[i]];
+        double w[3];
+        if (!barycentric(ball, balls_[v[0]], balls_[v[1]], balls_[v[2]], w))
+            continue;
+        double minW = std::min({w[0], w[1], w[2]});
+        if (minW > bestMin) {
+            bestMin = minW;
+            bestTri = cellTriangles_[i];
+            std::copy(w, w + 3, best);
+            if (minW >= 0.0)
+                break;
+        }
+    }
+    if (bestMin < 0.0) {
+        double sum = 0.0;
+        for (double &w : best) {
+            w = std::max(w, 0.0);
+            sum += w;
+        }
+        for (double &w : best)
+            w = sum > 0.0 ? w / sum : 1.0 / 3.0;
+    }
+
+    const auto &v = triangles_[bestTri];
+    Point out{};
+    for (int i = 0; i < 3; ++i) {
+        out.x += best[i] * homes_[v[i]][k].x;
+        out.y += best[i] * homes_[v[i]][k].y;
+    }
+    return out;
+}
+
+// --- Formación ----------------------------------------------------------------
+
+using SetBalls = std::array<std::vector<Point>, static_cast<std::size_t>(FormationSet::Count)>;
+using SetHomes = std::array<std::vector<std::array<Point, FORMATION_PLAYERS>>, static_cast<std::size_t>(FormationSet::Count)>;
+
+Formation Formation::makeDefault()
+{
+    // Las mismas posiciones para cualquier balón: equivale a las zonas fijas por dorsal
+    std::array<Point, FORMATION_PLAYERS> homes;
+    Formation f;
+    for (int i = 0; i < FORMATION_PLAYERS; ++i) {
+        const Zona &z = DEFAULT_ZONES[i];
+        homes[i] = {(z.x_min + z.x_max) / 2.0, (z.y_min + z.y_max) / 2.0};
+        f.zoneHalf_[i] = {(z.x_max - z.x_min) / 2.0, (z.y_max - z.y_min) / 2.0};
+    }
+
+    SetBalls balls;
+    SetHomes sets;
+    for (double x : {-PITCH_HALF_LENGTH, PITCH_HALF_LENGTH}) {
+        for (double y : {-PITCH_HALF_WIDTH, PITCH_HALF_WIDTH}) {
+            balls[0].push_back({x, y});
+            sets[0].push_back(homes);
+        }
+    }
+    f.build(balls, sets);
+    return f;
+}
+
+bool Formation::build(const SetBalls &balls, const SetHomes &homes)
+{
+    if (balls[static_cast<std::size_t>(FormationSet::PlayOn)].empty())
+        return false;
+
+    for (int s = 0; s < 2; ++s) {
+        // El lado derecho ataca hacia x negativa: se refleja todo una sola vez aquí
+        const double sign = (s == 0) ? 1.0 : -1.0;
+        for (std::size_t set = 0; set < balls.size(); ++set) {
+            std::size_t src = balls[set].empty() ? static_cast<std::size_t>(FormationSet::PlayOn) : set;
+            std::vector<Point> b = balls[src];
+            std::vector<std::array<Point, FORMATION_PLAYERS>> h = homes[src];
+            for (Point &p : b)
+                p = {sign * p.x, sign * p.y};
+            for (auto &sample : h) {
+                for (Point &p : sample)
+                    p = {sign * p.x, sign * p.y};
+            }
+            tables_[s][set].build(std::move(b), std::move(h));
+        }
+    }
+    return true;
+}
+
+bool Formation::load(const std::string &path)
+{
+    std::ifstream in(path);
+    if (!in) {
+        LOG_ERROR("Cannot open formation file {}", path);
+        return false;
+    }
+
+    SetBalls balls;
+    SetHomes homes;
+    Formation defaults = makeDefault();
+    zoneHalf_ = defaults.zoneHalf_;
+    int set = -1;
+    int lineNo = 0;
+    std::string line;
+
+    while (std::getline(in, line)) {
+        ++lineNo;
+        auto hash = line.find('#');
+        if (hash != std::string::npos)
+            line.erase(hash);
+        std::istringstream ls(line);
+        std::string first;
+        if (!(ls >> first))
+            continue;
+
+        if (first.front() == '[') {
+            set = -1;
+            for (int i = 0; i < static_cast<int>(FormationSet::Count); ++i) {
+                if (first == std::string("[") + FORMATION_SET_NAMES[i] + "]")
+                    set = i;
+            }
+            if (set < 0) {
+                LOG_ERROR("{}:{}: unknown formation section", path, lineNo);
+                return false;
+            }
+            continue;
+        }
+
+        if (first == "zone") {
+            int unum;
+            Point half;
+            if (!(ls >> unum >> half.x >> half.y) || unum < 1 || unum > FORMATION_PLAYERS) {
+                LOG_ERROR("{}:{}: expected 'zone <unum> <half-x> <half-y>'", path, lineNo);
+                return false;
+            }
+            zoneHalf_[unum - 1] = half;
+            continue;
+        }
+
+        // Muestra: balón y 11 posiciones
+        std::istringstream sample(line);
+        Point ball;
+        std::array<Point, FORMATION_PLAYERS> pos;
+        bool ok = set >= 0 && static_cast<bool>(sample >> ball.x >> ball.y);
+        for (Point &p : pos)
+            ok = ok && static_cast<bool>(sample >> p.x >> p.y);
+        if (!ok) {
+            LOG_ERROR("{}:{}: expected a sample of 24 numbers inside a section", path, lineNo);
+            return false;
+        }
+        balls[set].push_back(ball);
+        homes[set].push_back(pos);
+    }
+
+    if (!build(balls, homes)) {
+        LOG_ERROR("{}: formation needs at least one [play_on] sample", path);
+        return false;
+    }
+    LOG_INFO("Loaded formation {}: {} play_on samples, {} triangles", path,
+             balls[0].size(), tables_[0][0].triangleCount());
+    return true;
+}
+
+FormationSlot Formation::lookup(Side side, FormationSet set, Point ball, int unum) const
+{
+    const auto &table = tables_[side == Side::Right ? 1 : 0][static_cast<std::size_t>(set)];
+    FormationSlot slot;
+    slot.home = table.home(ball, unum);
+
+    Point half = zoneHalf_[std::clamp(unum, 1, FORMATION_PLAYERS) - 1];
+    slot.zone = {std::max(slot.home.x - half.x, -PITCH_HALF_LENGTH), std::min(slot.home.x + half.x, PITCH_HALF_LENGTH),
+                 std::max(slot.home.y - half.y, -PITCH_HALF_WIDTH), std::min(slot.home.y + half.y, PITCH_HALF_WIDTH)};
+    return slot;
+}
+
+static Formation &formationInstance()
+{
+    static Formation formation = Formation::makeDefault();
+    return formation;
+}
+
+const Formation &activeFormation()
+{
+    return formationInstance();
+}
+
+bool loadActiveFormation(const std::string &path)
+{
+    Formation f;
+    if (!f.load(path))
+        return false;
+    formationInstance() = std::move(f);
+    return true;
+}
@@ -0,0 +1,98 @@
+#pragma once
+
+#include "types.h"
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Motor de formación dirigido por la posición del balón.
+//
+// Un fichero de formación da, para cada conjunto de modos de juego, muestras
+// "posición del balón -> 11 posiciones de referencia" en coordenadas propias
+// (atacando hacia x positiva, y hacia la banda superior). Al cargarlo se
+// resuelve la simetría de cada lado, se triangulan las muestras (Delaunay) y
+// se construye una rejilla de localización, de modo que cada consulta por
+// ciclo es O(1) y sin memoria dinámica: celda -> triángulo -> interpolación
+// baricéntrica de las tres muestras.
+//
+// Formato (líneas en blanco y '#' ignorados):
+//   zone <dorsal> <semiancho x> <semialto y>     tamaño de la zona alrededor de la posición
+//   [play_on] | [our_set_play] | [their_set_play]
+//   <balón x> <balón y>  <x1> <y1> ... <x11> <y11>
+
+inline constexpr int FORMATION_PLAYERS = 11;
+
+// Conjunto de modos de juego con formación propia. Los que falten en el
+// fichero usan play_on.
+enum class FormationSet : std::uint8_t
+{
+    PlayOn,
+    OurSetPlay,     // saque de banda, córner, falta, saque de puerta o de centro nuestros (o infracción rival)
+    TheirSetPlay,   // los mismos a favor del rival
+    Count
+};
+
+// Conjunto que corresponde al modo de juego (ya normalizado a nuestro/suyo)
+FormationSet formationSetFor(PlayMode mode);
+
+// Posición de referencia y zona de un jugador para una posición del balón
+struct FormationSlot
+{
+    Point home{};
+    Zona zone{};
+};
+
+// Muestras de un conjunto ya en coordenadas absolutas de un lado, con su
+// triangulación y su rejilla de localización
+class FormationTable
+{
+public:
+    // Triangula las muestras y construye la rejilla. Requiere al menos una muestra.
+    void build(std::vector<Point> balls, std::vector<std::array<Point, FORMATION_PLAYERS>> homes);
+
+    bool empty() const { return balls_.empty(); }
+    std::size_t triangleCount() const { return triangles_.size(); }
+
+    // Posición de referencia del dorsal unum (1-11) para el balón en ball
+    Point home(Point ball, int unum) const;
+
+private:
+    std::vector<Point> balls_;
+    std::vector<std::array<Point, FORMATION_PLAYERS>> homes_;
+    std::vector<std::array<std::uint16_t, 3>> triangles_;
+
+    // Rejilla: cada celda lista los triángulos que la tocan (CSR: cellStart_ indexa cellTriangles_)
+    std::vector<std::uint32_t> cellStart_;
+    std::vector<std::uint16_t> cellTriangles_;
+};
+
+class Formation
+{
+public:
+    // Formación por defecto: zonas fijas por dorsal, sin depender del balón
+    static Formation makeDefault();
+
+    // Carga un fichero de formación; devuelve false (y registra el error) si no es válido
+    bool load(const std::string &path);
+
+    // Posición y zona del dorsal unum para el balón en ball (coordenadas absolutas)
+    FormationSlot lookup(Side side, FormationSet set, Point ball, int unum) const;
+
+private:
+    // Prepara las tablas de ambos lados a partir de las muestras en coordenadas propias
+    bool build(const std::array<std::vector<Point>, static_cast<std::size_t>(FormationSet::Count)> &balls,
+               const std::array<std::vector<std::array<Point, FORMATION_PLAYERS>>,
+                                static_cast<std::size_t>(FormationSet::Count)> &homes);
+
+    // [lado][conjunto]; el lado derecho ya está reflejado
+    std::array<std::array<FormationTable, static_cast<std::size_t>(FormationSet::Count)>, 2> tables_;
+    std::array<Point, FORMATION_PLAYERS> zoneHalf_{};
+};
+
+// Formación compartida por todos los agentes del proceso (inmutable tras el arranque)
+const Formation &activeFormation();
+
+// Sustituye la formación activa por la de un fichero. Llamar antes de arrancar los agentes.
+bool loadActiveFormation(const std::string &path);
@@ -0,0 +1,295 @@
+#include "geometry.h"
+#include <cmath>
+#include <cstdint>
+
+#if defined(__AVX2__) && defined(__FMA__)
+#include <immintrin.h>
+#define GEOMETRY_AVX2 1
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#define GEOMETRY_SSE2 1
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+#include <arm_neon.h>
+#define GEOMETRY_NEON 1
+#endif
+
+static constexpr float DEG_PER_RAD = static_cast<float>(180.0 / M_PI);
+static constexpr float RAD_PER_DEG = static_cast<float>(M_PI / 180.0);
+
+// --- Carriles -------------------------------------------------------------------
+//
+// Cada backend expone el mismo puñado de operaciones (F: floats, I: enteros,
+// M: máscara de comparación) para escribir los kernels una sola vez.
+
+struct ScalarLanes
+{
+    static constexpr std::size_t LANES = 1;
+    using F = float;
+    using I = std::int32_t;
+    using M = bool;
+
+    static F load(const float *p) { return *p; }
+    static void store(float *p, F v) { *p = v; }
+    static F set1(float v) { return v; }
+#if GEOMETRY_AVX2 || GEOMETRY_NEON
+    // Redondeo único, como vfmadd/vfma: la cola da lo mismo que el cuerpo vectorial
+    static F fma(F a, F b, F c) { return std::fma(a, b, c); }
+#else
+    static F fma(F a, F b, F c) { return a * b + c; }
+#endif
+    static F abs(F a) { return std::fabs(a); }
+    static F min(F a, F b) { return a < b ? a : b; }
+    static F max(F a, F b) { return a > b ? a : b; }
+    static F sqrt(F a) { return std::sqrt(a); }
+    static F round(F a) { return std::nearbyint(a); }
+    static I toInt(F a) { return static_cast<I>(std::nearbyint(a)); }
+    static F toFloat(I a) { return static_cast<F>(a); }
+    static M less(F a, F b) { return a < b; }
+    static M bit(I a, std::int32_t b) { return (a & b) != 0; }
+    static F select(M m, F a, F b) { return m ? a : b; }
+    static F copySign(F mag, F sign) { return std::copysign(mag, sign); }
+};
+
+#if GEOMETRY_AVX2
+struct VectorLanes
+{
+    static constexpr std::size_t LANES = 8;
+    static constexpr const char *ISA = "avx2";
+    using F = __m256;
+    using I = __m256i;
+    using M = __m256;
+
+    static F load(const float *p) { return _mm256_loadu_ps(p); }
+    static void store(float *p, F v) { _mm256_storeu_ps(p, v); }
+    static F set1(float v) { return _mm256_set1_ps(v); }
+    static F fma(F a, F b, F c) { return _mm256_fmadd_ps(a, b, c); }
+    static F abs(F a) { return _mm256_andnot_ps(_mm256_set1_ps(-0.0f), a); }
+    static F min(F a, F b) { return _mm256_min_ps(a, b); }
+    static F max(F a, F b) { return _mm256_max_ps(a, b); }
+    static F sqrt(F a) { return _mm256_sqrt_ps(a); }
+    static F round(F a) { return _mm256_round_ps(a, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC); }
+    static I toInt(F a) { return _mm256_cvtps_epi32(a); }
+    static F toFloat(I a) { return _mm256_cvtepi32_ps(a); }
+    static M less(F a, F b) { return _mm256_cmp_ps(a, b, _CMP_LT_OQ); }
+    static M bit(I a, std::int32_t b)
+    {
+        __m256i m = _mm256_set1_epi32(b);
+        return _mm256_castsi256_ps(_mm256_cmpeq_epi32(_mm256_and_si256(a, m), m));
+    }
+    static F select(M m, F a, F b) { return _mm256_blendv_ps(b, a, m); }
+    static F copySign(F mag, F sign)
+    {
+        __m256 s = _mm256_set1_ps(-0.0f);
+        return _mm256_or_ps(_mm256_andnot_ps(s, mag), _mm256_and_ps(s, sign));
+    }
+};
+#elif GEOMETRY_SSE2
+struct VectorLanes
+{
+    static constexpr std::size_t LANES = 4;
+    static constexpr const char *ISA = "sse2";
+    using F = __m128;
+    using I = __m128i;
+    using M = __m128;
+
+    static F load(const float *p) { return _mm_loadu_ps(p); }
+    static void store(float *p, F v) { _mm_storeu_ps(p, v); }
+    static F set1(float v) { return _mm_set1_ps(v); }
+    static F fma(F a, F b, F c) { return _mm_add_ps(_mm_mul_ps(a, b), c); }
+    static F abs(F a) { return _mm_andnot_ps(_mm_set1_ps(-0.0f), a); }
+    static F min(F a, F b) { return _mm_min_ps(a, b); }
+    static F max(F a, F b) { return _mm_max_ps(a, b); }
+    static F sqrt(F a) { return _mm_sqrt_ps(a); }
+    // Sin roundps (SSE4.1): ida y vuelta por enteros, válido para |a| < 2^31
+    static F round(F a) { return _mm_cvtepi32_ps(_mm_cvtps_epi32(a)); }
+    static I toInt(F a) { return _mm_cvtps_epi32(a); }
+    static F toFloat(I a) { return _mm_cvtepi32_ps(a); }
+    static M less(F a, F b) { return _mm_cmplt_ps(a, b); }
+    static M bit(I a, std::int32_t b)
+    {
+        __m128i m = _mm_set1_epi32(b);
+        return _mm_castsi128_ps(_mm_cmpeq_epi32(_mm_and_si128(a, m), m));
+    }
+    static F select(M m, F a, F b) { return _mm_or_ps(_mm_and_ps(m, a), _mm_andnot_ps(m, b)); }
+    static F copySign(F mag, F sign)
+    {
+        __m128 s = _mm_set1_ps(-0.0f);
+        return _mm_or_ps(_mm_andnot_ps(s, mag), _mm_and_ps(s, sign));
+    }
+};
+#elif GEOMETRY_NEON
+struct VectorLanes
+{
+    static constexpr std::size_t LANES = 4;
+    static constexpr const char *ISA = "neon";
+    using F = float32x4_t;
+    using I = int32x4_t;
+    using M = uint32x4_t;
+
+    static F load(const float *p) { return vld1q_f32(p); }
+    static void store(float *p, F v) { vst1q_f32(p, v); }
+    static F set1(float v) { return vdupq_n_f32(v); }
+    static F fma(F a, F b, F c) { return vfmaq_f32(c, a, b); }
+    static F abs(F a) { return vabsq_f32(a); }
+    static F min(F a, F b) { return vminq_f32(a, b); }
+    static F max(F a, F b) { return vmaxq_f32(a, b); }
+    static F sqrt(F a) { return vsqrtq_f32(a); }
+    static F round(F a) { return vrndnq_f32(a); }
+    static I toInt(F a) { return vcvtnq_s32_f32(a); }
+    static F toFloat(I a) { return vcvtq_f32_s32(a); }
+    static M less(F a, F b) { return vcltq_f32(a, b); }
+    static M bit(I a, std::int32_t b) { return vtstq_s32(a, vdupq_n_s32(b)); }
+    static F select(M m, F a, F b) { return vbslq_f32(m, a, b); }
+    static F copySign(F mag, F sign) { return vbslq_f32(vdupq_n_u32(0x80000000u), sign, mag); }
+};
+#else
+struct VectorLanes : ScalarLanes
+{
+    static constexpr const char *ISA = "scalar";
+};
+#endif
+
+// --- Kernels -------------------------------------------------------------------
+
+// [-180, 180]: a - 360 * round(a / 360), sin bucles. Los empates (±180) se quedan como están.
+template <class V>
+static typename V::F normalizeDeg(typename V::F a)
+{
+    return a - V::set1(360.0f) * V::round(a / V::set1(360.0f));
+}
+
+// atan2 en grados. Polinomio minimax de atan en [0, 1] (error < 1.1e-4°) y
+// reconstrucción del octante con selecciones en vez de ramas.
+template <class V>
+static typename V::F atan2Deg(typename V::F y, typename V::F x)
+{
+    using F = typename V::F;
+    F ax = V::abs(x), ay = V::abs(y);
+    F hi = V::max(ax, ay);
+    F lo = V::min(ax, ay);
+    F a = lo / V::max(hi, V::set1(1e-30f));   // (0, 0) -> 0, como atan2
+    F s = a * a;
+
+    F p = V::set1(-0.01172120f);
+    p = V::fma(p, s, V::set1(0.05265332f));
+    p = V::fma(p, s, V::set1(-0.11643287f));
+    p = V::fma(p, s, V::set1(0.19354346f));
+    p = V::fma(p, s, V::set1(-0.33262347f));
+    p = V::fma(p, s, V::set1(0.99997726f));
+    F r = p * a * V::set1(DEG_PER_RAD);
+
+    r = V::select(V::less(ax, ay), V::set1(90.0f) - r, r);
+    r = V::select(V::less(x, V::set1(0.0f)), V::set1(180.0f) - r, r);
+    return V::copySign(r, y);
+}
+
+// Seno y coseno de un ángulo en grados. La reducción al cuadrante se hace en
+// grados (90·k es exacto en float) y los polinomios cubren [-45°, 45°].
+template <class V>
+static void sinCosDeg(typename V::F deg, typename V::F &sOut, typename V::F &cOut)
+{
+    using F = typename V::F;
+    F k = V::round(deg / V::set1(90.0f));
+    typename V::I q = V::toInt(k);
+    F r = (deg - k * V::set1(90.0f)) * V::set1(RAD_PER_DEG);
+    F z = r * r;
+
+    F sp = V::fma(V::fma(V::set1(-1.9515295891e-4f), z, V::set1(8.3321608736e-3f)), z, V::set1(-1.6666654611e-1f));
+    F sr = V::fma(r * z, sp, r);
+    F cp = V::fma(V::fma(V::set1(2.443315711809948e-5f), z, V::set1(-1.388731625493765e-3f)), z,
+                  V::set1(4.166664568298827e-2f));
+    F cr = V::fma(z * z, cp, V::set1(1.0f) - V::set1(0.5f) * z);
+
+    // Cuadrante q: (s, c) = (sr, cr), (cr, -sr), (-sr, -cr), (-cr, sr)
+    typename V::M odd = V::bit(q, 1);
+    F s = V::select(odd, cr, sr);
+    F c = V::select(odd, sr, cr);
+    sOut = V::select(V::bit(q, 2), V::set1(0.0f) - s, s);
+    c = V::select(V::bit(q, 2), V::set1(0.0f) - c, c);
+    cOut = V::select(odd, V::set1(0.0f) - c, c);
+}
+
+// Cada kernel recorre los vectores completos con V y devuelve dónde empieza la cola
+template <class V>
+static std::size_t normalizeRange(float *deg, std::size_t i, std::size_t n)
+{
+    for (; i + V::LANES <= n; i += V::LANES)
+        V::store(deg + i, normalizeDeg<V>(V::load(deg + i)));
+    return i;
+}
+
+template <class V>
+static std::size_t polarRange(Point origin, float heading, const float *x, const float *y, float *dist, float *dir,
+                              std::size_t i, std::size_t n)
+{
+    const typename V::F ox = V::set1(static_cast<float>(origin.x));
+    const typename V::F oy = V::set1(static_cast<float>(origin.y));
+    const typename V::F h = V::set1(heading);
+    for (; i + V::LANES <= n; i += V::LANES) {
+        typename V::F dx = V::load(x + i) - ox;
+        typename V::F dy = V::load(y + i) - oy;
+        V::store(dist + i, V::sqrt(V::fma(dx, dx, dy * dy)));
+        V::store(dir + i, normalizeDeg<V>(atan2Deg<V>(dy, dx) - h));
+    }
+    return i;
+}
+
+template <class V>
+static std::size_t cartesianRange(Point origin, float heading, const float *dist, const float *dir, float *x, float *y,
+                                  std::size_t i, std::size_t n)
+{
+    const typename V::F ox = V::set1(static_cast<float>(origin.x));
+    const typename V::F oy = V::set1(static_cast<float>(origin.y));
+    const typename V::F h = V::set1(heading);
+    for (; i + V::LANES <= n; i += V::LANES) {
+        typename V::F s, c;
+        sinCosDeg<V>(V::load(dir + i) + h, s, c);
+        typename V::F d = V::load(dist + i);
+        V::store(x + i, V::fma(d, c, ox));
+        V::store(y + i, V::fma(d, s, oy));
+    }
+    return i;
+}
+
+// --- Interfaz ------------------------------------------------------------------
+
+const char *geometryIsa()
+{
+    return VectorLanes::ISA;
+}
+
+std::size_t geometryLanes()
+{
+    return VectorLanes::LANES;
+}
+
+float fastAtan2Deg(float y, float x)
+{
+    return atan2Deg<ScalarLanes>(y, x);
+}
+
+void fastSinCosDeg(float deg, float &s, float &c)
+{
+    sinCosDeg<ScalarLanes>(deg, s, c);
+}
+
+void normalizeAngles(std::span<float> deg)
+{
+    std::size_t i = normalizeRange<VectorLanes>(deg.data(), 0, deg.size());
+    normalizeRange<ScalarLanes>(deg.data(), i, deg.size());
+}
+
+void toPolar(Point origin, float heading, std::span<const float> x, std::span<const float> y,
+             std::span<float> dist, std::span<float> dir)
+{
+    std::size_t i = polarRange<VectorLanes>(origin, heading, x.data(), y.data(), dist.data(), dir.data(), 0, x.size());
+    polarRange<ScalarLanes>(origin, heading, x.data(), y.data(), dist.data(), dir.data(), i, x.size());
+}
+
+void toCartesian(Point origin, float heading, std::span<const float> dist, std::span<const float> dir,
+                 std::span<float> x, std::span<float> y)
+{
+    std::size_t i = cartesianRange<VectorLanes>(origin, heading, dist.data(), dir.data(), x.data(), y.data(), 0,
+                                                dist.size());
+    cartesianRange<ScalarLanes>(origin, heading, dist.data(), dir.data(), x.data(), y.data(), i, dist.size());
+}
@@ -0,0 +1,46 @@
+#pragma once
+
+#include "types.h"
+#include <cstddef>
+#include <span>
+
+// Kernels geométricos por lotes: distancia y ángulo relativo a muchos
+// objetivos, conversión polar <-> cartesiana y normalización de ángulos.
+//
+// Trabajan sobre columnas float (estructura de arrays) con el ancho de
+// vector disponible al compilar: AVX2 (8 carriles, con -DPLAYER_NATIVE=ON en
+// una CPU que lo tenga), SSE2 o NEON (4 carriles) y escalar en el resto. La
+// cola que no llena un vector pasa por el mismo código en versión escalar, con
+// std::fma donde el vector fusiona (AVX2, NEON) y geometry.cpp compilado con
+// -ffp-contract=off, así que el resultado de cada objetivo no depende de su
+// posición en el lote.
+//
+// Ángulos en grados y convenio matemático (antihorario), como anguloHacia;
+// el convenio horario del servidor se obtiene cambiando el signo.
+
+// Error máximo de las aproximaciones frente a atan2/sin/cos de libm (lo
+// comprueba player_bench). Muy por debajo de la cuantización del servidor (1°).
+inline constexpr double FAST_ATAN2_MAX_ERROR_DEG = 2e-4;
+inline constexpr double FAST_SINCOS_MAX_ERROR = 1e-6;
+
+// Nombre del juego de instrucciones elegido ("avx2", "sse2", "neon" o "scalar")
+const char *geometryIsa();
+
+// Carriles por vector del juego de instrucciones elegido
+std::size_t geometryLanes();
+
+// Versiones escalares de las aproximaciones (mismo polinomio que los lotes)
+float fastAtan2Deg(float y, float x);
+void fastSinCosDeg(float deg, float &s, float &c);
+
+// Lleva cada ángulo a [-180, 180] sin ramas
+void normalizeAngles(std::span<float> deg);
+
+// Distancia y ángulo relativo a heading (normalizado) desde origin hasta cada
+// objetivo (x[i], y[i]). Todas las columnas deben tener el tamaño de x.
+void toPolar(Point origin, float heading, std::span<const float> x, std::span<const float> y,
+             std::span<float> dist, std::span<float> dir);
+
+// Posición absoluta de cada objeto visto a dist[i] y dir[i] relativo a heading desde origin
+void toCartesian(Point origin, float heading, std::span<const float> dist, std::span<const float> dir,
+                 std::span<float> x, std::span<float> y);
@@ -0,0 +1,282 @@
+#include "intercept.h"
+#include "geometry.h"
+#include "positions.h"
+#include "log.h"
+#include "comm.h"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+static constexpr double DEG = M_PI / 180.0;
+
+// Ciclos que cubre la simulación de cada casilla de la tabla
+static constexpr int REACH_SIM_CYCLES = 120;
+
+// Un jugador oído a menos de esta distancia de uno visto se toma por el mismo
+static constexpr double HEARD_MERGE_DIST = 3.0;
+
+// --- Tabla de alcance ------------------------------------------------------------
+
+void ReachTable::build(const ServerParams &server, const PlayerTypeParams &type)
+{
+    speedMax_ = type.playerSpeedMax;
+    kickable_ = type.playerSize + type.kickableMargin + server.ballSize;
+    const double accel = server.maxPower * type.dashPowerRate * type.effortMax;
+
+    // Trayectoria partiendo del origen, mirando a +x a velocidad v0: si turn,
+    // primero los giros hasta mirar a θ (la inercia reduce cada giro con la
+    // velocidad) y después carrera a máxima potencia
+    std::array<Point, REACH_SIM_CYCLES + 1> path;
+    auto simulate = [&](double v0, double theta, bool turn) {
+        Point pos{}, vel{v0, 0.0};
+        double heading = 0.0, remaining = turn ? theta : 0.0;
+        path[0] = pos;
+        for (int t = 1; t <= REACH_SIM_CYCLES; ++t) {
+            double speed = std::hypot(vel.x, vel.y);
+            if (remaining > 1e-9) {
+                double step = std::min(remaining, server.maxMoment / (1.0 + type.inertiaMoment * speed));
+                heading += step;
+                remaining -= step;
+            } else {
+                vel.x += accel * std::cos(heading * DEG);
+                vel.y += accel * std::sin(heading * DEG);
+                speed = std::hypot(vel.x, vel.y);
+                if (speed > speedMax_) {
+                    vel.x *= speedMax_ / speed;
+                    vel.y *= speedMax_ / speed;
+                }
+            }
+            pos.x += vel.x;
+            pos.y += vel.y;
+            vel.x *= type.playerDecay;
+            vel.y *= type.playerDecay;
+            path[t] = pos;
+        }
+    };
+
+    // Primer ciclo de la trayectoria con el objetivo a tiro, desde from: un
+    // punto más lejano en la misma dirección nunca se alcanza antes
+    auto firstHit = [&](Point target, int from) {
+        for (int t = from; t <= REACH_SIM_CYCLES; ++t) {
+            if (std::hypot(path[t].x - target.x, path[t].y - target.y) <= kickable_)
+                return t;
+        }
+        return static_cast<int>(UNREACHABLE);
+    };
+
+    for (int s = 0; s < SPEED_BINS; ++s) {
+        double v0 = speedMax_ * s / (SPEED_BINS - 1);
+        for (int a = 0; a < ANGLE_BINS; ++a) {
+            double theta = a * ANGLE_STEP;
+            std::uint8_t *row = &cycles_[(s * ANGLE_BINS + a) * DIST_BINS];
+            for (int k = 0; k < DIST_BINS; ++k)
+                row[k] = UNREACHABLE;
+
+            // Sin girar (el punto queda a tiro de paso) y girando primero hacia él
+            for (bool turn : {false, true}) {
+                simulate(v0, theta, turn);
+                int hit = 0;
+                for (int k = 0; k < DIST_BINS && hit < UNREACHABLE; ++k) {
+                    double d = k * DIST_STEP;
+                    hit = firstHit({d * std::cos(theta * DEG), d * std::sin(theta * DEG)}, hit);
+                    row[k] = static_cast<std::uint8_t>(std::min<int>(row[k], hit));
+                }
+            }
+        }
+    }
+}
+
+// --- Modelo --------------------------------------------------------------------
+
+InterceptModel::InterceptModel(const ServerParams &server, std::span<const PlayerTypeParams> types)
+    : server_(server)
+{
+    for (const PlayerTypeParams &t : types) {
+        if (t.id < 0 || static_cast<std::size_t>(t.id) >= MAX_PLAYER_TYPES)
+            continue;
+        types_[t.id] = t;
+        typeCount_ = std::max(typeCount_, static_cast<std::size_t>(t.id) + 1);
+    }
+    if (typeCount_ == 0)
+        typeCount_ = 1;   // tipo 0 por defecto
+    for (std::size_t i = 0; i < typeCount_; ++i)
+        tables_[i].build(server_, types_[i]);
+
+    double dt = 1.0;
+    for (int t = 0; t <= INTERCEPT_MAX_CYCLES; ++t) {
+        ballTravel_[t] = (1.0 - dt) / (1.0 - server_.ballDecay);
+        dt *= server_.ballDecay;
+    }
+}
+
+bool InterceptModel::matches(const ServerParams &server, std::span<const PlayerTypeParams> types) const
+{
+    if (!(server == server_))
+        return false;
+    for (const PlayerTypeParams &t : types) {
+        if (t.id < 0 || static_cast<std::size_t>(t.id) >= typeCount_ || !(types_[t.id] == t))
+            return false;
+    }
+    return true;
+}
+
+Point InterceptModel::ballAt(Point pos, Point vel, int t) const
+{
+    double f = t <= INTERCEPT_MAX_CYCLES ? ballTravel_[t]
+                                         : (1.0 - std::pow(server_.ballDecay, t)) / (1.0 - server_.ballDecay);
+    return {pos.x + vel.x * f, pos.y + vel.y * f};
+}
+
+const ReachTable &InterceptModel::table(int type) const
+{
+    return tables_[(type >= 0 && static_cast<std::size_t>(type) < typeCount_) ? type : 0];
+}
+
+void InterceptModel::solve(Point ballPos, Point ballVel, std::span<const Interceptor> who,
+                           std::span<InterceptResult> out) const
+{
+    // Sin rebotes el balón nunca supera ball_speed_max
+    double speed = std::hypot(ballVel.x, ballVel.y);
+    if (speed > server_.ballSpeedMax) {
+        ballVel.x *= server_.ballSpeedMax / speed;
+        ballVel.y *= server_.ballSpeedMax / speed;
+    }
+
+    // Trayectoria del balón en columnas para el kernel polar por lotes
+    constexpr std::size_t N = INTERCEPT_MAX_CYCLES + 1;
+    alignas(32) std::array<float, N> bx, by, dist, dir;
+    for (std::size_t t = 0; t < N; ++t) {
+        bx[t] = static_cast<float>(ballPos.x + ballVel.x * ballTravel_[t]);
+        by[t] = static_cast<float>(ballPos.y + ballVel.y * ballTravel_[t]);
+    }
+    double restFactor = 1.0 / (1.0 - server_.ballDecay);
+    Point rest{ballPos.x + ballVel.x * restFactor, ballPos.y + ballVel.y * restFactor};
+
+    for (std::size_t i = 0; i < who.size(); ++i) {
+        const Interceptor &p = who[i];
+        const ReachTable &reach = table(p.type);
+        toPolar(p.pos, p.bodyDir, bx, by, dist, dir);
+
+        // Cota rápida: ni en línea recta a velocidad máxima llega antes de t
+        const float reachBase = static_cast<float>(reach.kickableRadius());
+        const float reachStep = static_cast<float>(reach.speedMax());
+
+        InterceptResult r{-1, rest};
+        for (std::size_t t = 0; t < N; ++t) {
+            if (dist[t] > reachBase + reachStep * static_cast<float>(t))
+                continue;
+            if (reach.cycles(dist[t], p.bodyKnown ? dir[t] : 0.0, p.speed) <= static_cast<int>(t)) {
+                r = {static_cast<int>(t), {bx[t], by[t]}};
+                break;
+            }
+        }
+        if (r.cycle < 0) {
+            // Fuera del horizonte: ir a donde se para el balón
+            double dx = rest.x - p.pos.x, dy = rest.y - p.pos.y;
+            double angle = p.bodyKnown ? normalizaAngulo(std::atan2(dy, dx) / DEG - p.bodyDir) : 0.0;
+            r.cycle = std::max(INTERCEPT_MAX_CYCLES + 1, reach.cycles(std::hypot(dx, dy), angle, p.speed));
+        }
+        out[i] = r;
+    }
+}
+
+// --- Modelo compartido -----------------------------------------------------------
+
+namespace
+{
+std::mutex modelMutex;
+std::vector<std::unique_ptr<const InterceptModel>> models;   // Ninguno se libera: puede haber lectores
+std::atomic<const InterceptModel *> currentModel{nullptr};
+} // namespace
+
+const InterceptModel &interceptModel()
+{
+    if (const InterceptModel *m = currentModel.load(std::memory_order_acquire))
+        return *m;
+
+    std::lock_guard<std::mutex> lock(modelMutex);
+    if (!currentModel.load(std::memory_order_relaxed)) {
+        PlayerTypeParams defaultType;
+        models.push_back(std::make_unique<const InterceptModel>(ServerParams{}, std::span(&defaultType, 1)));
+        currentModel.store(models.back().get(), std::memory_order_release);
+    }
+    return *currentModel.load(std::memory_order_relaxed);
+}
+
+void configureInterceptModel(const ServerParams &server, std::span<const PlayerTypeParams> types)
+{
+    std::lock_guard<std::mutex> lock(modelMutex);
+    const InterceptModel *current = currentModel.load(std::memory_order_relaxed);
+    if (current && current->matches(server, types))
+        return;
+
+    models.push_back(std::make_unique<const InterceptModel>(server, types));
+    currentModel.store(models.back().get(), std::memory_order_release);
+    LOG_INFO("Intercept tables built for {} player types", types.size());
+}
+
+// --- Interceptores ---------------------------------------------------------------
+
+Point seenPlayerPosition(const PlayerInfo &player, std::size_t i)
+{
+    // Las direcciones del see son horarias respecto a la cara
+    const SeenPlayers &seen = player.see.players;
+    double a = (player.dir_abs - player.sense.headAngle - seen.dir[i]) * DEG;
+    return {player.x_abs + seen.dist[i] * std::cos(a), player.y_abs + seen.dist[i] * std::sin(a)};
+}
+
+std::size_t gatherInterceptors(const PlayerInfo &player, std::span<Interceptor> out)
+{
+    if (out.empty())
+        return 0;
+
+    std::size_t n = 0;
+    out[n++] = Interceptor{{player.x_abs, player.y_abs}, player.dir_abs, true,
+                           static_cast<float>(player.sense.speed), player.playerType, TeamSide::Own,
+                           static_cast<std::int8_t>(player.number)};
+
+    const double face = player.dir_abs - player.sense.headAngle;
+    const SeenPlayers &seen = player.see.players;
+    for (std::size_t i = 0; i < seen.size && n < out.size(); ++i) {
+        Interceptor &p = out[n++];
+        p = Interceptor{};
+        p.pos = seenPlayerPosition(player, i);
+        p.bodyKnown = seen.has(i, SEEN_FACING);
+        if (p.bodyKnown)
+            p.bodyDir = static_cast<float>(normalizaAngulo(face - seen.bodyDir[i]));
+        p.team = seen.team[i];
+        p.number = seen.number[i];
+        if (p.team == TeamSide::Own && p.number > 0 && static_cast<std::size_t>(p.number) < player.mateTypes.size())
+            p.type = player.mateTypes[static_cast<std::size_t>(p.number)];
+    }
+    const std::size_t seenEnd = n;
+
+    // Lo oído sólo completa lo visto: se descarta lo que está cerca de alguien ya en la lista
+    auto alreadyListed = [&](Point pos) {
+        for (std::size_t i = 0; i < seenEnd; ++i) {
+            if (std::hypot(out[i].pos.x - pos.x, out[i].pos.y - pos.y) < HEARD_MERGE_DIST)
+                return true;
+        }
+        return false;
+    };
+    const int now = player.sense.time;
+    const HeardInfo &heard = player.heard;
+    for (std::size_t m = 1; m < heard.mates.size() && n < out.size(); ++m) {
+        const HeardMate &mate = heard.mates[m];
+        if (static_cast<int>(m) == player.number || mate.time < 0 || now - mate.time > HEARD_MAX_AGE ||
+            alreadyListed(mate.pos))
+            continue;
+        out[n++] = Interceptor{mate.pos, 0.0f, false, 0.0f, player.mateTypes[m], TeamSide::Own,
+                               static_cast<std::int8_t>(m)};
+    }
+    for (std::size_t i = 0; i < heard.opponentCount && n < out.size(); ++i) {
+        const HeardOpponent &o = heard.opponents[i];
+        if (now - o.time > HEARD_MAX_AGE || alreadyListed(o.pos))
+            continue;
+        out[n++] = Interceptor{o.pos, 0.0f, false, 0.0f, 0, TeamSide::Opp, o.number};
+    }
+    return n;
+}
@@ -0,0 +1,128 @@
+#pragma once
+
+#include "types.h"
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+// Intercepción del balón con la dinámica del servidor.
+//
+// El balón se predice en forma cerrada (p + v (1 - d^t) / (1 - d)) y, para
+// cada jugador, se busca el primer ciclo t en el que puede tener el balón a
+// distancia de control. El coste de llegar se lee de una tabla por tipo de
+// jugador, "ciclos hasta tener a tiro un punto a distancia d y ángulo θ del
+// cuerpo partiendo a velocidad v", que se construye una vez simulando giros
+// (con la inercia) y carreras a máxima potencia con los parámetros de
+// server_param y player_type. Una consulta de todo el equipo son unas pocas
+// lecturas de tabla por jugador y ciclo, sin memoria dinámica.
+
+// Horizonte de la búsqueda; más allá se usa el punto donde se para el balón
+inline constexpr int INTERCEPT_MAX_CYCLES = 60;
+
+// Interceptores por consulta: el propio jugador y todos los vistos
+inline constexpr std::size_t INTERCEPTOR_CAPACITY = SeenPlayers::CAPACITY + 1;
+
+class ReachTable
+{
+public:
+    static constexpr int SPEED_BINS = 4;          // 0 .. velocidad máxima
+    static constexpr int ANGLE_BINS = 19;         // 0° .. 180°
+    static constexpr double ANGLE_STEP = 10.0;
+    static constexpr int DIST_BINS = 121;         // 0 m .. 60 m
+    static constexpr double DIST_STEP = 0.5;
+    static constexpr int UNREACHABLE = 255;
+
+    void build(const ServerParams &server, const PlayerTypeParams &type);
+
+    // Ciclos hasta tener a tiro un punto a dist metros y angle grados del cuerpo
+    // partiendo a speed m/ciclo. Más allá de la tabla se extrapola a velocidad máxima.
+    int cycles(double dist, double angle, double speed) const;
+
+
+    double kickableRadius() const { return kickable_; }
+    double speedMax() const { return speedMax_; }
+
+private:
+    std::array<std::uint8_t, SPEED_BINS * ANGLE_BINS * DIST_BINS> cycles_{};
+    double speedMax_{1.05};
+    double kickable_{1.085};
+};
+
+// En la cabecera: es la consulta del bucle interno de InterceptModel::solve
+inline int ReachTable::cycles(double dist, double angle, double speed) const
+{
+    int s = std::clamp(static_cast<int>(speed / speedMax_ * (SPEED_BINS - 1) + 0.5), 0, SPEED_BINS - 1);
+    int a = std::min(static_cast<int>(std::fabs(angle) / ANGLE_STEP + 0.5), ANGLE_BINS - 1);
+    const std::uint8_t *row = &cycles_[(s * ANGLE_BINS + a) * DIST_BINS];
+
+    // Casilla superior en distancia: nunca se subestima el tiempo
+    double k = std::ceil(dist / DIST_STEP);
+    if (k < DIST_BINS)
+        return row[static_cast<int>(k)];
+
+    double beyond = dist - (DIST_BINS - 1) * DIST_STEP;
+    return row[DIST_BINS - 1] + static_cast<int>(std::ceil(beyond / speedMax_));
+}
+
+// Jugador que puede disputar el balón
+struct Interceptor
+{
+    Point pos{};
+    float bodyDir{0.0f};      // Orientación absoluta del cuerpo (grados antihorarios)
+    bool bodyKnown{false};    // Sin ella se supone que ya mira al balón
+    float speed{0.0f};
+    std::uint8_t type{0};     // player_type
+    TeamSide team{TeamSide::Unknown};
+    std::int8_t number{-1};
+};
+
+struct InterceptResult
+{
+    int cycle{0};             // Primer ciclo en el que tiene el balón a tiro
+    Point point{};            // Dónde estará el balón en ese ciclo
+};
+
+class InterceptModel
+{
+public:
+    InterceptModel(const ServerParams &server, std::span<const PlayerTypeParams> types);
+
+    const ServerParams &server() const { return server_; }
+    bool matches(const ServerParams &server, std::span<const PlayerTypeParams> types) const;
+
+    // Posición del balón dentro de t ciclos (sin ruido ni rebotes)
+    Point ballAt(Point pos, Point vel, int t) const;
+
+    const ReachTable &table(int type) const;
+    const PlayerTypeParams &type(int type) const { return types_[static_cast<std::size_t>(type) < typeCount_ ? type : 0]; }
+
+    // Primer ciclo y punto de intercepción de cada jugador (out.size() >= who.size())
+    void solve(Point ballPos, Point ballVel, std::span<const Interceptor> who, std::span<InterceptResult> out) const;
+
+private:
+    ServerParams server_;
+    std::array<PlayerTypeParams, MAX_PLAYER_TYPES> types_{};
+    std::size_t typeCount_{0};
+    std::array<ReachTable, MAX_PLAYER_TYPES> tables_{};
+    std::array<double, INTERCEPT_MAX_CYCLES + 1> ballTravel_{};   // (1 - d^t) / (1 - d)
+};
+
+// Modelo compartido por los agentes del proceso (el de los parámetros por
+// defecto hasta que se reciben server_param y los player_type)
+const InterceptModel &interceptModel();
+
+// Publica un modelo con estos parámetros si difieren del actual. Cada agente
+// lo llama al recibir el último player_type; sólo el primero construye tablas.
+void configureInterceptModel(const ServerParams &server, std::span<const PlayerTypeParams> types);
+
+// Posición absoluta del jugador i del último see
+Point seenPlayerPosition(const PlayerInfo &player, std::size_t i);
+
+// El propio jugador (índice 0), los jugadores del último see y los que cuentan
+// los compañeros (oídos hace como mucho HEARD_MAX_AGE ciclos y no vistos), en
+// coordenadas absolutas. El propio jugador y los compañeros con dorsal llevan
+// su tipo de change_player_type; los rivales, el tipo 0.
+std::size_t gatherInterceptors(const PlayerInfo &player, std::span<Interceptor> out);
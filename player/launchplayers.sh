@@ -10,6 +10,14 @@ sleep 2
 TEAM1="RealSuciedad"
 TEAM2="RayoCayetano"
 
+# Modo de un solo proceso: todo el equipo (o ambos con BOTH_TEAMS=1) en un único ./player
+if [ "${SINGLE_PROCESS:-0}" = "1" ]; then
+  if [ "${BOTH_TEAMS:-0}" = "1" ]; then
+    exec ./player --team "$TEAM1:7001" --team "$TEAM2:8001" --threads 2
+  fi
+  exec ./player --team "$TEAM1:7001" --threads 2
+fi
+
 # Equipo izquierdo (puertos 7001..7011)
 for PORT in $(seq 7001 7011); do
   echo "Lanzando $TEAM1 en puerto $PORT..."
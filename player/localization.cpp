@@ -0,0 +1,153 @@
+#include "localization.h"
+#include "flags.h"
+#include <cmath>
+
+// Modelo de ruido de las banderas en rcssserver: la distancia se cuantiza en
+// escala logarítmica (quantize_step_l) y después se redondea a 0.1 m; la
+// dirección se redondea a grados enteros. Ambos errores son uniformes.
+static constexpr double QUANTIZE_STEP_L = 0.01;
+static constexpr double DIST_ROUND      = 0.1;
+static constexpr double DIR_ROUND_RAD   = M_PI / 180.0;
+static constexpr double MIN_VARIANCE    = 1e-4;
+
+// Umbral chi² con 2 grados de libertad al 99.9 %
+static constexpr double OUTLIER_CHI2 = 13.8;
+
+// Varianza (m², isótropa) de la posición de una bandera observada a distancia d
+static double flagVariance(double d)
+{
+    double relative = (QUANTIZE_STEP_L * QUANTIZE_STEP_L + DIR_ROUND_RAD * DIR_ROUND_RAD) / 12.0;
+    return MIN_VARIANCE + DIST_ROUND * DIST_ROUND / 12.0 + d * d * relative;
+}
+
+void buildFlagBatch(std::span<const FlagInfo> flags, FlagBatch &batch)
+{
+    // Eliminar duplicados: nos quedamos con la observación más cercana de cada bandera
+    std::array<std::uint8_t, FLAG_COUNT> slot;
+    slot.fill(0xFF);
+    std::array<const FlagInfo *, FlagBatch::CAPACITY> seen;
+    std::size_t n = 0;
+    for (auto &f : flags) {
+        if (f.id >= FLAG_COUNT) continue;
+        if (slot[f.id] == 0xFF) {
+            if (n == FlagBatch::CAPACITY) continue;
+            slot[f.id] = static_cast<std::uint8_t>(n);
+            seen[n++] = &f;
+        } else if (f.dist < seen[slot[f.id]]->dist) {
+            seen[slot[f.id]] = &f;
+        }
+    }
+
+    // La dirección del servidor es horaria; en el marco del cuerpo (antihorario) es -dir
+    for (std::size_t i = 0; i < n; ++i) {
+        const FlagInfo &f = *seen[i];
+        Point p = flagPosition(f.id);
+        double a = f.dir * M_PI / 180.0;
+        batch.fx[i] = p.x;
+        batch.fy[i] = p.y;
+        batch.lx[i] = f.dist * std::cos(a);
+        batch.ly[i] = -f.dist * std::sin(a);
+        batch.w[i] = 1.0 / flagVariance(f.dist);
+    }
+    batch.n = n;
+}
+
+// Registro rígido ponderado: minimiza sum w_i |F_i - (P + R(theta) l_i)|².
+// w lleva los pesos con las banderas descartadas a 0, así los bucles no tienen ramas.
+static bool solvePose(const FlagBatch &b, const std::array<double, FlagBatch::CAPACITY> &w,
+                      PoseEstimate &est)
+{
+    const std::size_t n = b.n;
+
+    double sw = 0, slx = 0, sly = 0, sfx = 0, sfy = 0;
+    for (std::size_t i = 0; i < n; ++i) {
+        sw  += w[i];
+        slx += w[i] * b.lx[i];
+        sly += w[i] * b.ly[i];
+        sfx += w[i] * b.fx[i];
+        sfy += w[i] * b.fy[i];
+    }
+    if (sw <= 0)
+        return false;
+
+    double mlx = slx / sw, mly = sly / sw;
+    double mfx = sfx / sw, mfy = sfy / sw;
+
+    // Términos cruzados sobre coordenadas centradas
+    double sdot = 0, scross = 0, sspread = 0;
+    for (std::size_t i = 0; i < n; ++i) {
+        double ax = b.lx[i] - mlx, ay = b.ly[i] - mly;
+        double bx = b.fx[i] - mfx, by = b.fy[i] - mfy;
+        sdot    += w[i] * (ax * bx + ay * by);
+        scross  += w[i] * (ax * by - ay * bx);
+        sspread += w[i] * (ax * ax + ay * ay);
+    }
+    if (sspread <= 0)
+        return false;
+
+    double theta = std::atan2(scross, sdot);
+    double c = std::cos(theta), s = std::sin(theta);
+
+    // P = F̄ - R l̄
+    double rlx = c * mlx - s * mly;
+    double rly = s * mlx + c * mly;
+    est.pos = {mfx - rlx, mfy - rly};
+    est.dir = theta * 180.0 / M_PI;
+
+    // Covarianza de primer orden: ruido del centroide más el arrastre del error angular
+    double varTheta = 1.0 / sspread;
+    double varPos = 1.0 / sw;
+    est.covXX = varPos + varTheta * rly * rly;
+    est.covXY = -varTheta * rlx * rly;
+    est.covYY = varPos + varTheta * rlx * rlx;
+    est.varDir = varTheta * (180.0 / M_PI) * (180.0 / M_PI);
+    return true;
+}
+
+PoseEstimate localize(std::span<const FlagInfo> flags)
+{
+    PoseEstimate est;
+    FlagBatch batch;
+    buildFlagBatch(flags, batch);
+    if (batch.n < 2)
+        return est;
+
+    std::array<double, FlagBatch::CAPACITY> w;
+    for (std::size_t i = 0; i < batch.n; ++i)
+        w[i] = batch.w[i];
+
+    std::size_t active = batch.n;
+    while (true) {
+        if (!solvePose(batch, w, est))
+            return PoseEstimate{};
+
+        if (active <= 2)
+            break;
+
+        // Residuo normalizado de cada bandera respecto a la pose estimada
+        double th = est.dir * M_PI / 180.0;
+        double c = std::cos(th), s = std::sin(th);
+        std::size_t worst = 0;
+        double worstChi2 = 0;
+        for (std::size_t i = 0; i < batch.n; ++i) {
+            double ex = batch.fx[i] - (est.pos.x + c * batch.lx[i] - s * batch.ly[i]);
+            double ey = batch.fy[i] - (est.pos.y + s * batch.lx[i] + c * batch.ly[i]);
+            double chi2 = w[i] * (ex * ex + ey * ey);
+            if (chi2 > worstChi2) {
+                worstChi2 = chi2;
+                worst = i;
+            }
+        }
+        if (worstChi2 <= OUTLIER_CHI2)
+            break;
+
+        // Descartar la peor y volver a resolver
+        w[worst] = 0;
+        --active;
+    }
+
+    est.valid = true;
+    est.flagsUsed = active;
+    est.flagsRejected = batch.n - active;
+    return est;
+}
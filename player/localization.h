@@ -0,0 +1,46 @@
+#pragma once
+
+#include "types.h"
+#include <array>
+#include <cstddef>
+#include <span>
+
+// Estimación de pose a partir de todas las banderas visibles de un see
+struct PoseEstimate
+{
+    bool valid{false};    // Hacen falta al menos dos banderas consistentes
+    Point pos{};          // Posición absoluta
+    double dir{0.0};      // Orientación absoluta del cuerpo (grados, mismo convenio que calcularOrientacion)
+
+    // Covarianza de la posición (m²) y varianza de la orientación (grados²)
+    double covXX{0.0};
+    double covXY{0.0};
+    double covYY{0.0};
+    double varDir{0.0};
+
+    std::size_t flagsUsed{0};      // Banderas que entran en la solución final
+    std::size_t flagsRejected{0};  // Descartadas como atípicas
+};
+
+// Lote de banderas en formato estructura de arrays, listo para un recorrido vectorizable.
+// (fx, fy): posición absoluta de la bandera; (lx, ly): la misma bandera vista
+// desde el cuerpo del jugador; w: inversa de la varianza de la observación.
+struct FlagBatch
+{
+    static constexpr std::size_t CAPACITY = SeeInfo::MAX_FLAGS;
+
+    alignas(32) std::array<double, CAPACITY> fx;
+    alignas(32) std::array<double, CAPACITY> fy;
+    alignas(32) std::array<double, CAPACITY> lx;
+    alignas(32) std::array<double, CAPACITY> ly;
+    alignas(32) std::array<double, CAPACITY> w;
+    std::size_t n{0};
+};
+
+// Rellena el lote con las banderas conocidas (sin duplicados, la más cercana gana)
+void buildFlagBatch(std::span<const FlagInfo> flags, FlagBatch &batch);
+
+// Posición y orientación por mínimos cuadrados ponderados sobre todas las
+// banderas a la vez (registro rígido 2D en forma cerrada), con rechazo de
+// atípicos por residuo normalizado.
+PoseEstimate localize(std::span<const FlagInfo> flags);
@@ -0,0 +1,274 @@
+#include "log.h"
+#include <charconv>
+#include <chrono>
+#include <cstdio>
+#include <fcntl.h>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+std::int64_t logNowNs()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// Suma de los descartes de todos los búferes, legible sin el cerrojo del escritor
+static std::atomic<std::uint64_t> droppedTotal{0};
+
+char *LogRing::reserve(std::size_t size)
+{
+    std::uint64_t h = head.load(std::memory_order_relaxed);
+    std::uint64_t t = tail.load(std::memory_order_acquire);
+    std::size_t offset = h & (LOG_RING_SIZE - 1);
+
+    // Si no cabe antes del final, se rellena el hueco y se empieza desde el principio
+    std::size_t padding = (offset + size > LOG_RING_SIZE) ? LOG_RING_SIZE - offset : 0;
+    if (LOG_RING_SIZE - (h - t) < padding + size) {
+        dropped.fetch_add(1, std::memory_order_relaxed);
+        droppedTotal.fetch_add(1, std::memory_order_relaxed);
+        return nullptr;
+    }
+
+    if (padding) {
+        LogRecordHeader pad{};
+        pad.size = static_cast<std::uint32_t>(padding);
+        pad.level = 0;
+        std::memcpy(data + offset, &pad, sizeof(std::uint32_t) + sizeof(std::uint8_t));
+        head.store(h + padding, std::memory_order_release);
+        offset = 0;
+    }
+    return data + offset;
+}
+
+void LogRing::commit(std::size_t size)
+{
+    head.store(head.load(std::memory_order_relaxed) + size, std::memory_order_release);
+}
+
+// Escritor de fondo: recorre los búferes de todos los hilos, formatea y escribe por lotes
+class LogWriter
+{
+public:
+    LogWriter() : thread_([this] { run(); }) {}
+
+    ~LogWriter() { stop(); }
+
+    LogRing &registerRing()
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        rings_.push_back(std::make_unique<LogRing>());
+        return *rings_.back();
+    }
+
+    bool openFile(const char *path)
+    {
+        int fd = ::open(path, O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+        if (fd < 0)
+            return false;
+        std::lock_guard<std::mutex> lock(mutex_);
+        int old = fd_.exchange(fd);
+        if (old > 2)
+            ::close(old);
+        return true;
+    }
+
+    void stop()
+    {
+        if (!running_.exchange(false))
+            return;
+        thread_.join();
+        drainAll();
+        flush();
+    }
+
+private:
+    void run()
+    {
+        while (running_.load(std::memory_order_acquire)) {
+            if (!drainAll())
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            flush();
+        }
+    }
+
+    // Consume todo lo pendiente; devuelve true si había algo
+    bool drainAll()
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        bool any = false;
+        for (auto &ring : rings_) {
+            std::uint64_t t = ring->tail.load(std::memory_order_relaxed);
+            std::uint64_t h = ring->head.load(std::memory_order_acquire);
+            while (t != h) {
+                const char *rec = ring->data + (t & (LOG_RING_SIZE - 1));
+                std::uint32_t size;
+                std::memcpy(&size, rec, sizeof(size));
+                if (static_cast<std::uint8_t>(rec[4]) != 0)
+                    format(rec);
+                t += size;
+                any = true;
+                if (out_.size() > 64 * 1024)
+                    flush();
+            }
+            ring->tail.store(t, std::memory_order_release);
+
+            std::uint64_t d = ring->dropped.load(std::memory_order_relaxed);
+            if (d != ring->reportedDropped) {
+                out_ += "[LOG] ";
+                appendNumber(d - ring->reportedDropped);
+                out_ += " records dropped (ring full)\n";
+                ring->reportedDropped = d;
+            }
+        }
+        return any;
+    }
+
+    template <typename T>
+    void appendNumber(T v)
+    {
+        char buf[32];
+        auto res = std::to_chars(buf, buf + sizeof(buf), v);
+        out_.append(buf, res.ptr);
+    }
+
+    void format(const char *rec)
+    {
+        LogRecordHeader h;
+        std::memcpy(&h, rec, sizeof(h));
+
+        static constexpr const char *LEVELS[] = {"", "D", "I", "W", "E"};
+        out_ += '[';
+        out_ += LEVELS[h.level < 5 ? h.level : 0];
+        out_ += ' ';
+        appendNumber(h.timestampNs / 1'000'000);
+        if (h.context >= 0) {
+            out_ += " #";
+            appendNumber(h.context);
+        }
+        out_ += "] ";
+
+        const char *p = rec + sizeof(h);
+        int remaining = h.nargs;
+        for (const char *f = h.fmt; *f; ++f) {
+            if (f[0] == '{' && f[1] == '}' && remaining > 0) {
+                p = formatArg(p);
+                --remaining;
+                ++f;
+            } else {
+                out_ += *f;
+            }
+        }
+        out_ += '\n';
+    }
+
+    const char *formatArg(const char *p)
+    {
+        auto tag = static_cast<LogArgTag>(*p++);
+        switch (tag) {
+            case LogArgTag::Bool:
+                out_ += (*p++ ? "true" : "false");
+                break;
+            case LogArgTag::Char:
+                out_ += *p++;
+                break;
+            case LogArgTag::Int: {
+                std::int64_t i;
+                std::memcpy(&i, p, 8);
+                p += 8;
+                appendNumber(i);
+                break;
+            }
+            case LogArgTag::UInt: {
+                std::uint64_t u;
+                std::memcpy(&u, p, 8);
+                p += 8;
+                appendNumber(u);
+                break;
+            }
+            case LogArgTag::Double: {
+                double d;
+                std::memcpy(&d, p, 8);
+                p += 8;
+                char buf[32];
+                auto res = std::to_chars(buf, buf + sizeof(buf), d, std::chars_format::general, 6);
+                out_.append(buf, res.ptr);
+                break;
+            }
+            case LogArgTag::String: {
+                std::uint32_t len;
+                std::memcpy(&len, p, 4);
+                p += 4;
+                out_.append(p, len);
+                p += len;
+                break;
+            }
+        }
+        return p;
+    }
+
+    void flush()
+    {
+        if (out_.empty())
+            return;
+        int fd = fd_.load();
+        const char *data = out_.data();
+        std::size_t left = out_.size();
+        while (left > 0) {
+            ssize_t n = ::write(fd, data, left);
+            if (n <= 0)
+                break;
+            data += n;
+            left -= static_cast<std::size_t>(n);
+        }
+        out_.clear();
+    }
+
+    std::mutex mutex_;  // sólo protege el registro de búferes, no el camino del productor
+    std::vector<std::unique_ptr<LogRing>> rings_;
+    std::string out_;
+    std::atomic<int> fd_{STDOUT_FILENO};
+    std::atomic<bool> running_{true};
+    std::thread thread_;
+};
+
+static LogWriter &logWriter()
+{
+    static LogWriter writer;
+    return writer;
+}
+
+LogRing &threadLogRing()
+{
+    thread_local LogRing *ring = &logWriter().registerRing();
+    return *ring;
+}
+
+static thread_local std::int32_t currentContext = -1;
+
+void logSetContext(std::int32_t context)
+{
+    currentContext = context;
+}
+
+std::int32_t logContext()
+{
+    return currentContext;
+}
+
+bool logOpenFile(const char *path)
+{
+    return logWriter().openFile(path);
+}
+
+void logShutdown()
+{
+    logWriter().stop();
+}
+
+std::uint64_t logDroppedCount()
+{
+    return droppedTotal.load(std::memory_order_relaxed);
+}
@@ -0,0 +1,194 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+// Registro asíncrono para el camino caliente.
+//
+// Cada hilo escribe registros binarios (puntero al formato + argumentos
+// crudos) en su propio búfer circular SPSC; un hilo de fondo los formatea y
+// los escribe por lotes. Si el búfer está lleno el registro se descarta y se
+// cuenta: registrar nunca bloquea al agente.
+//
+// Los niveles por debajo de RS_LOG_LEVEL desaparecen en compilación (ni
+// siquiera se evalúan los argumentos). El formato usa "{}" como hueco y debe
+// ser un literal: sólo se guarda su puntero.
+//
+//   LOG_DEBUG("Pos: ({}, {}) | Dir: {}º", x, y, dir);
+
+#define RS_LOG_LEVEL_DEBUG 1
+#define RS_LOG_LEVEL_INFO  2
+#define RS_LOG_LEVEL_WARN  3
+#define RS_LOG_LEVEL_ERROR 4
+#define RS_LOG_LEVEL_OFF   5
+
+#ifndef RS_LOG_LEVEL
+#define RS_LOG_LEVEL RS_LOG_LEVEL_DEBUG
+#endif
+
+enum class LogLevel : std::uint8_t
+{
+    Debug = RS_LOG_LEVEL_DEBUG,
+    Info  = RS_LOG_LEVEL_INFO,
+    Warn  = RS_LOG_LEVEL_WARN,
+    Error = RS_LOG_LEVEL_ERROR
+};
+
+#if RS_LOG_LEVEL <= RS_LOG_LEVEL_DEBUG
+#define LOG_DEBUG(fmt, ...) logRecord(LogLevel::Debug, fmt __VA_OPT__(,) __VA_ARGS__)
+#else
+#define LOG_DEBUG(fmt, ...) ((void)0)
+#endif
+
+#if RS_LOG_LEVEL <= RS_LOG_LEVEL_INFO
+#define LOG_INFO(fmt, ...) logRecord(LogLevel::Info, fmt __VA_OPT__(,) __VA_ARGS__)
+#else
+#define LOG_INFO(fmt, ...) ((void)0)
+#endif
+
+#if RS_LOG_LEVEL <= RS_LOG_LEVEL_WARN
+#define LOG_WARN(fmt, ...) logRecord(LogLevel::Warn, fmt __VA_OPT__(,) __VA_ARGS__)
+#else
+#define LOG_WARN(fmt, ...) ((void)0)
+#endif
+
+#if RS_LOG_LEVEL <= RS_LOG_LEVEL_ERROR
+#define LOG_ERROR(fmt, ...) logRecord(LogLevel::Error, fmt __VA_OPT__(,) __VA_ARGS__)
+#else
+#define LOG_ERROR(fmt, ...) ((void)0)
+#endif
+
+// Tamaño del búfer circular de cada hilo (potencia de 2)
+inline constexpr std::size_t LOG_RING_SIZE = std::size_t{1} << 20;
+
+// Longitud máxima de una cadena copiada en un registro (el resto se trunca)
+inline constexpr std::size_t LOG_MAX_STRING = 4096;
+
+// Cabecera de cada registro dentro del búfer (alineada a 8 bytes)
+struct LogRecordHeader
+{
+    std::uint32_t size;     // Bytes totales del registro, cabecera incluida
+    std::uint8_t level;     // 0 = relleno hasta el final del búfer
+    std::uint8_t nargs;
+    std::uint16_t reserved;
+    std::int32_t context;   // Contexto del hilo (ej: puerto del agente), -1 si no hay
+    std::uint32_t reserved2;
+    std::int64_t timestampNs;
+    const char *fmt;
+};
+
+// Búfer circular de un solo productor (el hilo dueño) y un solo consumidor (el escritor)
+struct LogRing
+{
+    alignas(64) std::atomic<std::uint64_t> head{0};     // escrito por el productor
+    alignas(64) std::atomic<std::uint64_t> tail{0};     // escrito por el consumidor
+    alignas(64) std::atomic<std::uint64_t> dropped{0};  // registros descartados por falta de sitio
+    std::uint64_t reportedDropped{0};                   // sólo lo toca el escritor
+    char data[LOG_RING_SIZE];
+
+    // Reserva bytes contiguos para un registro; nullptr si no hay sitio
+    char *reserve(std::size_t size);
+    void commit(std::size_t size);
+};
+
+// Búfer del hilo actual (se crea y registra en el primer uso)
+LogRing &threadLogRing();
+
+// Contexto que se adjunta a los registros del hilo actual
+void logSetContext(std::int32_t context);
+std::int32_t logContext();
+
+// Destino de la salida (por defecto, stdout). Devuelve false si no se puede abrir.
+bool logOpenFile(const char *path);
+
+// Vacía todos los búferes y detiene el escritor (al terminar el proceso)
+void logShutdown();
+
+// Registros descartados en total desde el inicio (sin cerrojo: se lee en cada ciclo)
+std::uint64_t logDroppedCount();
+
+std::int64_t logNowNs();
+
+// --- Codificación de argumentos ----------------------------------------------
+
+enum class LogArgTag : std::uint8_t { Int = 'i', UInt = 'u', Double = 'd', Bool = 'b', Char = 'c', String = 's' };
+
+template <typename T>
+constexpr std::size_t logArgSize(const T &v)
+{
+    using U = std::decay_t<T>;
+    if constexpr (std::is_same_v<U, bool> || std::is_same_v<U, char>) {
+        return 2;
+    } else if constexpr (std::is_arithmetic_v<U> || std::is_enum_v<U>) {
+        return 1 + 8;
+    } else {
+        std::string_view sv(v);
+        return 1 + 4 + (sv.size() < LOG_MAX_STRING ? sv.size() : LOG_MAX_STRING);
+    }
+}
+
+template <typename T>
+inline void logArgWrite(char *&p, const T &v)
+{
+    using U = std::decay_t<T>;
+    if constexpr (std::is_same_v<U, bool>) {
+        *p++ = static_cast<char>(LogArgTag::Bool);
+        *p++ = v ? 1 : 0;
+    } else if constexpr (std::is_same_v<U, char>) {
+        *p++ = static_cast<char>(LogArgTag::Char);
+        *p++ = v;
+    } else if constexpr (std::is_floating_point_v<U>) {
+        *p++ = static_cast<char>(LogArgTag::Double);
+        double d = v;
+        std::memcpy(p, &d, 8);
+        p += 8;
+    } else if constexpr (std::is_enum_v<U> || std::is_signed_v<U>) {
+        *p++ = static_cast<char>(LogArgTag::Int);
+        std::int64_t i = static_cast<std::int64_t>(v);
+        std::memcpy(p, &i, 8);
+        p += 8;
+    } else if constexpr (std::is_unsigned_v<U>) {
+        *p++ = static_cast<char>(LogArgTag::UInt);
+        std::uint64_t u = v;
+        std::memcpy(p, &u, 8);
+        p += 8;
+    } else {
+        std::string_view sv(v);
+        std::uint32_t len = static_cast<std::uint32_t>(sv.size() < LOG_MAX_STRING ? sv.size() : LOG_MAX_STRING);
+        *p++ = static_cast<char>(LogArgTag::String);
+        std::memcpy(p, &len, 4);
+        p += 4;
+        std::memcpy(p, sv.data(), len);
+        p += len;
+    }
+}
+
+template <typename... Args>
+void logRecord(LogLevel level, const char *fmt, const Args &...args)
+{
+    std::size_t size = sizeof(LogRecordHeader) + (std::size_t{0} + ... + logArgSize(args));
+    size = (size + 7) & ~std::size_t{7};
+
+    LogRing &ring = threadLogRing();
+    char *p = ring.reserve(size);
+    if (!p)
+        return;
+
+    LogRecordHeader h{};
+    h.size = static_cast<std::uint32_t>(size);
+    h.level = static_cast<std::uint8_t>(level);
+    h.nargs = static_cast<std::uint8_t>(sizeof...(Args));
+    h.context = logContext();
+    h.timestampNs = logNowNs();
+    h.fmt = fmt;
+    std::memcpy(p, &h, sizeof(h));
+
+    [[maybe_unused]] char *w = p + sizeof(h);
+    (logArgWrite(w, args), ...);
+    ring.commit(size);
+}
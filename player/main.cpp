@@ -1,147 +1,129 @@
 #include "types.h"
-#include "parsers.h"
-#include "positions.h"
-#include "decisions.h"
-#include "net.h"
-#include <MinimalSocket/udp/UdpSocket.h>
+#include "agent.h"
+#include "runtime.h"
+#include "log.h"
+#include "formation.h"
+#include "args.h"
 #include <iostream>
-#include <thread>
-#include <chrono>
+#include <string>
+#include <string_view>
 
-int main(int argc, char *argv[])
+static void printUsage(const char *prog)
 {
-    // Validar argumentos de línea de comandos
-    if (argc != 3) {
-        std::cout << "Usage: " << argv[0] << " <team-name> <this-port>" << std::endl;
-        return 1;
-    }
+    std::cout << "Usage: " << prog << " <team-name> <this-port> [send-offset-ms]\n"
+              << "       " << prog << " --team <name>[:<first-port>] [--team <name>[:<first-port>]]"
+              << " [--players N] [--threads N] [--offset MS] [--record DIR] [--metrics DIR]"
+              << " [--formation FILE] [--plan-threads N] [--synch] [--server HOST:PORT]" << std::endl;
+}
 
-    std::string team_name = argv[1];
-    MinimalSocket::Port this_socket_port = std::stoi(argv[2]);
+// Modo multiagente: uno o dos equipos completos en un solo proceso
+static int runMultiAgent(int argc, char *argv[])
+{
+    RuntimeOptions options;
+    int players = 11;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string_view arg = argv[i];
+        if (arg == "--synch") {
+            // rcssserver con server::synch_mode=true: el partido avanza al ritmo del agente más lento
+            options.synch = true;
+            continue;
+        }
+        if (i + 1 >= argc) {
+            printUsage(argv[0]);
+            return 1;
+        }
+        std::string value = argv[++i];
+        bool ok = true;
+
+        if (arg == "--team") {
+            // nombre[:puerto]; por defecto 7001 para el primer equipo y 8001 para el segundo
+            TeamSpec team;
+            team.firstPort = options.teams.empty() ? 7001 : 8001;
+            ok = parseNameAndPort(value, team.name, team.firstPort);
+            options.teams.push_back(team);
+        } else if (arg == "--players") {
+            ok = parseArg(value, players, 1, 11);
+        } else if (arg == "--threads") {
+            ok = parseArg(value, options.threads, 1, 256);
+        } else if (arg == "--plan-threads") {
+            ok = parseArg(value, options.planThreads, 0, 256);
+        } else if (arg == "--offset") {
+            std::int64_t ms = 0;
+            if ((ok = parseArg<std::int64_t>(value, ms, 0, 1000)))
+                options.sendOffsetNs = ms * 1'000'000;
+        } else if (arg == "--record") {
+            options.recordDir = value;
+        } else if (arg == "--metrics") {
+            options.metricsDir = value;
+        } else if (arg == "--server") {
+            // host[:puerto]; por defecto 127.0.0.1:6000 (varios servidores en una máquina, ej: player_tournament)
+            std::string host;
+            std::uint16_t port = 6000;
+            ok = parseNameAndPort(value, host, port);
+            options.server = UdpAddress::make(host.c_str(), port);
+        } else if (arg == "--formation") {
+            // Se carga antes de arrancar los agentes: la formación es común a todo el proceso
+            if (!loadActiveFormation(value)) {
+                logShutdown();
+                return 1;
+            }
+        } else {
+            ok = false;
+        }
+        if (!ok) {
+            printUsage(argv[0]);
+            return 1;
+        }
+    }
 
-    std::cout << "Creating a UDP socket on local port " << this_socket_port << std::endl;
+    for (auto &team : options.teams)
+        team.players = players;
 
-    // Crear socket UDP para comunicación con el servidor
-    MinimalSocket::udp::Udp<true> udp_socket(
-        this_socket_port,
-        MinimalSocket::AddressFamily::IP_V4
-    );
+    int rc = runTeamRuntime(options);
+    logShutdown();
+    return rc;
+}
 
-    std::cout << "Socket created" << std::endl;
+int main(int argc, char *argv[])
+{
+    if (argc > 1 && std::string_view(argv[1]).rfind("--", 0) == 0)
+        return runMultiAgent(argc, argv);
 
-    bool success = udp_socket.open();
-    if (!success) {
-        std::cout << "Error opening socket" << std::endl;
+    // Validar argumentos de línea de comandos
+    if (argc != 3 && argc != 4) {
+        printUsage(argv[0]);
         return 1;
     }
 
-    // Dirección del servidor rcssserver (puerto estándar 6000)
-    MinimalSocket::Address server_address{"127.0.0.1", 6000};
-
-    sendInitCommand(udp_socket, server_address, this_socket_port, team_name);
-
-    std::size_t message_max_size = 1000;
-    std::cout << "Waiting for an init message from server..." << std::endl;
-
-    // Recibir respuesta del servidor con la asignación de lado y dorsal
-    auto received_message = udp_socket.receive(message_max_size);
-
-    if (!received_message) {
-        std::cerr << "Error receiving message from server" << std::endl;
+    std::string team_name = argv[1];
+    std::uint16_t this_socket_port = 0;
+
+    // Desfase dentro del ciclo (ms) al que se envía el comando de cuerpo
+    std::int64_t send_offset_ns = DEFAULT_SEND_OFFSET_NS;
+    std::int64_t send_offset_ms = 0;
+    if (!parseArg<std::uint16_t>(argv[2], this_socket_port, 1) ||
+        (argc == 4 && !parseArg<std::int64_t>(argv[3], send_offset_ms, 0, 1000))) {
+        printUsage(argv[0]);
         return 1;
     }
+    if (argc == 4)
+        send_offset_ns = send_offset_ms * 1'000'000;
 
-    std::string received_message_content = received_message->received_message;
-    std::cout << "Received message: " << received_message_content << std::endl;
-
-    // Usar el puerto específico del servidor para las comunicaciones posteriores
-    MinimalSocket::Address other_sender_udp = received_message->sender;
-    MinimalSocket::Address server_udp{"127.0.0.1", other_sender_udp.getPort()};
-
-    // Parsear el mensaje de inicialización y configurar el jugador
-    PlayerInfo player;
-    player.team = team_name;
-
-    GameState game_state;
-
-    parseInitMsg(received_message_content, player, game_state);
-    std::cout << player << std::endl;
-
-    std::this_thread::sleep_for(std::chrono::milliseconds(100));
-
-    sendMoveCommand(udp_socket, server_udp, player);
-
-    // Bucle principal: recibir mensajes del servidor y actuar
-    while(true) {
-        auto msg = receiveMsgFromServer(udp_socket, message_max_size);
-
-        bool shouldAct = false;
-
-        if (msg.rfind("(see", 0) == 0) {
-            std::cout << "Received message: " << msg << std::endl;
-            parseSeeMsg(msg, player);
-            std::cout << "[DEBUG] " << player.see << std::endl;
-            // Obtener las dos mejores banderas para calcular la posición
-            auto [flag1, flag2] = getTwoBestFlags(msg);
-            std::cout << "Flag1: " << flag1.name << " dist=" << flag1.dist
-                << " dir=" << flag1.dir
-                << " pos=(" << flag1.pos.x << "," << flag1.pos.y << ")" << std::endl;
-
-            std::cout << "Flag2: " << flag2.name << " dist=" << flag2.dist
-                << " dir=" << flag2.dir
-                << " pos=(" << flag2.pos.x << "," << flag2.pos.y << ")" << std::endl;
-
-            if (!flag1.name.empty() && !flag2.name.empty()) {
-
-                // Calcular la posición del jugador a partir de las dos banderas
-                std::pair<FlagInfo, FlagInfo> flags = {flag1, flag2};
-                Point last = {player.x_abs, player.y_abs};
-
-                Point pos = calcularPosicionJugador(flags, last);
-
-                // Actualizar la posición del jugador
-                player.x_abs = pos.x;
-                player.y_abs = pos.y;
-
-                // Calcular la orientación (dirección) del jugador usando la bandera más cercana
-                player.dir_abs = calcularOrientacion(pos, flag1); 
-
-                std::cout << "[INFO] Pos: (" << pos.x << ", " << pos.y 
-                          << ") | Dir: " << player.dir_abs << "º" << std::endl;
-
-                // Comprobar si el jugador está dentro de su zona permitida
-                Zona z = definirZonaJugador(player);
-                if (player.x_abs >= z.x_min && player.x_abs <= z.x_max &&
-                    player.y_abs >= z.y_min && player.y_abs <= z.y_max)
-                {
-                    std::cout << "Jugador " << player.number
-                              << " está dentro de su zona permitida.\n";
-                }
-                else
-                {
-                    std::cout << "Jugador " << player.number
-                              << " está fuera de su zona permitida.\n";
-                }
-            }
-            shouldAct = true;  // Actuar después de recibir información visual
-        // } else if (msg.rfind("(sense_body", 0) == 0) {
-        //     parseSenseMsg(msg, player);
-        //     std::cout << "[DEBUG] " << player.sense << std::endl;
-        } else if (msg.rfind("(hear", 0) == 0) {
-            std::cout << "Received message: " << msg << std::endl;
-            parseHearMsg(msg, player, game_state);
-            std::cout << "[DEBUG] " << game_state << std::endl;
-        }
-
-        if (shouldAct) {
-            std::string action_cmd = decideAction(player, game_state);
-            if (!action_cmd.empty()) {
-                sendActionCommand(udp_socket, server_udp, action_cmd);
-            }
-        }
+    // Dirección del servidor rcssserver (puerto estándar 6000)
+    UdpAddress server_address = UdpAddress::make("127.0.0.1", 6000);
 
-        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    // Los puertos 7001 y 8001 se presentan como porteros
+    Agent agent;
+    agent.goalie = this_socket_port == 7001 || this_socket_port == 8001;
+    if (!startAgent(agent, team_name, this_socket_port, server_address, send_offset_ns)) {
+        logShutdown();
+        return 1;
     }
 
-    return 0;
+    // Bucle principal: eventos del socket y del ciclo del servidor
+    Agent *agents[] = {&agent};
+    int rc = runAgentLoop(agents);
+    logShutdown();
+    return rc;
 }
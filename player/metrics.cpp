@@ -0,0 +1,272 @@
+#include "metrics.h"
+#include "log.h"
+#include <algorithm>
+#include <cerrno>
+#include <charconv>
+#include <cstring>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+void HistogramSnapshot::merge(const HistogramSnapshot &other)
+{
+    for (std::size_t i = 0; i < counts.size(); ++i)
+        counts[i] += other.counts[i];
+    total += other.total;
+}
+
+std::uint64_t HistogramSnapshot::percentile(double q) const
+{
+    if (total == 0)
+        return 0;
+    auto rank = static_cast<std::uint64_t>(q * static_cast<double>(total - 1)) + 1;
+    std::uint64_t seen = 0;
+    for (std::size_t i = 0; i < counts.size(); ++i) {
+        seen += counts[i];
+        if (seen >= rank)
+            return hdr::bucketValue(i);
+    }
+    return max();
+}
+
+std::uint64_t HistogramSnapshot::max() const
+{
+    for (std::size_t i = counts.size(); i-- > 0;) {
+        if (counts[i] != 0)
+            return hdr::bucketValue(i);
+    }
+    return 0;
+}
+
+void LatencyHistogram::snapshot(HistogramSnapshot &out) const
+{
+    out.total = 0;
+    for (std::size_t i = 0; i < counts_.size(); ++i) {
+        out.counts[i] = counts_[i].load(std::memory_order_relaxed);
+        out.total += out.counts[i];
+    }
+}
+
+void AgentMetrics::publish(const CycleStats &cycle, const ReceiveStats &receive)
+{
+    set(MetricCounter::Datagrams, receive.datagrams);
+    set(MetricCounter::Dropped, receive.totalDropped());
+    set(MetricCounter::Cycles, cycle.cycles);
+    set(MetricCounter::Sent, cycle.commandsSent);
+    set(MetricCounter::NoCommand, cycle.cyclesWithoutCommand);
+    set(MetricCounter::Duplicates, cycle.duplicateCommands);
+}
+
+// --- Formato de texto ---------------------------------------------------------
+
+static void appendNumber(std::string &out, std::uint64_t v)
+{
+    char buf[24];
+    auto [ptr, ec] = std::to_chars(buf, buf + sizeof(buf), v);
+    out.append(buf, ptr);
+}
+
+static void appendIdentity(std::string &out, std::string_view kind, const AgentMetrics &m)
+{
+    out += kind;
+    out += ' ';
+    out += m.team;
+    out += ' ';
+    appendNumber(out, m.port);
+}
+
+void writeMetrics(const AgentMetrics &m, std::string &out)
+{
+    appendIdentity(out, "agent", m);
+    for (std::size_t i = 0; i < m.counters.size(); ++i) {
+        out += ' ';
+        out += METRIC_COUNTER_NAMES[i];
+        out += '=';
+        appendNumber(out, m.counters[i].load(std::memory_order_relaxed));
+    }
+    out += '\n';
+
+    HistogramSnapshot snap;
+    for (std::size_t s = 0; s < m.stages.size(); ++s) {
+        m.stages[s].snapshot(snap);
+        appendIdentity(out, "hist", m);
+        out += ' ';
+        out += METRIC_STAGE_NAMES[s];
+        for (std::size_t i = 0; i < snap.counts.size(); ++i) {
+            if (snap.counts[i] == 0)
+                continue;
+            out += ' ';
+            appendNumber(out, i);
+            out += ':';
+            appendNumber(out, snap.counts[i]);
+        }
+        out += '\n';
+    }
+}
+
+// Separa la siguiente palabra de line (delimitada por espacios)
+static std::string_view nextWord(std::string_view &line)
+{
+    while (!line.empty() && line.front() == ' ')
+        line.remove_prefix(1);
+    std::size_t end = line.find(' ');
+    std::string_view word = line.substr(0, end);
+    line.remove_prefix(end == std::string_view::npos ? line.size() : end);
+    return word;
+}
+
+template <typename T>
+static bool toNumber(std::string_view s, T &out)
+{
+    auto [ptr, ec] = std::from_chars(s.data(), s.data() + s.size(), out);
+    return ec == std::errc{} && ptr == s.data() + s.size();
+}
+
+template <typename Names>
+static int indexOf(const Names &names, std::string_view name)
+{
+    auto it = std::find(names.begin(), names.end(), name);
+    return it == names.end() ? -1 : static_cast<int>(it - names.begin());
+}
+
+void parseMetrics(std::string_view text, std::vector<MetricsReport> &out)
+{
+    while (!text.empty()) {
+        std::size_t nl = text.find('\n');
+        std::string_view line = text.substr(0, nl);
+        text.remove_prefix(nl == std::string_view::npos ? text.size() : nl + 1);
+
+        std::string_view kind = nextWord(line);
+        std::string_view team = nextWord(line);
+        std::uint16_t port = 0;
+        if (!toNumber(nextWord(line), port))
+            continue;
+
+        if (kind == "agent") {
+            MetricsReport &r = out.emplace_back();
+            r.team = std::string(team);
+            r.port = port;
+            for (std::string_view w = nextWord(line); !w.empty(); w = nextWord(line)) {
+                std::size_t eq = w.find('=');
+                int idx = indexOf(METRIC_COUNTER_NAMES, w.substr(0, eq));
+                if (idx >= 0 && eq != std::string_view::npos)
+                    toNumber(w.substr(eq + 1), r.counters[static_cast<std::size_t>(idx)]);
+            }
+        } else if (kind == "hist" && !out.empty() && out.back().team == team && out.back().port == port) {
+            int stage = indexOf(METRIC_STAGE_NAMES, nextWord(line));
+            if (stage < 0)
+                continue;
+            HistogramSnapshot &h = out.back().stages[static_cast<std::size_t>(stage)];
+            for (std::string_view w = nextWord(line); !w.empty(); w = nextWord(line)) {
+                std::size_t colon = w.find(':');
+                std::size_t bucket = 0;
+                std::uint64_t count = 0;
+                if (colon == std::string_view::npos || !toNumber(w.substr(0, colon), bucket) ||
+                    !toNumber(w.substr(colon + 1), count) || bucket >= h.counts.size())
+                    continue;
+                h.counts[bucket] += count;
+                h.total += count;
+            }
+        }
+    }
+}
+
+// --- Servidor -----------------------------------------------------------------
+
+bool queryMetrics(const std::string &path, std::string &out)
+{
+    sockaddr_un addr{};
+    addr.sun_family = AF_UNIX;
+    if (path.size() >= sizeof(addr.sun_path))
+        return false;
+    std::memcpy(addr.sun_path, path.c_str(), path.size() + 1);
+
+    int fd = ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd < 0)
+        return false;
+    if (::connect(fd, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)) < 0) {
+        ::close(fd);
+        return false;
+    }
+
+    char buf[16384];
+    ssize_t n;
+    while ((n = ::read(fd, buf, sizeof(buf))) > 0)
+        out.append(buf, static_cast<std::size_t>(n));
+    ::close(fd);
+    return true;
+}
+
+MetricsServer::~MetricsServer()
+{
+    stop();
+}
+
+bool MetricsServer::start(const std::string &dir, std::vector<const AgentMetrics *> agents)
+{
+    stop();
+    path_ = dir + "/player_" + std::to_string(getpid()) + ".sock";
+
+    sockaddr_un addr{};
+    addr.sun_family = AF_UNIX;
+    if (path_.size() >= sizeof(addr.sun_path)) {
+        LOG_ERROR("Metrics socket path too long: {}", path_);
+        return false;
+    }
+    std::memcpy(addr.sun_path, path_.c_str(), path_.size() + 1);
+
+    fd_ = ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd_ < 0)
+        return false;
+    ::unlink(path_.c_str());
+    if (::bind(fd_, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)) < 0 || ::listen(fd_, 8) < 0) {
+        LOG_ERROR("Cannot listen on metrics socket {}", path_);
+        ::close(fd_);
+        fd_ = -1;
+        return false;
+    }
+
+    agents_ = std::move(agents);
+    thread_ = std::thread([this] { serve(); });
+    LOG_INFO("Serving metrics of {} agents on {}", agents_.size(), path_);
+    return true;
+}
+
+void MetricsServer::stop()
+{
+    if (fd_ < 0)
+        return;
+    // Desbloquea el accept del hilo
+    ::shutdown(fd_, SHUT_RDWR);
+    if (thread_.joinable())
+        thread_.join();
+    ::close(fd_);
+    ::unlink(path_.c_str());
+    fd_ = -1;
+}
+
+void MetricsServer::serve()
+{
+    std::string out;
+    while (true) {
+        int client = ::accept4(fd_, nullptr, nullptr, SOCK_CLOEXEC);
+        if (client < 0) {
+            if (errno == EINTR || errno == ECONNABORTED)
+                continue;
+            break;
+        }
+
+        out.clear();
+        for (const AgentMetrics *m : agents_)
+            writeMetrics(*m, out);
+
+        std::size_t sent = 0;
+        while (sent < out.size()) {
+            ssize_t n = ::send(client, out.data() + sent, out.size() - sent, MSG_NOSIGNAL);
+            if (n <= 0)
+                break;
+            sent += static_cast<std::size_t>(n);
+        }
+        ::close(client);
+    }
+}
@@ -0,0 +1,197 @@
+#pragma once
+
+#include "cycle.h"
+#include "net.h"
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+// Métricas de latencia por ciclo de cada agente.
+//
+// El hilo del agente es el único que escribe (contadores atómicos relajados,
+// sin bloqueos ni reservas); el servidor de métricas los lee desde otro hilo
+// y los sirve por un socket Unix a player_metrics.
+
+// Etapas medidas, en ns
+enum class MetricStage : std::uint8_t
+{
+    Parse,          // parseo de see, sense_body o hear
+    Localize,       // localize() sobre las banderas del see
+    Decide,         // decisión del ciclo
+    Send,           // serializar y enviar el datagrama de comandos
+    Handle,         // de la recepción al fin del procesado de cada datagrama
+    ReceiveToSend,  // de la recepción de la estimación usada a la salida del comando
+    CycleToSend,    // del sense_body del ciclo a la salida del comando
+    Plan,           // búsqueda de cadenas de acciones con balón
+    Think,          // modo síncrono: del lote con (think) al envío de (done)
+    Count
+};
+
+inline constexpr std::array<std::string_view, static_cast<std::size_t>(MetricStage::Count)> METRIC_STAGE_NAMES = {
+    "parse", "localize", "decide", "send", "handle", "recv_to_send", "cycle_to_send", "plan", "think"
+};
+
+enum class MetricCounter : std::uint8_t
+{
+    Datagrams,      // datagramas recibidos
+    Dropped,        // datagramas obsoletos descartados sin procesar
+    Cycles,         // ciclos observados (sense_body)
+    Sent,           // comandos de cuerpo enviados
+    NoCommand,      // ciclos cerrados sin comando
+    EmptyDecisions, // vencimientos del ciclo sin estimación nueva que decidir
+    Duplicates,     // intentos de un segundo comando en el mismo ciclo
+    MissedCycles,   // saltos en el tiempo del servidor entre sense_body consecutivos
+    StaleSees,      // see con tiempo anterior al último conocido (sense_body o hear)
+    PlanSearches,   // búsquedas del planificador usadas en una decisión
+    PlanNodes,      // acciones simuladas por el planificador
+    PlanNs,         // tiempo total de búsqueda (nodos/s = plan_nodes / plan_ns)
+    PlanDepth,      // suma de la profundidad alcanzada en cada búsqueda
+    GoalsFor,       // goles propios anunciados por el árbitro
+    GoalsAgainst,   // goles del rival anunciados por el árbitro
+    Sees,           // see recibidos
+    BallAgeSum,     // suma de la antigüedad (ciclos) del balón usado en cada decisión
+    BallKnown,      // decisiones con el balón estimado (media = ball_age / ball_known)
+    BallUnknown,    // decisiones sin estimación del balón
+    Count
+};
+
+inline constexpr std::array<std::string_view, static_cast<std::size_t>(MetricCounter::Count)> METRIC_COUNTER_NAMES = {
+    "datagrams", "dropped", "cycles", "sent", "no_command", "empty_decisions", "duplicates",
+    "missed_cycles", "stale_sees", "plan_searches", "plan_nodes", "plan_ns", "plan_depth",
+    "goals_for", "goals_against", "sees", "ball_age", "ball_known", "ball_unknown"
+};
+
+// Cubos log-lineales al estilo HDR: exactos por debajo de 128 ns y, por
+// encima, 64 subcubos por potencia de dos (error relativo < 1.6 %).
+namespace hdr
+{
+inline constexpr unsigned SUB_BITS = 6;
+inline constexpr std::size_t SUB_COUNT = std::size_t{1} << SUB_BITS;
+inline constexpr unsigned MAX_BITS = 40;        // hasta ~18 minutos
+inline constexpr std::size_t BUCKET_COUNT = (MAX_BITS - SUB_BITS + 1) * SUB_COUNT;
+
+constexpr std::size_t bucketIndex(std::uint64_t v)
+{
+    if (v >= (std::uint64_t{1} << MAX_BITS))
+        v = (std::uint64_t{1} << MAX_BITS) - 1;
+    if (v < 2 * SUB_COUNT)
+        return static_cast<std::size_t>(v);
+    unsigned e = static_cast<unsigned>(63 - __builtin_clzll(v)) - SUB_BITS;
+    return (e + 1) * SUB_COUNT + static_cast<std::size_t>((v >> e) - SUB_COUNT);
+}
+
+// Valor representativo del cubo (su punto medio)
+constexpr std::uint64_t bucketValue(std::size_t i)
+{
+    if (i < 2 * SUB_COUNT)
+        return i;
+    unsigned e = static_cast<unsigned>(i / SUB_COUNT) - 1;
+    std::uint64_t lower = static_cast<std::uint64_t>(i % SUB_COUNT + SUB_COUNT) << e;
+    return lower + ((std::uint64_t{1} << e) >> 1);
+}
+
+static_assert(bucketIndex(2 * SUB_COUNT - 1) + 1 == bucketIndex(2 * SUB_COUNT));
+static_assert(bucketIndex(4 * SUB_COUNT - 1) + 1 == bucketIndex(4 * SUB_COUNT));
+static_assert(bucketIndex(~std::uint64_t{0}) == BUCKET_COUNT - 1);
+} // namespace hdr
+
+// Copia no atómica de un histograma; se puede fusionar entre agentes
+struct HistogramSnapshot
+{
+    std::array<std::uint64_t, hdr::BUCKET_COUNT> counts{};
+    std::uint64_t total{0};
+
+    void merge(const HistogramSnapshot &other);
+
+    // Valor por debajo del cual queda la fracción q de las muestras (0 si no hay)
+    std::uint64_t percentile(double q) const;
+    std::uint64_t max() const;
+};
+
+class LatencyHistogram
+{
+public:
+    void record(std::int64_t ns)
+    {
+        auto &c = counts_[hdr::bucketIndex(ns > 0 ? static_cast<std::uint64_t>(ns) : 0)];
+        c.store(c.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    }
+
+    void snapshot(HistogramSnapshot &out) const;
+
+private:
+    std::array<std::atomic<std::uint32_t>, hdr::BUCKET_COUNT> counts_{};
+};
+
+// Métricas de un agente
+struct AgentMetrics
+{
+    std::string team;
+    std::uint16_t port{0};
+
+    std::array<LatencyHistogram, static_cast<std::size_t>(MetricStage::Count)> stages;
+    std::array<std::atomic<std::uint64_t>, static_cast<std::size_t>(MetricCounter::Count)> counters{};
+
+    void record(MetricStage stage, std::int64_t ns) { stages[static_cast<std::size_t>(stage)].record(ns); }
+
+    void add(MetricCounter counter, std::uint64_t n = 1)
+    {
+        auto &c = counters[static_cast<std::size_t>(counter)];
+        c.store(c.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+    }
+
+    void set(MetricCounter counter, std::uint64_t v)
+    {
+        counters[static_cast<std::size_t>(counter)].store(v, std::memory_order_relaxed);
+    }
+
+    // Copia los contadores que llevan el reloj de ciclo y el receptor
+    void publish(const CycleStats &cycle, const ReceiveStats &receive);
+};
+
+// Métricas de un agente tal y como llegan a player_metrics
+struct MetricsReport
+{
+    std::string team;
+    std::uint16_t port{0};
+    std::array<std::uint64_t, static_cast<std::size_t>(MetricCounter::Count)> counters{};
+    std::array<HistogramSnapshot, static_cast<std::size_t>(MetricStage::Count)> stages{};
+};
+
+// Formato de texto del endpoint, una línea por registro:
+//   agent <equipo> <puerto> <contador>=<valor> ...
+//   hist <equipo> <puerto> <etapa> <cubo>:<cuenta> ...   (sólo cubos no vacíos)
+void writeMetrics(const AgentMetrics &metrics, std::string &out);
+
+// Añade a out los agentes del texto; ignora las líneas que no entiende
+void parseMetrics(std::string_view text, std::vector<MetricsReport> &out);
+
+// Lee el estado completo del endpoint en path; false si no responde (proceso terminado)
+bool queryMetrics(const std::string &path, std::string &out);
+
+// Hilo que atiende el socket Unix <dir>/player_<pid>.sock: a cada conexión le
+// escribe el estado de todos los agentes del proceso y la cierra
+class MetricsServer
+{
+public:
+    MetricsServer() = default;
+    ~MetricsServer();
+    MetricsServer(const MetricsServer &) = delete;
+    MetricsServer &operator=(const MetricsServer &) = delete;
+
+    bool start(const std::string &dir, std::vector<const AgentMetrics *> agents);
+    void stop();
+
+private:
+    void serve();
+
+    int fd_{-1};
+    std::string path_;
+    std::vector<const AgentMetrics *> agents_;
+    std::thread thread_;
+};
@@ -0,0 +1,185 @@
+// player_metrics: consulta los sockets de métricas (--metrics DIR) de todos
+// los procesos de jugadores, fusiona los histogramas por equipo y muestra la
+// latencia por etapa (p50, p90, p99, p99.9, máx), los contadores de ciclo y el
+// rendimiento del planificador (nodos/s y profundidad media por búsqueda).
+// Con --interval repite la consulta para seguir la cola de latencia en vivo y
+// muestra los ciclos simulados por segundo de cada equipo (en modo síncrono,
+// el ritmo que aguanta el equipo).
+#include "args.h"
+#include "metrics.h"
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <map>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+static double us(std::uint64_t ns)
+{
+    return static_cast<double>(ns) / 1000.0;
+}
+
+static std::uint64_t counter(const MetricsReport &r, MetricCounter c)
+{
+    return r.counters[static_cast<std::size_t>(c)];
+}
+
+static const HistogramSnapshot &stage(const MetricsReport &r, MetricStage s)
+{
+    return r.stages[static_cast<std::size_t>(s)];
+}
+
+// Ciclos por agente en la consulta anterior, para el ritmo con --interval
+struct CycleSample
+{
+    double cycles{0.0};
+    std::chrono::steady_clock::time_point at{};
+};
+
+static void printTeam(const std::string &team, const std::vector<const MetricsReport *> &reports, bool perAgent,
+                      CycleSample *previous)
+{
+    MetricsReport total;
+    for (const MetricsReport *r : reports) {
+        for (std::size_t i = 0; i < total.counters.size(); ++i)
+            total.counters[i] += r->counters[i];
+        for (std::size_t s = 0; s < total.stages.size(); ++s)
+            total.stages[s].merge(r->stages[s]);
+    }
+
+    std::printf("%s: %zu agents", team.c_str(), reports.size());
+    if (previous) {
+        CycleSample now{static_cast<double>(counter(total, MetricCounter::Cycles)) / static_cast<double>(reports.size()),
+                        std::chrono::steady_clock::now()};
+        double seconds = std::chrono::duration<double>(now.at - previous->at).count();
+        if (previous->at != std::chrono::steady_clock::time_point{} && seconds > 0.0)
+            std::printf(", %.1f cycles/s", (now.cycles - previous->cycles) / seconds);
+        *previous = now;
+    }
+    std::printf("\n ");
+    for (std::size_t i = 0; i < total.counters.size(); ++i)
+        std::printf(" %.*s=%llu", static_cast<int>(METRIC_COUNTER_NAMES[i].size()), METRIC_COUNTER_NAMES[i].data(),
+                    static_cast<unsigned long long>(total.counters[i]));
+    std::printf("\n  %-14s %10s %10s %10s %10s %10s %10s  (us)\n", "stage", "count", "p50", "p90", "p99", "p99.9", "max");
+    for (std::size_t s = 0; s < total.stages.size(); ++s) {
+        const HistogramSnapshot &h = total.stages[s];
+        std::printf("  %-14.*s %10llu %10.1f %10.1f %10.1f %10.1f %10.1f\n",
+                    static_cast<int>(METRIC_STAGE_NAMES[s].size()), METRIC_STAGE_NAMES[s].data(),
+                    static_cast<unsigned long long>(h.total), us(h.percentile(0.5)), us(h.percentile(0.9)),
+                    us(h.percentile(0.99)), us(h.percentile(0.999)), us(h.max()));
+    }
+
+    // Planificador: cuánto busca por segundo y hasta dónde llega en cada ciclo
+    std::uint64_t searches = counter(total, MetricCounter::PlanSearches);
+    if (searches > 0) {
+        std::uint64_t ns = counter(total, MetricCounter::PlanNs);
+        std::printf("  planner: %llu searches, %.0f nodes/s, %.1f nodes/search, mean depth %.2f\n",
+                    static_cast<unsigned long long>(searches),
+                    ns > 0 ? 1e9 * static_cast<double>(counter(total, MetricCounter::PlanNodes)) / static_cast<double>(ns) : 0.0,
+                    static_cast<double>(counter(total, MetricCounter::PlanNodes)) / static_cast<double>(searches),
+                    static_cast<double>(counter(total, MetricCounter::PlanDepth)) / static_cast<double>(searches));
+    }
+
+    // Percepción: frecuencia de see y antigüedad del balón sobre el que se decide
+    std::uint64_t cycles = counter(total, MetricCounter::Cycles);
+    std::uint64_t known = counter(total, MetricCounter::BallKnown);
+    std::uint64_t decisions = known + counter(total, MetricCounter::BallUnknown);
+    if (cycles > 0 && decisions > 0) {
+        std::printf("  perception: %.2f sees/cycle, mean ball age %.2f cycles, ball unknown in %.1f%% of decisions\n",
+                    static_cast<double>(counter(total, MetricCounter::Sees)) / static_cast<double>(cycles),
+                    known > 0 ? static_cast<double>(counter(total, MetricCounter::BallAgeSum)) / static_cast<double>(known) : 0.0,
+                    100.0 * static_cast<double>(decisions - known) / static_cast<double>(decisions));
+    }
+
+    if (!perAgent)
+        return;
+    std::printf("  %-6s %8s %8s %8s %8s %8s %12s %12s %12s\n", "port", "cycles", "sent", "empty", "missed", "stale",
+                "recv p50", "recv p99", "cycle p99");
+    for (const MetricsReport *r : reports) {
+        const HistogramSnapshot &recv = stage(*r, MetricStage::ReceiveToSend);
+        std::printf("  %-6u %8llu %8llu %8llu %8llu %8llu %12.1f %12.1f %12.1f\n", r->port,
+                    static_cast<unsigned long long>(counter(*r, MetricCounter::Cycles)),
+                    static_cast<unsigned long long>(counter(*r, MetricCounter::Sent)),
+                    static_cast<unsigned long long>(counter(*r, MetricCounter::EmptyDecisions)),
+                    static_cast<unsigned long long>(counter(*r, MetricCounter::MissedCycles)),
+                    static_cast<unsigned long long>(counter(*r, MetricCounter::StaleSees)),
+                    us(recv.percentile(0.5)), us(recv.percentile(0.99)),
+                    us(stage(*r, MetricStage::CycleToSend).percentile(0.99)));
+    }
+}
+
+static int pollOnce(const std::string &dir, const std::string &teamFilter, bool perAgent,
+                    std::map<std::string, CycleSample> *rates)
+{
+    std::vector<MetricsReport> reports;
+    int endpoints = 0;
+
+    std::error_code ec;
+    for (const auto &entry : std::filesystem::directory_iterator(dir, ec)) {
+        std::string name = entry.path().filename().string();
+        if (name.rfind("player_", 0) != 0 || !name.ends_with(".sock"))
+            continue;
+        std::string text;
+        if (!queryMetrics(entry.path().string(), text))
+            continue;
+        ++endpoints;
+        parseMetrics(text, reports);
+    }
+    if (ec) {
+        std::printf("Cannot read %s\n", dir.c_str());
+        return 1;
+    }
+
+    std::map<std::string, std::vector<const MetricsReport *>> teams;
+    for (const MetricsReport &r : reports) {
+        if (teamFilter.empty() || r.team == teamFilter)
+            teams[r.team].push_back(&r);
+    }
+
+    std::printf("%d endpoint(s) in %s\n", endpoints, dir.c_str());
+    for (const auto &[team, list] : teams)
+        printTeam(team, list, perAgent, rates ? &(*rates)[team] : nullptr);
+    return teams.empty() ? 1 : 0;
+}
+
+int main(int argc, char *argv[])
+{
+    if (argc < 2) {
+        std::printf("Usage: %s <metrics-dir> [--team NAME] [--agents] [--interval S]\n", argv[0]);
+        return 1;
+    }
+
+    std::string dir = argv[1];
+    std::string team;
+    bool perAgent = false;
+    double interval = 0.0;
+    for (int i = 2; i < argc; ++i) {
+        std::string_view arg = argv[i];
+        if (arg == "--agents") {
+            perAgent = true;
+        } else if (arg == "--team" && i + 1 < argc) {
+            team = argv[++i];
+        } else if (arg == "--interval" && i + 1 < argc) {
+            if (!parseArg(argv[++i], interval, 0.0)) {
+                std::printf("Invalid --interval %s\n", argv[i]);
+                return 1;
+            }
+        } else {
+            std::printf("Unknown option %s\n", argv[i]);
+            return 1;
+        }
+    }
+
+    if (interval <= 0.0)
+        return pollOnce(dir, team, perAgent, nullptr);
+
+    std::map<std::string, CycleSample> rates;
+    while (true) {
+        std::printf("\033[H\033[2J");
+        pollOnce(dir, team, perAgent, &rates);
+        std::fflush(stdout);
+        std::this_thread::sleep_for(std::chrono::duration<double>(interval));
+    }
+}
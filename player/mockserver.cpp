@@ -0,0 +1,960 @@
+// mock_server: sustituto local y ligero de rcssserver para pruebas de carga y
+// de tiempos. Habla el protocolo de jugador (init, move, dash, turn, kick,
+// turn_neck, change_view, say), envía sense_body al comienzo de cada ciclo,
+// see según el modo de vista de cada jugador y hear con los cambios de modo de
+// juego de un guion. Registra cuándo llega cada comando respecto al inicio del
+// ciclo y al informe final añade latencias, ciclos perdidos, duplicados y el
+// consumo de CPU de los agentes lanzados con --run. Cada uno va en su propio
+// grupo de procesos, que se termina y se espera al salir, también con SIGINT,
+// SIGTERM o SIGHUP.
+//
+// Con --synch imita server::synch_mode: tras la percepción de cada ciclo envía
+// (think) y pasa al siguiente en cuanto todos los jugadores contestan (done)
+// (o tras --step-ms si alguno no lo hace), e informa de los ciclos por segundo.
+// Los jugadores que piden (synch_see) reciben el see junto al sense_body, cada
+// 1, 2 o 3 ciclos según la anchura de vista.
+//
+// En el puerto --port + 2 atiende a entrenadores en línea: (init TEAM ...),
+// (eye on) para recibir see_global en cada ciclo y (say (freeform "...")),
+// que reenvía a los jugadores de su equipo.
+//
+// La física es mínima (aceleración, decaimiento y chute), suficiente para que
+// las observaciones sean coherentes con los comandos recibidos.
+#include "args.h"
+#include "net.h"
+#include "cycle.h"
+#include "flags.h"
+#include "sexpr.h"
+#include "positions.h"
+#include <algorithm>
+#include <cerrno>
+#include <cmath>
+#include <csignal>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <sys/epoll.h>
+#include <sys/resource.h>
+#include <sys/timerfd.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+static constexpr double DEG = M_PI / 180.0;
+
+// Parámetros de rcssserver usados por la física y las observaciones
+static constexpr double PLAYER_DECAY = 0.4;
+static constexpr double PLAYER_SPEED_MAX = 1.05;
+static constexpr double DASH_POWER_RATE = 0.006;
+static constexpr double INERTIA_MOMENT = 5.0;
+static constexpr double BALL_DECAY = 0.94;
+static constexpr double BALL_SPEED_MAX = 3.0;
+static constexpr double KICK_POWER_RATE = 0.027;
+static constexpr double KICKABLE_DIST = 0.7 + 0.3 + 0.085;   // kickable_margin + player_size + ball_size
+static constexpr double NECK_MAX = 90.0;
+static constexpr double UNUM_FAR_LENGTH = 20.0;
+static constexpr double TEAM_FAR_LENGTH = 40.0;
+static constexpr double QUANTIZE_STEP = 0.1;
+static constexpr double QUANTIZE_STEP_LANDMARK = 0.01;
+static constexpr int MAX_TEAM_PLAYERS = 11;
+
+struct MockOptions
+{
+    std::uint16_t port{6000};
+    int cycles{300};
+    std::int64_t stepNs{SERVER_CYCLE_NS};
+    std::int64_t seeStepNs{150'000'000};       // send_step con vista normal y calidad alta
+    ViewWidth view{ViewWidth::Normal};
+    ViewQuality quality{ViewQuality::High};
+    int waitPlayers{0};                         // jugadores a esperar antes de arrancar el reloj
+    std::string script{"0:before_kick_off,10:kick_off_l,11:play_on"};
+    std::vector<std::string> run;               // comandos de agentes a lanzar
+    std::string csvPath;                        // registro de llegadas por comando
+    bool synch{false};                          // el ciclo avanza con los (done) de todos
+};
+
+// Cambio de modo de juego programado en el guion del árbitro
+struct ScriptStep
+{
+    int cycle;
+    std::string mode;
+};
+
+// Jugador conectado: su socket propio (como el servidor real, un puerto por
+// jugador), su estado físico en el convenio del equipo y sus contadores.
+struct MockPlayer
+{
+    UdpSocket socket;
+    UdpAddress addr;
+    std::string team;
+    Side side{Side::Unknown};
+    int unum{0};
+    bool goalie{false};
+
+    Point pos{};
+    Point vel{};
+    double bodyDir{0.0};        // grados, antihorario
+    double headAngle{0.0};      // relativo al cuerpo, convenio del servidor
+    ViewWidth view{ViewWidth::Normal};
+    ViewQuality quality{ViewQuality::High};
+    CommandCounters counters{};
+
+    // Comando de cuerpo del ciclo en curso (se ejecuta en el cambio de ciclo)
+    Command pending{};
+    int bodyThisCycle{0};
+    std::int64_t nextSeeNs{0};
+    std::int64_t lastSeeNs{0};
+    bool synchSee{false};                   // pidió (synch_see): see alineado con el ciclo
+    bool done{false};                       // contestó (done) en el ciclo en curso
+
+    // Medidas
+    bool measuring{false};                  // desde su primer sense_body
+    std::uint64_t commands{0};
+    std::uint64_t missedCycles{0};
+    std::uint64_t duplicates{0};
+    std::vector<std::int32_t> offsetUs;     // llegada desde el inicio del ciclo (sense_body)
+    std::vector<std::int32_t> sinceSeeUs;   // llegada desde el último see enviado
+};
+
+// Entrenador en línea conectado al puerto de entrenadores
+struct MockCoach
+{
+    UdpAddress addr;
+    std::string team;
+    Side side{Side::Unknown};
+    bool eye{false};                        // (eye on): see_global en cada ciclo
+    std::uint64_t said{0};
+};
+
+struct MockServer
+{
+    MockOptions options;
+    std::vector<ScriptStep> script;
+    UdpSocket mainSocket;
+    std::vector<std::unique_ptr<MockPlayer>> players;
+    UdpSocket coachSocket;
+    std::vector<MockCoach> coaches;
+    std::string teamNames[2];
+
+    int time{0};
+    std::string playMode{"before_kick_off"};
+    bool running{false};
+    std::int64_t cycleStartNs{0};
+    Point ball{};
+    Point ballVel{};
+    std::FILE *csv{nullptr};
+    std::uint64_t synchTimeouts{0};             // ciclos que avanzaron sin todos los (done)
+};
+
+// --- Utilidades ---------------------------------------------------------------
+
+// Cuantización de distancias de rcssserver: log(d) en pasos de qstep, luego 0.1
+static double quantizeDist(double d, double qstep)
+{
+    double q = std::exp(std::rint(std::log(d + 1e-10) / qstep) * qstep);
+    return std::rint(q / 0.1) * 0.1;
+}
+
+static std::int64_t viewStepNs(const MockOptions &options, const MockPlayer &p)
+{
+    std::int64_t step = options.seeStepNs;
+    if (p.view == ViewWidth::Narrow) step /= 2;
+    if (p.view == ViewWidth::Wide) step *= 2;
+    if (p.quality == ViewQuality::Low) step /= 2;
+    return step;
+}
+
+// Ciclos entre see con synch_see, como rcssserver: estrecha 1, normal 2, amplia 3
+static int synchSeeCycles(const MockPlayer &p)
+{
+    switch (p.view) {
+        case ViewWidth::Narrow: return 1;
+        case ViewWidth::Wide:   return 3;
+        default:                return 2;
+    }
+}
+
+static const char *viewWidthName(ViewWidth w)
+{
+    switch (w) {
+        case ViewWidth::Narrow: return "narrow";
+        case ViewWidth::Wide:   return "wide";
+        default:                return "normal";
+    }
+}
+
+static bool parseViewWidth(std::string_view tok, ViewWidth &out)
+{
+    if (tok == "narrow") out = ViewWidth::Narrow;
+    else if (tok == "normal") out = ViewWidth::Normal;
+    else if (tok == "wide") out = ViewWidth::Wide;
+    else return false;
+    return true;
+}
+
+// Guion "ciclo:modo,ciclo:modo,...", ej: "0:before_kick_off,10:kick_off_l,11:play_on"
+static bool parseScript(std::string_view text, std::vector<ScriptStep> &out)
+{
+    while (!text.empty()) {
+        auto comma = text.find(',');
+        std::string_view item = text.substr(0, comma);
+        text = (comma == std::string_view::npos) ? std::string_view{} : text.substr(comma + 1);
+
+        auto colon = item.find(':');
+        if (colon == std::string_view::npos)
+            return false;
+        ScriptStep step{};
+        auto [ptr, ec] = std::from_chars(item.data(), item.data() + colon, step.cycle);
+        if (ec != std::errc{} || item.substr(colon + 1).empty())
+            return false;
+        step.mode = std::string(item.substr(colon + 1));
+        out.push_back(std::move(step));
+    }
+    std::stable_sort(out.begin(), out.end(), [](const ScriptStep &a, const ScriptStep &b) { return a.cycle < b.cycle; });
+    return true;
+}
+
+static void sendTo(MockPlayer &p, const std::string &msg)
+{
+    // El servidor termina cada mensaje con '\0'
+    p.socket.sendTo(std::string_view(msg.c_str(), msg.size() + 1), p.addr);
+}
+
+// Dirección relativa en el convenio del servidor (horario) vista desde el cuello
+static double relativeDir(const MockPlayer &p, Point target)
+{
+    double absDir = std::atan2(target.y - p.pos.y, target.x - p.pos.x) / DEG;
+    double face = p.bodyDir - p.headAngle;
+    return -normalizaAngulo(absDir - face);
+}
+
+// --- Mensajes del servidor ----------------------------------------------------
+
+static std::string makeSee(const MockServer &server, const MockPlayer &p)
+{
+    char buf[160];
+    std::string msg;
+    msg.reserve(2048);
+    std::snprintf(buf, sizeof(buf), "(see %d", server.time);
+    msg += buf;
+
+    const double half = viewHalfAngle(p.view);
+    const bool high = p.quality == ViewQuality::High;
+
+    for (const FlagDef &f : FLAG_TABLE) {
+        double dir = relativeDir(p, f.pos);
+        if (std::fabs(dir) > half)
+            continue;
+        double dist = quantizeDist(std::hypot(f.pos.x - p.pos.x, f.pos.y - p.pos.y), QUANTIZE_STEP_LANDMARK);
+        if (high)
+            std::snprintf(buf, sizeof(buf), " ((%.*s) %.1f %.0f)", static_cast<int>(f.name.size()), f.name.data(), dist, std::rint(dir));
+        else
+            std::snprintf(buf, sizeof(buf), " ((%.*s) %.0f)", static_cast<int>(f.name.size()), f.name.data(), std::rint(dir));
+        msg += buf;
+    }
+
+    double ballDir = relativeDir(p, server.ball);
+    if (std::fabs(ballDir) <= half) {
+        double dist = quantizeDist(std::hypot(server.ball.x - p.pos.x, server.ball.y - p.pos.y), QUANTIZE_STEP);
+        if (high)
+            std::snprintf(buf, sizeof(buf), " ((b) %.1f %.0f 0 0)", dist, std::rint(ballDir));
+        else
+            std::snprintf(buf, sizeof(buf), " ((b) %.0f)", std::rint(ballDir));
+        msg += buf;
+    }
+
+    for (const auto &other : server.players) {
+        if (other.get() == &p)
+            continue;
+        double dir = relativeDir(p, other->pos);
+        if (std::fabs(dir) > half)
+            continue;
+        double raw = std::hypot(other->pos.x - p.pos.x, other->pos.y - p.pos.y);
+        double dist = quantizeDist(raw, QUANTIZE_STEP);
+        if (!high) {
+            std::snprintf(buf, sizeof(buf), " ((p) %.0f)", std::rint(dir));
+        } else if (raw <= UNUM_FAR_LENGTH) {
+            double bodyRel = -normalizaAngulo(other->bodyDir - (p.bodyDir - p.headAngle));
+            std::snprintf(buf, sizeof(buf), " ((p \"%s\" %d%s) %.1f %.0f 0 0 %.0f %.0f)",
+                          other->team.c_str(), other->unum, other->goalie ? " goalie" : "",
+                          dist, std::rint(dir), std::rint(bodyRel), std::rint(bodyRel + other->headAngle));
+        } else if (raw <= TEAM_FAR_LENGTH) {
+            std::snprintf(buf, sizeof(buf), " ((p \"%s\") %.1f %.0f)", other->team.c_str(), dist, std::rint(dir));
+        } else {
+            std::snprintf(buf, sizeof(buf), " ((p) %.1f %.0f)", dist, std::rint(dir));
+        }
+        msg += buf;
+    }
+    // Las líneas del campo no se envían: el agente se localiza sólo con banderas
+    msg += ")";
+    return msg;
+}
+
+static std::string makeSenseBody(const MockServer &server, const MockPlayer &p)
+{
+    double speed = std::hypot(p.vel.x, p.vel.y);
+    double speedDir = 0.0;
+    if (speed > 1e-6)
+        speedDir = -normalizaAngulo(std::atan2(p.vel.y, p.vel.x) / DEG - (p.bodyDir - p.headAngle));
+
+    const CommandCounters &c = p.counters;
+    char buf[640];
+    std::snprintf(buf, sizeof(buf),
+                  "(sense_body %d (view_mode %s %s) (stamina 8000 1 130600) (speed %.2f %.0f) "
+                  "(head_angle %.0f) (kick %d) (dash %d) (turn %d) (say %d) (turn_neck %d) (catch %d) (move %d) "
+                  "(change_focus 0) (change_view %d) (arm (movable 0) (expires 0) (target 0 0) (count 0)) "
+                  "(focus (target none) (count 0)) (tackle (expires 0) (count 0)) (collision none) "
+                  "(foul  (charged 0) (card none)) (focus_point 0 0))",
+                  server.time, p.quality == ViewQuality::High ? "high" : "low", viewWidthName(p.view),
+                  speed, std::rint(speedDir), p.headAngle,
+                  c.kick, c.dash, c.turn, c.say, c.turnNeck, c.catch_, c.move, c.changeView);
+    return buf;
+}
+
+static void sendTo(MockServer &server, const MockCoach &c, const std::string &msg)
+{
+    server.coachSocket.sendTo(std::string_view(msg.c_str(), msg.size() + 1), c.addr);
+}
+
+// Estado exacto en el convenio del servidor (y hacia abajo, ángulos horarios)
+static std::string makeSeeGlobal(const MockServer &server)
+{
+    char buf[160];
+    std::string msg;
+    msg.reserve(2048);
+    std::snprintf(buf, sizeof(buf), "(see_global %d ((g l) -52.5 0) ((g r) 52.5 0) ((b) %.4f %.4f %.4f %.4f)",
+                  server.time, server.ball.x, -server.ball.y, server.ballVel.x, -server.ballVel.y);
+    msg += buf;
+    for (const auto &p : server.players) {
+        std::snprintf(buf, sizeof(buf), " ((p \"%s\" %d%s) %.4f %.4f %.4f %.4f %.0f %.0f)", p->team.c_str(), p->unum,
+                      p->goalie ? " goalie" : "", p->pos.x, -p->pos.y, p->vel.x, -p->vel.y, std::rint(-p->bodyDir),
+                      std::rint(p->headAngle));
+        msg += buf;
+    }
+    msg += ")";
+    return msg;
+}
+
+static void broadcastReferee(MockServer &server)
+{
+    std::string msg = "(hear " + std::to_string(server.time) + " referee " + server.playMode + ")";
+    for (auto &p : server.players)
+        sendTo(*p, msg);
+    for (const MockCoach &c : server.coaches)
+        sendTo(server, c, msg);
+}
+
+// --- Comandos de los jugadores ------------------------------------------------
+
+static void recordArrival(MockServer &server, MockPlayer &p, std::string_view name, std::int64_t now)
+{
+    if (!server.running || !p.measuring)
+        return;
+    auto offsetUs = static_cast<std::int32_t>((now - server.cycleStartNs) / 1000);
+    auto sinceSeeUs = static_cast<std::int32_t>((now - p.lastSeeNs) / 1000);
+    p.offsetUs.push_back(offsetUs);
+    if (p.lastSeeNs > 0)
+        p.sinceSeeUs.push_back(sinceSeeUs);
+    if (server.csv) {
+        std::fprintf(server.csv, "%d,%s,%d,%.*s,%d,%d\n", server.time, p.team.c_str(), p.unum,
+                     static_cast<int>(name.size()), name.data(), offsetUs, p.lastSeeNs > 0 ? sinceSeeUs : -1);
+    }
+}
+
+// Aplica un datagrama con uno o varios comandos concatenados
+static void handlePlayerCommands(MockServer &server, MockPlayer &p, std::string_view msg, std::int64_t now)
+{
+    SExprCursor cur(msg);
+    while (cur.consume('(')) {
+        std::string_view name = cur.atom();
+        double a = 0.0, b = 0.0;
+
+        Command cmd{};
+        if (name == "dash") {
+            cur.number(a); cur.number(b);
+            cmd = Command::dash(a, b);
+        } else if (name == "turn") {
+            cur.number(a);
+            cmd = Command::turn(a);
+        } else if (name == "kick") {
+            cur.number(a); cur.number(b);
+            cmd = Command::kick(a, b);
+        } else if (name == "move") {
+            cur.number(a); cur.number(b);
+            cmd = Command::move(a, b);
+        } else if (name == "catch") {
+            cur.number(a);
+            cmd = Command::catchBall(a);
+        } else if (name == "turn_neck") {
+            cur.number(a);
+            p.headAngle = std::clamp(p.headAngle + a, -NECK_MAX, NECK_MAX);
+            ++p.counters.turnNeck;
+        } else if (name == "change_view") {
+            ViewWidth w = p.view;
+            if (parseViewWidth(cur.atom(), w)) {
+                p.view = w;
+                std::string_view q = cur.atom();
+                if (q == "low" || q == "high")
+                    p.quality = (q == "low") ? ViewQuality::Low : ViewQuality::High;
+                ++p.counters.changeView;
+            }
+        } else if (name == "say") {
+            std::string_view text = cur.untilClose();
+            ++p.counters.say;
+            for (auto &other : server.players) {
+                if (other.get() == &p)
+                    continue;
+                std::string hear = "(hear " + std::to_string(server.time) + " 0 ";
+                if (other->side == p.side)
+                    hear += "our " + std::to_string(p.unum) + " \"" + std::string(text) + "\")";
+                else
+                    hear += "opp)";
+                sendTo(*other, hear);
+            }
+            continue;
+        } else if (name == "done") {
+            p.done = true;
+        } else if (name == "synch_see") {
+            p.synchSee = true;
+            sendTo(p, "(ok synch_see)");
+        }
+
+        // Saltar el resto del comando hasta su ')'
+        cur.untilClose();
+
+        if (cmd.isBody()) {
+            ++p.commands;
+            recordArrival(server, p, name, now);
+            // El servidor sólo ejecuta el primer comando de cuerpo de cada ciclo
+            if (p.bodyThisCycle++ == 0)
+                p.pending = cmd;
+        }
+    }
+}
+
+// (init TEAM (version N) [(goalie)]) en el puerto principal: crea el jugador
+// con un socket propio y contesta desde él, como hace rcssserver
+static void handleInit(MockServer &server, std::string_view msg, const UdpAddress &from, int epfd)
+{
+    SExprCursor cur(msg);
+    if (!cur.consume('(') || cur.atom() != "init")
+        return;
+    std::string team(cur.atom());
+    bool goalie = msg.find("(goalie)") != std::string_view::npos;
+
+    int sideIdx = -1;
+    for (int i = 0; i < 2; ++i) {
+        if (server.teamNames[i].empty())
+            server.teamNames[i] = team;
+        if (server.teamNames[i] == team) {
+            sideIdx = i;
+            break;
+        }
+    }
+    Side side = sideIdx == 0 ? Side::Left : Side::Right;
+
+    int count = 0;
+    for (const auto &p : server.players)
+        count += (p->team == team);
+
+    auto player = std::make_unique<MockPlayer>();
+    if (sideIdx < 0 || count >= MAX_TEAM_PLAYERS || !player->socket.open(0)) {
+        server.mainSocket.sendTo("(error no_more_team_or_player_or_goalie)", from);
+        return;
+    }
+
+    MockPlayer &p = *player;
+    p.addr = from;
+    p.team = team;
+    p.side = side;
+    p.unum = count + 1;
+    p.goalie = goalie;
+    p.view = server.options.view;
+    p.quality = server.options.quality;
+    // Fuera del campo junto a la banda inferior hasta que envíe move
+    double sx = side == Side::Left ? -1.0 : 1.0;
+    p.pos = {sx * 3.0 * p.unum, -PITCH_HALF_WIDTH - 3.0};
+    p.bodyDir = side == Side::Left ? 0.0 : 180.0;
+    p.nextSeeNs = monotonicNowNs();
+
+    epoll_event ev{};
+    ev.events = EPOLLIN;
+    ev.data.ptr = player.get();
+    epoll_ctl(epfd, EPOLL_CTL_ADD, p.socket.fd(), &ev);
+
+    char reply[64];
+    std::snprintf(reply, sizeof(reply), "(init %c %d %s)", side == Side::Left ? 'l' : 'r', p.unum, server.playMode.c_str());
+    sendTo(p, reply);
+    std::printf("init: %s %d%s (%c) from port %u, served on port %u\n", team.c_str(), p.unum, goalie ? " goalie" : "",
+                side == Side::Left ? 'l' : 'r', from.port, p.socket.localPort());
+
+    server.players.push_back(std::move(player));
+}
+
+// Mensajes al puerto de entrenadores: (init TEAM (version N)), (eye on|off) y
+// (say (freeform "...")). Cada entrenador se identifica por su dirección.
+static void handleCoach(MockServer &server, std::string_view msg, const UdpAddress &from)
+{
+    SExprCursor cur(msg);
+    if (!cur.consume('('))
+        return;
+    std::string_view name = cur.atom();
+
+    auto it = std::find_if(server.coaches.begin(), server.coaches.end(), [&](const MockCoach &c) {
+        return c.addr.ip == from.ip && c.addr.port == from.port;
+    });
+    if (name == "init") {
+        std::string team(cur.atom());
+        int sideIdx = -1;
+        for (int i = 0; i < 2; ++i) {
+            if (server.teamNames[i].empty())
+                server.teamNames[i] = team;
+            if (server.teamNames[i] == team) {
+                sideIdx = i;
+                break;
+            }
+        }
+        if (sideIdx < 0 || it != server.coaches.end()) {
+            server.coachSocket.sendTo("(error no_more_team_or_player_or_goalie)", from);
+            return;
+        }
+        MockCoach c{from, team, sideIdx == 0 ? Side::Left : Side::Right, false, 0};
+        server.coaches.push_back(c);
+        sendTo(server, c, sideIdx == 0 ? "(init l ok)" : "(init r ok)");
+        std::printf("coach init: %s (%c) from port %u\n", team.c_str(), sideIdx == 0 ? 'l' : 'r', from.port);
+        return;
+    }
+    if (it == server.coaches.end())
+        return;
+    MockCoach &c = *it;
+    if (name == "eye") {
+        c.eye = cur.atom() == "on";
+        sendTo(server, c, c.eye ? "(ok eye on)" : "(ok eye off)");
+    } else if (name == "say") {
+        cur.consume('(');
+        cur.atom(); // "freeform"
+        std::string_view text = cur.atom();
+        ++c.said;
+        std::string hear = "(hear " + std::to_string(server.time) + " online_coach_" +
+                           (c.side == Side::Left ? "left" : "right") + " (freeform \"" + std::string(text) + "\"))";
+        for (auto &p : server.players)
+            sendTo(*p, hear);
+        sendTo(server, c, "(ok say)");
+    }
+}
+
+// --- Simulación ---------------------------------------------------------------
+
+static void simulateStep(MockServer &server)
+{
+    for (auto &ptr : server.players) {
+        MockPlayer &p = *ptr;
+        const Command &cmd = p.pending;
+        double speed = std::hypot(p.vel.x, p.vel.y);
+
+        switch (cmd.type) {
+            case CommandType::Dash: {
+                double power = std::clamp(cmd.a, -100.0, 100.0);
+                double dir = (p.bodyDir - cmd.b) * DEG;
+                double accel = power * DASH_POWER_RATE;
+                p.vel.x += accel * std::cos(dir);
+                p.vel.y += accel * std::sin(dir);
+                ++p.counters.dash;
+                break;
+            }
+            case CommandType::Turn:
+                p.bodyDir = normalizaAngulo(p.bodyDir - std::clamp(cmd.a, -180.0, 180.0) / (1.0 + INERTIA_MOMENT * speed));
+                ++p.counters.turn;
+                break;
+            case CommandType::Kick: {
+                if (std::hypot(server.ball.x - p.pos.x, server.ball.y - p.pos.y) <= KICKABLE_DIST) {
+                    double power = std::clamp(cmd.a, -100.0, 100.0) * KICK_POWER_RATE;
+                    double dir = (p.bodyDir - cmd.b) * DEG;
+                    server.ballVel.x += power * std::cos(dir);
+                    server.ballVel.y += power * std::sin(dir);
+                }
+                ++p.counters.kick;
+                break;
+            }
+            case CommandType::Move: {
+                // Coordenadas propias: para el equipo derecho el campo está girado
+                double sx = p.side == Side::Right ? -1.0 : 1.0;
+                p.pos = {sx * cmd.a, -sx * cmd.b};
+                p.vel = {};
+                ++p.counters.move;
+                break;
+            }
+            case CommandType::Catch:
+                ++p.counters.catch_;
+                break;
+            default:
+                break;
+        }
+
+        if (p.measuring) {
+            if (p.bodyThisCycle == 0)
+                ++p.missedCycles;
+            else if (p.bodyThisCycle > 1)
+                p.duplicates += static_cast<std::uint64_t>(p.bodyThisCycle - 1);
+        }
+        p.pending = Command{};
+        p.bodyThisCycle = 0;
+
+        speed = std::hypot(p.vel.x, p.vel.y);
+        if (speed > PLAYER_SPEED_MAX) {
+            p.vel.x *= PLAYER_SPEED_MAX / speed;
+            p.vel.y *= PLAYER_SPEED_MAX / speed;
+        }
+        p.pos.x += p.vel.x;
+        p.pos.y += p.vel.y;
+        p.vel.x *= PLAYER_DECAY;
+        p.vel.y *= PLAYER_DECAY;
+    }
+
+    double ballSpeed = std::hypot(server.ballVel.x, server.ballVel.y);
+    if (ballSpeed > BALL_SPEED_MAX) {
+        server.ballVel.x *= BALL_SPEED_MAX / ballSpeed;
+        server.ballVel.y *= BALL_SPEED_MAX / ballSpeed;
+    }
+    server.ball.x = std::clamp(server.ball.x + server.ballVel.x, -PITCH_HALF_LENGTH, PITCH_HALF_LENGTH);
+    server.ball.y = std::clamp(server.ball.y + server.ballVel.y, -PITCH_HALF_WIDTH, PITCH_HALF_WIDTH);
+    server.ballVel.x *= BALL_DECAY;
+    server.ballVel.y *= BALL_DECAY;
+}
+
+// Cambio de ciclo: ejecuta los comandos del ciclo que termina, avanza el
+// tiempo, aplica el guion del árbitro y envía sense_body a todos
+static void beginCycle(MockServer &server, std::int64_t now)
+{
+    if (server.running) {
+        simulateStep(server);
+        ++server.time;
+    }
+    server.cycleStartNs = now;
+
+    for (const ScriptStep &step : server.script) {
+        if (step.cycle == server.time && step.mode != server.playMode) {
+            server.playMode = step.mode;
+            if (step.mode.rfind("kick_off", 0) == 0 || step.mode.rfind("goal_", 0) == 0) {
+                server.ball = {};
+                server.ballVel = {};
+            }
+            broadcastReferee(server);
+        }
+    }
+
+    for (auto &p : server.players) {
+        sendTo(*p, makeSenseBody(server, *p));
+        if (server.running)
+            p->measuring = true;
+        if (p->synchSee && server.time % synchSeeCycles(*p) == 0) {
+            sendTo(*p, makeSee(server, *p));
+            p->lastSeeNs = now;
+        }
+    }
+
+    for (const MockCoach &c : server.coaches) {
+        if (c.eye)
+            sendTo(server, c, makeSeeGlobal(server));
+    }
+
+    if (server.options.synch) {
+        for (auto &p : server.players) {
+            p->done = false;
+            sendTo(*p, "(think)");
+        }
+    }
+}
+
+static bool allDone(const MockServer &server)
+{
+    return !server.players.empty() &&
+           std::all_of(server.players.begin(), server.players.end(), [](const auto &p) { return p->done; });
+}
+
+static void sendDueSees(MockServer &server, std::int64_t now)
+{
+    for (auto &p : server.players) {
+        if (p->synchSee || now < p->nextSeeNs)
+            continue;
+        sendTo(*p, makeSee(server, *p));
+        p->lastSeeNs = now;
+        p->nextSeeNs = std::max(p->nextSeeNs + viewStepNs(server.options, *p), now);
+    }
+}
+
+// --- Informe ------------------------------------------------------------------
+
+static double percentileMs(std::vector<std::int32_t> &v, double q)
+{
+    if (v.empty())
+        return 0.0;
+    auto k = static_cast<std::size_t>(q * static_cast<double>(v.size() - 1));
+    std::nth_element(v.begin(), v.begin() + static_cast<std::ptrdiff_t>(k), v.end());
+    return v[k] / 1000.0;
+}
+
+static void printRow(const char *label, std::uint64_t commands, std::uint64_t missed, std::uint64_t dups,
+                     std::vector<std::int32_t> &offset, std::vector<std::int32_t> &sinceSee)
+{
+    double maxMs = offset.empty() ? 0.0 : *std::max_element(offset.begin(), offset.end()) / 1000.0;
+    std::printf("%-22s %7llu %7llu %5llu %7.2f %7.2f %7.2f %7.2f %9.2f %9.2f\n", label,
+                static_cast<unsigned long long>(commands), static_cast<unsigned long long>(missed),
+                static_cast<unsigned long long>(dups),
+                percentileMs(offset, 0.5), percentileMs(offset, 0.9), percentileMs(offset, 0.99), maxMs,
+                percentileMs(sinceSee, 0.5), percentileMs(sinceSee, 0.99));
+}
+
+static void printReport(MockServer &server, double wallSeconds)
+{
+    if (server.options.synch) {
+        std::printf("\n%d cycles in synch mode (%.1f cycles/s, %llu without every done), %zu players, "
+                    "final play mode %s\n", server.time, server.time / wallSeconds,
+                    static_cast<unsigned long long>(server.synchTimeouts), server.players.size(), server.playMode.c_str());
+    } else {
+        std::printf("\n%d cycles of %.0f ms, %zu players, final play mode %s\n", server.time,
+                    server.options.stepNs / 1e6, server.players.size(), server.playMode.c_str());
+    }
+    std::printf("%-22s %7s %7s %5s %7s %7s %7s %7s %9s %9s\n", "player", "cmds", "missed", "dups",
+                "p50 ms", "p90 ms", "p99 ms", "max ms", "see p50", "see p99");
+
+    std::uint64_t commands = 0, missed = 0, dups = 0;
+    std::vector<std::int32_t> offset, sinceSee;
+    for (auto &p : server.players) {
+        char label[48];
+        std::snprintf(label, sizeof(label), "%.16s %d", p->team.c_str(), p->unum);
+        offset.insert(offset.end(), p->offsetUs.begin(), p->offsetUs.end());
+        sinceSee.insert(sinceSee.end(), p->sinceSeeUs.begin(), p->sinceSeeUs.end());
+        commands += p->commands;
+        missed += p->missedCycles;
+        dups += p->duplicates;
+        printRow(label, p->commands, p->missedCycles, p->duplicates, p->offsetUs, p->sinceSeeUs);
+    }
+    printRow("total", commands, missed, dups, offset, sinceSee);
+
+    rusage self{}, children{};
+    getrusage(RUSAGE_SELF, &self);
+    getrusage(RUSAGE_CHILDREN, &children);
+    auto cpuSeconds = [](const rusage &r) {
+        return static_cast<double>(r.ru_utime.tv_sec + r.ru_stime.tv_sec) +
+               static_cast<double>(r.ru_utime.tv_usec + r.ru_stime.tv_usec) / 1e6;
+    };
+    for (const MockCoach &c : server.coaches)
+        std::printf("coach %s: %llu messages said\n", c.team.c_str(), static_cast<unsigned long long>(c.said));
+
+    std::printf("cpu: server %.3f s (%.1f%%)", cpuSeconds(self), 100.0 * cpuSeconds(self) / wallSeconds);
+    if (!server.options.run.empty())
+        std::printf(", agents %.3f s (%.1f%% of one core)", cpuSeconds(children), 100.0 * cpuSeconds(children) / wallSeconds);
+    std::printf(" over %.2f s\n", wallSeconds);
+}
+
+// --- Programa -----------------------------------------------------------------
+
+static void printUsage(const char *prog)
+{
+    std::printf("Usage: %s [--port N] [--cycles N] [--step-ms N] [--see-ms N]\n"
+                "       [--view narrow|normal|wide] [--quality high|low] [--wait N]\n"
+                "       [--script CYCLE:MODE,...] [--run CMD]... [--csv FILE] [--synch]\n", prog);
+}
+
+static bool parseOptions(int argc, char *argv[], MockOptions &o)
+{
+    for (int i = 1; i < argc; ++i) {
+        std::string_view arg = argv[i];
+        if (arg == "--synch") {
+            o.synch = true;
+            continue;
+        }
+        if (i + 1 >= argc)
+            return false;
+        std::string value = argv[++i];
+
+        std::int64_t ms = 0;
+        if (arg == "--port") { if (!parseArg<std::uint16_t>(value, o.port, 1, 65533)) return false; }
+        else if (arg == "--cycles") { if (!parseArg(value, o.cycles, 1)) return false; }
+        else if (arg == "--step-ms") { if (!parseArg<std::int64_t>(value, ms, 1, 60'000)) return false; o.stepNs = ms * 1'000'000; }
+        else if (arg == "--see-ms") { if (!parseArg<std::int64_t>(value, ms, 1, 60'000)) return false; o.seeStepNs = ms * 1'000'000; }
+        else if (arg == "--view") { if (!parseViewWidth(value, o.view)) return false; }
+        else if (arg == "--quality") o.quality = (value == "low") ? ViewQuality::Low : ViewQuality::High;
+        else if (arg == "--wait") { if (!parseArg(value, o.waitPlayers, 0)) return false; }
+        else if (arg == "--script") o.script = value;
+        else if (arg == "--run") o.run.push_back(value);
+        else if (arg == "--csv") o.csvPath = value;
+        else return false;
+    }
+    return o.cycles > 0 && o.stepNs > 0 && o.seeStepNs > 0;
+}
+
+static volatile std::sig_atomic_t interrupted = 0;
+
+static pid_t spawn(const std::string &command)
+{
+    pid_t pid = fork();
+    if (pid == 0) {
+        // Grupo de procesos propio para poder terminar también a sus hijos.
+        // Con exec el agente sustituye al shell y su CPU se cuenta al esperarlo.
+        setpgid(0, 0);
+        std::string line = "exec " + command;
+        execl("/bin/sh", "sh", "-c", line.c_str(), static_cast<char *>(nullptr));
+        _exit(127);
+    }
+    // También desde el padre: el grupo existe antes de que nadie pueda matarlo
+    if (pid > 0)
+        setpgid(pid, pid);
+    return pid;
+}
+
+// Termina los grupos de procesos lanzados con --run y los espera
+static void stopChildren(const std::vector<pid_t> &children)
+{
+    for (pid_t pid : children)
+        kill(-pid, SIGTERM);
+    for (pid_t pid : children)
+        waitpid(pid, nullptr, 0);
+}
+
+static void armTimer(int timerFd, std::int64_t deadlineNs)
+{
+    itimerspec spec{};
+    spec.it_value.tv_sec = deadlineNs / 1'000'000'000;
+    spec.it_value.tv_nsec = deadlineNs % 1'000'000'000;
+    timerfd_settime(timerFd, TFD_TIMER_ABSTIME, &spec, nullptr);
+}
+
+int main(int argc, char *argv[])
+{
+    MockServer server;
+    if (!parseOptions(argc, argv, server.options) || !parseScript(server.options.script, server.script)) {
+        printUsage(argv[0]);
+        return 1;
+    }
+    const MockOptions &options = server.options;
+
+    if (!server.mainSocket.open(options.port)) {
+        std::printf("Cannot bind UDP port %u\n", options.port);
+        return 1;
+    }
+    if (!options.csvPath.empty()) {
+        server.csv = std::fopen(options.csvPath.c_str(), "w");
+        if (server.csv)
+            std::fprintf(server.csv, "cycle,team,unum,command,offset_us,since_see_us\n");
+    }
+
+    const auto coachPort = static_cast<std::uint16_t>(options.port + 2);
+    if (!server.coachSocket.open(coachPort))
+        std::printf("Cannot bind coach UDP port %u, running without coaches\n", coachPort);
+
+    int epfd = epoll_create1(EPOLL_CLOEXEC);
+    int timerFd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+    epoll_event ev{};
+    ev.events = EPOLLIN;
+    ev.data.ptr = &server.mainSocket;
+    epoll_ctl(epfd, EPOLL_CTL_ADD, server.mainSocket.fd(), &ev);
+    if (server.coachSocket.isOpen()) {
+        ev.data.ptr = &server.coachSocket;
+        epoll_ctl(epfd, EPOLL_CTL_ADD, server.coachSocket.fd(), &ev);
+    }
+    ev.data.ptr = nullptr;
+    epoll_ctl(epfd, EPOLL_CTL_ADD, timerFd, &ev);
+
+    // Sin SA_RESTART: la señal despierta a epoll_wait, el bucle termina y los
+    // agentes lanzados con --run se paran antes de salir
+    struct sigaction sa{};
+    sa.sa_handler = [](int) { interrupted = 1; };
+    sigaction(SIGINT, &sa, nullptr);
+    sigaction(SIGTERM, &sa, nullptr);
+    sigaction(SIGHUP, &sa, nullptr);
+
+    std::vector<pid_t> children;
+    for (const std::string &cmd : options.run) {
+        pid_t pid = spawn(cmd);
+        if (pid < 0) {
+            std::printf("Cannot run '%s': %s\n", cmd.c_str(), std::strerror(errno));
+            stopChildren(children);
+            return 1;
+        }
+        children.push_back(pid);
+    }
+
+    std::printf("mock_server on port %u: %d cycles of %lld ms, see every %lld ms (%s view)\n", options.port,
+                options.cycles, static_cast<long long>(options.stepNs / 1'000'000),
+                static_cast<long long>(options.seeStepNs / 1'000'000), viewWidthName(options.view));
+
+    std::int64_t startNs = monotonicNowNs();
+    std::int64_t nextCycleNs = startNs;
+    char buf[SERVER_MSG_MAX_SIZE];
+    std::array<epoll_event, 32> events{};
+
+    while (server.time < options.cycles && !interrupted) {
+        std::int64_t now = monotonicNowNs();
+        // En modo síncrono el ciclo termina con el último (done); --step-ms es sólo el plazo máximo
+        const bool synchCycle = options.synch && server.running;
+        const bool done = synchCycle && allDone(server);
+        if (done || now >= nextCycleNs) {
+            if (synchCycle && !done)
+                ++server.synchTimeouts;
+            if (!server.running && static_cast<int>(server.players.size()) >= options.waitPlayers) {
+                server.running = true;
+                startNs = now;
+            }
+            beginCycle(server, now);
+            if (options.synch && server.running) {
+                nextCycleNs = now + options.stepNs;
+            } else {
+                nextCycleNs += options.stepNs;
+                if (nextCycleNs <= now)
+                    nextCycleNs = now + options.stepNs;     // recuperar tras un retraso sin ráfagas
+            }
+        }
+        sendDueSees(server, now);
+
+        std::int64_t deadline = nextCycleNs;
+        for (const auto &p : server.players) {
+            if (!p->synchSee)
+                deadline = std::min(deadline, p->nextSeeNs);
+        }
+        armTimer(timerFd, deadline);
+
+        int n = epoll_wait(epfd, events.data(), static_cast<int>(events.size()), -1);
+        if (n < 0 && errno != EINTR)
+            break;
+        for (int i = 0; i < n; ++i) {
+            void *tag = events[i].data.ptr;
+            if (tag == nullptr) {
+                std::uint64_t expirations;
+                [[maybe_unused]] ssize_t r = read(timerFd, &expirations, sizeof(expirations));
+                continue;
+            }
+            if (tag == &server.mainSocket) {
+                UdpAddress from;
+                std::ptrdiff_t len;
+                while ((len = server.mainSocket.receive(buf, sizeof(buf), &from)) > 0)
+                    handleInit(server, std::string_view(buf, static_cast<std::size_t>(len)), from, epfd);
+                continue;
+            }
+            if (tag == &server.coachSocket) {
+                UdpAddress from;
+                std::ptrdiff_t len;
+                while ((len = server.coachSocket.receive(buf, sizeof(buf), &from)) > 0)
+                    handleCoach(server, std::string_view(buf, static_cast<std::size_t>(len)), from);
+                continue;
+            }
+            auto &p = *static_cast<MockPlayer *>(tag);
+            std::ptrdiff_t len;
+            while ((len = p.socket.receive(buf, sizeof(buf))) > 0)
+                handlePlayerCommands(server, p, std::string_view(buf, static_cast<std::size_t>(len)), monotonicNowNs());
+        }
+    }
+    double wallSeconds = static_cast<double>(monotonicNowNs() - startNs) / 1e9;
+
+    stopChildren(children);
+    if (server.csv)
+        std::fclose(server.csv);
+    close(timerFd);
+    close(epfd);
+
+    printReport(server, wallSeconds);
+    return 0;
+}
@@ -0,0 +1,168 @@
+#include "motion.h"
+#include "positions.h"
+#include <cmath>
+
+static constexpr double DEG = M_PI / 180.0;
+
+// El servidor mide los ángulos en sentido horario (eje y hacia abajo); el
+// convenio del equipo es antihorario con y hacia la banda superior, así que
+// todos los ángulos del servidor cambian de signo.
+
+// Grados dentro del borde del cono a partir de los que el balón proyectado debería verse
+static constexpr double BALL_CONE_MARGIN = 5.0;
+
+void MotionModel::configure(const ServerParams &server, const PlayerTypeParams &type)
+{
+    ballDecay_ = server.ballDecay;
+    type_ = type;
+}
+
+void MotionModel::onCommandSent(const Command &cmd)
+{
+    if (cmd.isBody())
+        pending_ = cmd;
+}
+
+double MotionModel::faceDir(const PlayerInfo &player)
+{
+    return player.dir_abs - player.sense.headAngle;
+}
+
+void MotionModel::onSee(PlayerInfo &player, bool poseValid)
+{
+    const SeeInfo &see = player.see;
+    if (poseValid) {
+        poseValid_ = true;
+        poseTime_ = see.time;
+    }
+
+    if (!poseValid_)
+        return;
+    if (!see.ball.visible) {
+        // Sin balón en el see: la proyección sigue valiendo si quedaba fuera del
+        // cono de visión; si debía verse y no está, es errónea
+        if (ball_.valid) {
+            double dx = ball_.pos.x - player.x_abs;
+            double dy = ball_.pos.y - player.y_abs;
+            double dir = normalizaAngulo(std::atan2(dy, dx) / DEG - faceDir(player));
+            if (std::fabs(dir) < viewHalfAngle(player.sense.viewWidth) - BALL_CONE_MARGIN)
+                ball_.valid = false;
+            refreshRelative(player);
+        }
+        return;
+    }
+
+    // Balón en coordenadas absolutas a partir de la pose recién observada
+    double a = (faceDir(player) - see.ball.dir) * DEG;
+    Point seen{player.x_abs + see.ball.dist * std::cos(a),
+               player.y_abs + see.ball.dist * std::sin(a)};
+
+    // Velocidad por diferencia entre dos avistamientos, deshaciendo el decaimiento:
+    // desplazamiento = v0 (1 - d^n) / (1 - d) y velocidad actual = v0 d^n
+    Point vel{};
+    int dt = see.time - ballSeenTime_;
+    if (ballSeenTime_ >= 0 && dt >= 1 && dt <= BALL_MAX_AGE) {
+        double dn = std::pow(ballDecay_, dt);
+        double k = (1.0 - ballDecay_) / (1.0 - dn) * dn;
+        vel = {(seen.x - ballSeen_.x) * k, (seen.y - ballSeen_.y) * k};
+    }
+
+    ball_ = BallEstimate{true, seen, vel, see.time, 0};
+    ballSeen_ = seen;
+    ballSeenTime_ = see.time;
+    player.ballVel = vel;
+}
+
+bool MotionModel::onSenseBody(PlayerInfo &player)
+{
+    const SenseInfo &sense = player.sense;
+    const CommandCounters &c = sense.counters;
+
+    // Los contadores confirman si el servidor ejecutó el comando pendiente
+    bool turned = c.turn > lastCounters_.turn && pending_.type == CommandType::Turn;
+    bool moved = c.move > lastCounters_.move && pending_.type == CommandType::Move;
+    bool kicked = c.kick > lastCounters_.kick;
+
+    if (poseValid_ && sense.time > poseTime_) {
+        // El see de este ciclo aún no ha llegado: proyectar la pose un ciclo
+        if (turned) {
+            double actual = pending_.a / (1.0 + type_.inertiaMoment * lastSpeed_);
+            player.dir_abs = static_cast<float>(normalizaAngulo(player.dir_abs - actual));
+        }
+
+        if (moved) {
+            // move usa coordenadas propias: nuestra mitad siempre con x negativa
+            double sx = (player.side == Side::Right) ? -1.0 : 1.0;
+            player.x_abs = static_cast<float>(sx * pending_.a);
+            player.y_abs = static_cast<float>(-sx * pending_.b);
+        } else {
+            // sense_body informa la velocidad ya decaída; el desplazamiento fue v / decay
+            double a = (faceDir(player) - sense.speedDir) * DEG;
+            double step = sense.speed / type_.playerDecay;
+            player.x_abs += static_cast<float>(step * std::cos(a));
+            player.y_abs += static_cast<float>(step * std::sin(a));
+        }
+        poseTime_ = sense.time;
+
+        if (ball_.valid) {
+            if (kicked) {
+                // Tras nuestro chute la velocidad del balón es desconocida hasta el próximo see
+                ball_.valid = false;
+            } else {
+                ball_.pos.x += ball_.vel.x;
+                ball_.pos.y += ball_.vel.y;
+                ball_.vel.x *= ballDecay_;
+                ball_.vel.y *= ballDecay_;
+                if (++ball_.age > BALL_MAX_AGE)
+                    ball_.valid = false;
+            }
+        }
+        refreshRelative(player);
+    }
+
+    pending_ = Command{};
+    lastCounters_ = c;
+    lastSpeed_ = sense.speed;
+    return poseValid_;
+}
+
+void MotionModel::onHear(PlayerInfo &player, int time)
+{
+    const HeardInfo &heard = player.heard;
+    int age = time - heard.ballTime;
+    if (heard.ballTime < 0 || age < 0 || age > BALL_MAX_AGE)
+        return;
+    if (ball_.valid && ball_.time >= heard.ballTime)
+        return;
+
+    double dn = std::pow(ballDecay_, age);
+    double travel = (1.0 - dn) / (1.0 - ballDecay_);
+    ball_ = BallEstimate{true,
+                         {heard.ballPos.x + heard.ballVel.x * travel, heard.ballPos.y + heard.ballVel.y * travel},
+                         {heard.ballVel.x * dn, heard.ballVel.y * dn},
+                         heard.ballTime,
+                         age};
+    if (poseValid_)
+        refreshRelative(player);
+}
+
+void MotionModel::refreshRelative(PlayerInfo &player) const
+{
+    SeeInfo &see = player.see;
+
+    // Las porterías vistas ya no son actuales: la decisión usa las coordenadas absolutas
+    see.ownGoal.visible = false;
+    see.oppGoal.visible = false;
+
+    if (!ball_.valid) {
+        see.ball = ObjectInfo{};
+        player.ballVel = {};
+        return;
+    }
+    player.ballVel = ball_.vel;
+
+    double dx = ball_.pos.x - player.x_abs;
+    double dy = ball_.pos.y - player.y_abs;
+    double absDir = std::atan2(dy, dx) / DEG;
+    see.ball = ObjectInfo{std::hypot(dx, dy), -normalizaAngulo(absDir - faceDir(player)), true};
+}
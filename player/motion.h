@@ -0,0 +1,68 @@
+#pragma once
+
+#include "types.h"
+#include "command.h"
+
+// Ciclos sin ver el balón durante los que se sigue confiando en su proyección
+inline constexpr int BALL_MAX_AGE = 5;
+
+// Balón en coordenadas absolutas del campo
+struct BallEstimate
+{
+    bool valid{false};
+    Point pos{};
+    Point vel{};
+    int time{-1};     // Último ciclo en el que se vio
+    int age{0};       // Ciclos proyectados desde entonces
+};
+
+// Estima a estima: entre dos see, proyecta la pose del jugador y el balón
+// con la velocidad de sense_body y los comandos que hemos enviado, de forma
+// que haya una estimación nueva en cada ciclo. Los decaimientos y la inercia
+// son los del server_param y del player_type del jugador (por defecto, los
+// del tipo 0 de rcssserver v19), los mismos que usa la intercepción.
+class MotionModel
+{
+public:
+    // Parámetros recibidos del servidor y tipo actual del jugador; se vuelve a
+    // llamar con cada server_param, con los player_type y con change_player_type
+    void configure(const ServerParams &server, const PlayerTypeParams &type);
+
+    const PlayerTypeParams &playerType() const { return type_; }
+
+    // Anota el comando de cuerpo enviado en este ciclo (se aplica en el siguiente sense_body)
+    void onCommandSent(const Command &cmd);
+
+    // Tras parsear un see y localizarse: fija la pose observada y actualiza el balón
+    void onSee(PlayerInfo &player, bool poseValid);
+
+    // Tras parsear un sense_body: aplica el comando pendiente y avanza un ciclo.
+    // Devuelve true si hay una pose estimada sobre la que decidir.
+    bool onSenseBody(PlayerInfo &player);
+
+    // Tras un hear: adopta el balón que cuenta un compañero si es más reciente
+    // que el propio (proyectado hasta time)
+    void onHear(PlayerInfo &player, int time);
+
+    bool hasPose() const { return poseValid_; }
+    const BallEstimate &ball() const { return ball_; }
+
+private:
+    // Dirección absoluta de la cara (cuerpo + cuello) en grados antihorarios
+    static double faceDir(const PlayerInfo &player);
+
+    // Reescribe player.see.ball y las porterías respecto a la pose proyectada
+    void refreshRelative(PlayerInfo &player) const;
+
+    Command pending_{};            // Comando de cuerpo enviado en el ciclo actual
+    double ballDecay_{ServerParams{}.ballDecay};
+    PlayerTypeParams type_{};
+
+    bool poseValid_{false};
+    int poseTime_{-1};             // Ciclo al que corresponde la pose actual
+    double lastSpeed_{0.0};        // Velocidad del ciclo anterior (reduce el giro efectivo)
+    CommandCounters lastCounters_{};
+    BallEstimate ball_{};
+    Point ballSeen_{};             // Última posición observada (no proyectada) del balón
+    int ballSeenTime_{-1};         // Ciclo de esa observación (el estimado puede venir de un compañero)
+};
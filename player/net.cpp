@@ -1,55 +1,308 @@
 #include "net.h"
-#include <iostream>
+#include "sexpr.h"
+#include "log.h"
+#include <arpa/inet.h>
+#include <cerrno>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
 
-std::string receiveMsgFromServer(MinimalSocket::udp::Udp<true> &udp_socket, std::size_t message_max_size)
+UdpAddress UdpAddress::make(const char *host, std::uint16_t port)
 {
-    auto received_message = udp_socket.receive(message_max_size);
+    UdpAddress addr;
+    in_addr in{};
+    if (inet_pton(AF_INET, host, &in) == 1)
+        addr.ip = in.s_addr;
+    addr.port = port;
+    return addr;
+}
+
+static sockaddr_in toSockaddr(const UdpAddress &addr)
+{
+    sockaddr_in sa{};
+    sa.sin_family = AF_INET;
+    sa.sin_addr.s_addr = addr.ip;
+    sa.sin_port = htons(addr.port);
+    return sa;
+}
+
+UdpSocket::~UdpSocket()
+{
+    close();
+}
+
+UdpSocket::UdpSocket(UdpSocket &&other) noexcept : fd_(other.fd_)
+{
+    other.fd_ = -1;
+}
 
-    if (!received_message) {
-        std::cerr << "Error receiving message from server" << std::endl;
-        return "";
+UdpSocket &UdpSocket::operator=(UdpSocket &&other) noexcept
+{
+    if (this != &other) {
+        close();
+        fd_ = other.fd_;
+        other.fd_ = -1;
     }
+    return *this;
+}
+
+bool UdpSocket::open(std::uint16_t local_port)
+{
+    close();
+
+    fd_ = ::socket(AF_INET, SOCK_DGRAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (fd_ < 0)
+        return false;
 
-    std::string received_message_content = received_message->received_message;
-    // std::cout << "Received message: " << received_message_content << std::endl;
+    sockaddr_in sa = toSockaddr(UdpAddress{htonl(INADDR_ANY), local_port});
+    if (::bind(fd_, reinterpret_cast<sockaddr *>(&sa), sizeof(sa)) < 0) {
+        close();
+        return false;
+    }
+    return true;
+}
 
-    return received_message_content;
+void UdpSocket::close()
+{
+    if (fd_ >= 0) {
+        ::close(fd_);
+        fd_ = -1;
+    }
 }
 
-void sendCommand(MinimalSocket::udp::Udp<true> &udp_socket, const MinimalSocket::Address &server_udp, const std::string &cmd)
+std::uint16_t UdpSocket::localPort() const
 {
-    udp_socket.sendTo(cmd + '\0', server_udp);
+    sockaddr_in sa{};
+    socklen_t len = sizeof(sa);
+    if (fd_ < 0 || ::getsockname(fd_, reinterpret_cast<sockaddr *>(&sa), &len) < 0)
+        return 0;
+    return ntohs(sa.sin_port);
 }
 
-void sendInitCommand(MinimalSocket::udp::Udp<true> &udp_socket, const MinimalSocket::Address &server_udp, MinimalSocket::Port this_socket_port, std::string team_name)
+bool UdpSocket::sendTo(std::string_view data, const UdpAddress &to)
+{
+    sockaddr_in sa = toSockaddr(to);
+    ssize_t sent = ::sendto(fd_, data.data(), data.size(), 0,
+                            reinterpret_cast<sockaddr *>(&sa), sizeof(sa));
+    return sent == static_cast<ssize_t>(data.size());
+}
+
+std::ptrdiff_t UdpSocket::receive(char *buf, std::size_t capacity, UdpAddress *from)
+{
+    sockaddr_in sa{};
+    socklen_t len = sizeof(sa);
+    ssize_t n = ::recvfrom(fd_, buf, capacity, 0, reinterpret_cast<sockaddr *>(&sa), &len);
+    if (n < 0)
+        return (errno == EAGAIN || errno == EWOULDBLOCK) ? 0 : -1;
+
+    if (from) {
+        from->ip = sa.sin_addr.s_addr;
+        from->port = ntohs(sa.sin_port);
+    }
+    return n;
+}
+
+ServerMsgKind classifyServerMsg(std::string_view msg, int *sender)
+{
+    if (sender)
+        *sender = 0;
+    if (msg.rfind("(see ", 0) == 0)
+        return ServerMsgKind::See;
+    if (msg.rfind("(sense_body", 0) == 0)
+        return ServerMsgKind::SenseBody;
+    if (msg.rfind("(hear ", 0) != 0)
+        return ServerMsgKind::Other;
+
+    // (hear TIME referee ...), (hear TIME self ...), (hear TIME online_coach_left ...)
+    // o (hear TIME DIR our|opp ...)
+    SExprCursor cur(msg.substr(6));
+    int time = 0;
+    cur.number(time);
+    std::string_view from = cur.atom();
+    if (from == "referee")
+        return ServerMsgKind::Other;
+    if (from == "self")
+        return ServerMsgKind::HearSelf;
+    if (from.rfind("online_coach", 0) == 0 || from == "coach") {
+        if (sender)
+            *sender = from == "online_coach_right" ? 1 : 0;
+        return ServerMsgKind::HearCoach;
+    }
+
+    std::string_view team = cur.atom();
+    if (team == "our") {
+        if (sender)
+            cur.number(*sender);
+        return ServerMsgKind::HearOur;
+    }
+    if (team == "opp")
+        return ServerMsgKind::HearOpp;
+    return ServerMsgKind::Other;
+}
+
+std::uint64_t ReceiveStats::totalDropped() const
+{
+    std::uint64_t total = 0;
+    for (auto d : dropped) total += d;
+    return total;
+}
+
+ServerReceiver::ServerReceiver()
+{
+    const std::size_t slots = RECV_BATCH_SIZE * RECV_MAX_BATCHES;
+    buffers_.reserve(RECV_MAX_BATCHES);
+    headers_.reserve(slots);
+    iovecs_.reserve(slots);
+    addrs_.reserve(slots);
+    keep_.reserve(slots);
+    grow();
+}
+
+void ServerReceiver::grow()
+{
+    char *base = buffers_.emplace_back(new char[RECV_BATCH_SIZE * SERVER_MSG_MAX_SIZE]).get();
+    for (std::size_t i = 0; i < RECV_BATCH_SIZE; ++i) {
+        iovecs_.push_back(iovec{base + i * SERVER_MSG_MAX_SIZE, SERVER_MSG_MAX_SIZE});
+        headers_.emplace_back();
+        addrs_.emplace_back();
+        keep_.push_back(0);
+    }
+}
+
+std::size_t ServerReceiver::receiveAll(UdpSocket &socket, bool &more)
+{
+    std::size_t n = 0;
+    more = false;
+    for (std::size_t batch = 0; batch < RECV_MAX_BATCHES; ++batch) {
+        if (batch == buffers_.size())
+            grow();
+        const std::size_t first = batch * RECV_BATCH_SIZE;
+        for (std::size_t i = first; i < first + RECV_BATCH_SIZE; ++i) {
+            headers_[i].msg_hdr = msghdr{};
+            headers_[i].msg_hdr.msg_iov = &iovecs_[i];
+            headers_[i].msg_hdr.msg_iovlen = 1;
+            headers_[i].msg_hdr.msg_name = &addrs_[i];
+            headers_[i].msg_hdr.msg_namelen = sizeof(sockaddr_in);
+            headers_[i].msg_len = 0;
+        }
+
+        int got = ::recvmmsg(socket.fd(), headers_.data() + first, RECV_BATCH_SIZE, MSG_DONTWAIT, nullptr);
+        if (got <= 0)
+            break;
+        n += static_cast<std::size_t>(got);
+        ++stats_.batches;
+        // Lote incompleto: la cola del socket está vacía
+        if (static_cast<std::size_t>(got) < RECV_BATCH_SIZE)
+            break;
+        more = batch + 1 == RECV_MAX_BATCHES;
+    }
+    stats_.datagrams += n;
+
+    // Recorrer del más nuevo al más viejo de todo el vaciado: el primero de
+    // cada (tipo, emisor) se queda. Los dorsales van de 1 a 11; el 0 es el
+    // emisor de los tipos sin dorsal.
+    constexpr std::size_t SENDERS = 12;
+    std::array<std::array<bool, SENDERS>, static_cast<std::size_t>(ServerMsgKind::Count)> seen{};
+    for (std::size_t i = n; i-- > 0;) {
+        int sender = 0;
+        ServerMsgKind kind = classifyServerMsg(message(i), &sender);
+        auto k = static_cast<std::size_t>(kind);
+        auto from = static_cast<std::size_t>(sender >= 0 && sender < static_cast<int>(SENDERS) ? sender : 0);
+        if (kind == ServerMsgKind::Other || kind == ServerMsgKind::SenseBody || !seen[k][from]) {
+            keep_[i] = 1;
+            seen[k][from] = true;
+        } else {
+            keep_[i] = 0;
+            ++stats_.dropped[k];
+        }
+    }
+    return n;
+}
+
+std::string_view ServerReceiver::message(std::size_t i) const
+{
+    std::size_t len = headers_[i].msg_len;
+    const char *data = static_cast<const char *>(iovecs_[i].iov_base);
+    // El servidor termina los mensajes con '\0'
+    while (len > 0 && data[len - 1] == '\0') --len;
+    return std::string_view(data, len);
+}
+
+UdpAddress ServerReceiver::sender(std::size_t i) const
+{
+    return UdpAddress{addrs_[i].sin_addr.s_addr, ntohs(addrs_[i].sin_port)};
+}
+
+// El servidor espera el comando terminado en '\0' (incluido en el datagrama)
+void sendCommand(UdpSocket &udp_socket, const UdpAddress &server_udp, const std::string &cmd)
+{
+    udp_socket.sendTo(std::string_view(cmd.c_str(), cmd.size() + 1), server_udp);
+}
+
+void sendInitCommand(UdpSocket &udp_socket, const UdpAddress &server_udp, const std::string &team_name, bool goalie)
 {
     std::string init_msg;
 
-    if (this_socket_port == 7001 || this_socket_port == 8001) {
+    if (goalie) {
         init_msg = "(init " + team_name + " (version 19) (goalie))";
     } else {
         init_msg = "(init " + team_name + " (version 19))";
     }
 
-    std::cout << "Sending init message: " << init_msg << std::endl;
+    LOG_INFO("Sending init message: {}", init_msg);
     sendCommand(udp_socket, server_udp, init_msg);
-    std::cout << "Init message sent" << std::endl;
 }
 
-void sendMoveCommand(MinimalSocket::udp::Udp<true> &udp_socket, const MinimalSocket::Address &server_udp, PlayerInfo &player)
+void sendMoveCommand(UdpSocket &udp_socket, const UdpAddress &server_udp, PlayerInfo &player)
+{
+    CommandFrame frame;
+    frame.body = Command::move(player.initialPosition.x, player.initialPosition.y);
+    sendCommandFrame(udp_socket, server_udp, frame);
+}
+
+void sendSynchSeeCommand(UdpSocket &udp_socket, const UdpAddress &server_udp)
 {
-    std::string move_cmd =
-        "(move " + std::to_string(player.initialPosition.x) +
-        " "      + std::to_string(player.initialPosition.y) + ")";
+    static constexpr std::string_view SYNCH_SEE{"(synch_see)", sizeof("(synch_see)")};
+    udp_socket.sendTo(SYNCH_SEE, server_udp);
+}
 
-    std::cout << "Sending move command: " << move_cmd << std::endl;
-    sendCommand(udp_socket, server_udp, move_cmd);
-    std::cout << "Move command sent" << std::endl;
+void sendDoneCommand(UdpSocket &udp_socket, const UdpAddress &server_udp)
+{
+    // Cada ciclo: literal con su '\0', sin construir cadenas
+    static constexpr std::string_view DONE{"(done)", sizeof("(done)")};
+    udp_socket.sendTo(DONE, server_udp);
 }
 
-void sendActionCommand(MinimalSocket::udp::Udp<true> &udp_socket, const MinimalSocket::Address &server_udp, const std::string &action_cmd) 
+bool sendCommandFrame(UdpSocket &udp_socket, const UdpAddress &server_udp, const CommandFrame &frame)
 {
-    std::cout << "Sending action command: " << action_cmd << std::endl;
-    sendCommand(udp_socket, server_udp, action_cmd);
-    std::cout << "Action command sent" << std::endl;
-}
\ No newline at end of file
+    char buf[COMMAND_MAX_SIZE];
+    std::size_t n = frame.serialize(buf, sizeof(buf) - 1);
+    if (n == 0)
+        return false;
+    buf[n] = '\0';
+
+    LOG_DEBUG("Sending commands: {}", std::string_view(buf, n));
+    return udp_socket.sendTo(std::string_view(buf, n + 1), server_udp);
+}
+
+void sendCoachInitCommand(UdpSocket &udp_socket, const UdpAddress &server_udp, const std::string &team_name)
+{
+    std::string init_msg = "(init " + team_name + " (version 19))";
+    LOG_INFO("Sending coach init message: {}", init_msg);
+    sendCommand(udp_socket, server_udp, init_msg);
+}
+
+void sendEyeOnCommand(UdpSocket &udp_socket, const UdpAddress &server_udp)
+{
+    static constexpr std::string_view EYE_ON{"(eye on)", sizeof("(eye on)")};
+    udp_socket.sendTo(EYE_ON, server_udp);
+}
+
+void sendCoachSayCommand(UdpSocket &udp_socket, const UdpAddress &server_udp, std::string_view text)
+{
+    std::string msg = "(say (freeform \"";
+    msg.append(text);
+    msg += "\"))";
+    sendCommand(udp_socket, server_udp, msg);
+}
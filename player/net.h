@@ -1,17 +1,177 @@
 #pragma once
 
 #include "types.h"
-#include <MinimalSocket/udp/UdpSocket.h>
+#include "command.h"
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <netinet/in.h>
+#include <sys/socket.h>
 
-// Recibe un mensaje del servidor a través del socket UDP
-std::string receiveMsgFromServer(MinimalSocket::udp::Udp<true> &udp_socket, std::size_t message_max_size);
+// Tamaño máximo de un datagrama del servidor (MaxMesg en rcssserver).
+// Un see con todo el campo a la vista ocupa 2-4 KB.
+inline constexpr std::size_t SERVER_MSG_MAX_SIZE = 8192;
 
-// Envía el comando de inicialización al servidor
-// Los puertos 7001 y 8001 se asignan como porteros
-void sendInitCommand(MinimalSocket::udp::Udp<true> &udp_socket, const MinimalSocket::Address &server_udp, MinimalSocket::Port this_socket_port, std::string team_name);
+// Datagramas recogidos por cada llamada a recvmmsg
+inline constexpr std::size_t RECV_BATCH_SIZE = 16;
+
+// Datagramas que se acumulan como mucho antes de entregar (y de elegir los
+// vigentes). El búfer crece por lotes hasta aquí y se reutiliza.
+inline constexpr std::size_t RECV_MAX_BATCHES = 16;
+
+// Dirección UDP IPv4 (ip en orden de red, puerto en orden de host)
+struct UdpAddress
+{
+    std::uint32_t ip{0};
+    std::uint16_t port{0};
+
+    // Construye la dirección a partir de una IP en texto, ej: "127.0.0.1"
+    static UdpAddress make(const char *host, std::uint16_t port);
+};
+
+// Socket UDP no bloqueante sobre la API POSIX.
+// Expone el descriptor para poder registrarlo en epoll.
+class UdpSocket
+{
+public:
+    UdpSocket() = default;
+    ~UdpSocket();
+
+    UdpSocket(const UdpSocket &) = delete;
+    UdpSocket &operator=(const UdpSocket &) = delete;
+    UdpSocket(UdpSocket &&other) noexcept;
+    UdpSocket &operator=(UdpSocket &&other) noexcept;
+
+    // Abre el socket y lo asocia al puerto local indicado (0 = cualquiera)
+    bool open(std::uint16_t local_port);
+    void close();
+
+    int fd() const { return fd_; }
+    bool isOpen() const { return fd_ >= 0; }
+
+    // Puerto local al que está asociado el socket (0 si no está abierto)
+    std::uint16_t localPort() const;
+
+    // Envía un datagrama; devuelve false si el envío falla
+    bool sendTo(std::string_view data, const UdpAddress &to);
+
+    // Recibe un datagrama en buf. Devuelve el número de bytes, 0 si no hay
+    // datos pendientes, o -1 en caso de error.
+    std::ptrdiff_t receive(char *buf, std::size_t capacity, UdpAddress *from = nullptr);
+
+private:
+    int fd_{-1};
+};
+
+// Tipo de mensaje del servidor, a efectos de quedarse sólo con el más reciente
+enum class ServerMsgKind
+{
+    See,
+    SenseBody,  // nunca se descarta: cada uno abre un ciclo en CycleClock y en las métricas
+    HearSelf, HearOur, HearOpp, HearCoach,
+    Other,      // init, hear del árbitro, server_param, error... nunca se descartan
+    Count
+};
+
+// Clasifica un mensaje por su cabecera, ej: (hear 10 -30 our 7 "...") -> HearOur.
+// Si sender no es nulo recibe el emisor dentro del tipo: el dorsal en
+// HearOur, 0 (izquierdo) o 1 (derecho) en HearCoach, 0 en el resto.
+ServerMsgKind classifyServerMsg(std::string_view msg, int *sender = nullptr);
+
+// Contadores de la capa de recepción
+struct ReceiveStats
+{
+    std::uint64_t datagrams{0};   // datagramas recibidos
+    std::uint64_t batches{0};     // llamadas a recvmmsg con datos
+    std::array<std::uint64_t, static_cast<std::size_t>(ServerMsgKind::Count)> dropped{}; // obsoletos descartados por tipo
+
+    std::uint64_t totalDropped() const;
+};
+
+// Capa de recepción con búfer reutilizado: vacía todos los datagramas
+// pendientes con recvmmsg (lote a lote, hasta RECV_MAX_BATCHES) y sólo
+// entonces entrega, en orden de llegada y sin copias, el see más reciente, el
+// hear más reciente de cada emisor (cada compañero por su dorsal) y todos los
+// demás mensajes, sense_body incluidos. Los obsoletos de todo el vaciado se
+// cuentan en ReceiveStats::dropped.
+class ServerReceiver
+{
+public:
+    ServerReceiver();
+
+    ServerReceiver(const ServerReceiver &) = delete;
+    ServerReceiver &operator=(const ServerReceiver &) = delete;
+    ServerReceiver(ServerReceiver &&) = default;
+    ServerReceiver &operator=(ServerReceiver &&) = default;
+
+    // Vacía el socket y llama a handler(msg, sender) con cada mensaje vigente.
+    // Devuelve el número de datagramas leídos.
+    template <typename Handler>
+    std::size_t drain(UdpSocket &socket, Handler &&handler)
+    {
+        std::size_t total = 0;
+        while (true) {
+            bool more = false;
+            std::size_t n = receiveAll(socket, more);
+            total += n;
+            for (std::size_t i = 0; i < n; ++i) {
+                if (keep_[i])
+                    handler(message(i), sender(i));
+            }
+            // Sólo se vuelve a leer si se llegó al tope con datos aún en cola
+            if (!more)
+                break;
+        }
+        return total;
+    }
+
+    const ReceiveStats &stats() const { return stats_; }
+
+private:
+    // Lee lotes hasta vaciar la cola o llenar RECV_MAX_BATCHES (more = true) y
+    // marca cuáles se entregan; devuelve el número de datagramas leídos
+    std::size_t receiveAll(UdpSocket &socket, bool &more);
+
+    // Añade un lote de RECV_BATCH_SIZE huecos
+    void grow();
+
+    std::string_view message(std::size_t i) const;
+    UdpAddress sender(std::size_t i) const;
+
+    // Un bloque de RECV_BATCH_SIZE * SERVER_MSG_MAX_SIZE bytes por lote; el
+    // primero se reserva al construir y el resto al primer vaciado que lo necesite
+    std::vector<std::unique_ptr<char[]>> buffers_;
+    std::vector<mmsghdr> headers_;
+    std::vector<iovec> iovecs_;
+    std::vector<sockaddr_in> addrs_;
+    std::vector<std::uint8_t> keep_;
+    ReceiveStats stats_{};
+};
+
+// Envía el comando de inicialización al servidor, como portero si goalie
+void sendInitCommand(UdpSocket &udp_socket, const UdpAddress &server_udp, const std::string &team_name, bool goalie);
 
 // Envía el comando para posicionar al jugador en su ubicación inicial
-void sendMoveCommand(MinimalSocket::udp::Udp<true> &udp_socket, const MinimalSocket::Address &server_udp, PlayerInfo &player);
+void sendMoveCommand(UdpSocket &udp_socket, const UdpAddress &server_udp, PlayerInfo &player);
+
+// Modo síncrono: pide que los see lleguen alineados con el ciclo
+void sendSynchSeeCommand(UdpSocket &udp_socket, const UdpAddress &server_udp);
+
+// Modo síncrono: fin de la fase de decisión del ciclo
+void sendDoneCommand(UdpSocket &udp_socket, const UdpAddress &server_udp);
+
+// Envía los comandos del ciclo en un único datagrama, serializados en la pila
+bool sendCommandFrame(UdpSocket &udp_socket, const UdpAddress &server_udp, const CommandFrame &frame);
+
+// Entrenador en línea: (init TEAM (version 19)) en el puerto del entrenador
+void sendCoachInitCommand(UdpSocket &udp_socket, const UdpAddress &server_udp, const std::string &team_name);
+
+// Entrenador: pide el see_global de todos los ciclos
+void sendEyeOnCommand(UdpSocket &udp_socket, const UdpAddress &server_udp);
 
-// Envía el comando de acción decidido al servidor
-void sendActionCommand(MinimalSocket::udp::Udp<true> &udp_socket, const MinimalSocket::Address &server_udp, const std::string &action_cmd);
\ No newline at end of file
+// Entrenador: (say (freeform "text")) para los jugadores del equipo
+void sendCoachSayCommand(UdpSocket &udp_socket, const UdpAddress &server_udp, std::string_view text);
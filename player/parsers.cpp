@@ -1,255 +1,442 @@
 #include "parsers.h"
+#include "sexpr.h"
+#include "log.h"
+#include "referee.h"
+#include "comm.h"
+#include "coach.h"
 #include <cmath>
-#include <sstream>
 
-void skipDelims(std::string_view& sv)
+void parseInitMsg(std::string_view msg, PlayerInfo &player, GameState &gameState)
 {
-    const char* delims = " ()";
-    size_t pos = sv.find_first_not_of(delims);
-    if (pos == std::string_view::npos) {
-        sv = {};
-    } else {
-        sv.remove_prefix(pos);
-    }
+    SExprCursor cur(msg);
+
+    cur.consume('(');
+    cur.atom(); // Saltar "init"
+
+    auto sideTok = cur.atom();
+    if (sideTok == "l")
+        player.side = Side::Left;
+    else if (sideTok == "r")
+        player.side = Side::Right;
+    else
+        player.side = Side::Unknown;
+
+    player.number = toInt(cur.atom(), -1);
+
+    auto playModeTok = cur.atom();
+    applyReferee(decodeReferee(playModeTok, player.side), player.side, gameState);
+
+    auto position = calcKickOffPosition(player.number);
+    player.initialPosition = position;
 }
 
-std::string_view nextToken(std::string_view& sv)
+// Lee hasta maxNums números tras el nombre de un objeto y consume su ')'.
+// Los marcadores no numéricos ('t' de tackle, 'k' de kick, 'y'/'r' de
+// tarjeta) se devuelven en markers como bits SEEN_*.
+static int readObjectNumbers(SExprCursor &cur, double *nums, int maxNums, std::uint8_t &markers)
 {
-    skipDelims(sv);
-    if (sv.empty()) return {};
-
-    size_t end = sv.find_first_of(" ()");
-    std::string_view tok = sv.substr(0, end);
-    if (end == std::string_view::npos) {
-        sv = {};
-    } else {
-        sv.remove_prefix(end);
+    markers = SEEN_NONE;
+    int n = 0;
+    while (true) {
+        char c = cur.peek();
+        if (c == ')' || c == '\0') break;
+        if (c == '(') { // sublista inesperada: la saltamos
+            ++cur.p;
+            cur.skipList();
+            continue;
+        }
+        double v = 0.0;
+        if (cur.number(v)) {
+            if (n < maxNums) nums[n++] = v;
+        } else {
+            auto tok = cur.atom();
+            if (tok == "t")                     markers |= SEEN_TACKLING;
+            else if (tok == "k")                markers |= SEEN_KICKING;
+            else if (tok == "y" || tok == "r")  markers |= SEEN_CARD;
+        }
     }
-    return tok;
+    cur.consume(')');
+    return n;
 }
 
-bool parseObjectInfo(std::string_view msg, std::string_view objectTag, ObjectInfo& out)
+// Añade un jugador visto a partir del nombre (ej: p "RealSuciedad" 7 goalie)
+// y de los números que le siguen: dist dir [point] o dist dir distChg dirChg body head [point]
+static void addSeenPlayer(std::string_view name, std::string_view ownTeam, const double *nums, int n,
+                          std::uint8_t markers, SeenPlayers &out)
 {
-    size_t pos = msg.find(objectTag);
-    if (pos == std::string_view::npos) {
-        out = ObjectInfo{};
-        return false;
+    std::size_t i = out.size++;
+    SExprCursor cur(name);
+    cur.atom(); // 'p' o 'P'
+
+    std::uint8_t fields = markers;
+    out.team[i] = TeamSide::Unknown;
+    out.number[i] = -1;
+    if (!cur.atEnd()) {
+        auto teamTok = cur.atom();
+        if (!teamTok.empty())
+            out.team[i] = (teamTok == ownTeam) ? TeamSide::Own : TeamSide::Opp;
+
+        auto numTok = cur.atom();
+        if (!numTok.empty())
+            out.number[i] = static_cast<std::int8_t>(toInt(numTok, -1));
+
+        if (cur.atom() == "goalie")
+            fields |= SEEN_GOALIE;
     }
 
-    std::string_view sv = msg.substr(pos + objectTag.size());
-
-    // Extraer distancia y dirección
-    auto distTok = nextToken(sv);
-    auto dirTok  = nextToken(sv);
-
-    if (distTok.empty() || dirTok.empty()) {
-        out.visible = false;
-        return false;
+    out.dist[i] = nums[0];
+    out.dir[i] = nums[1];
+    out.distChange[i] = out.dirChange[i] = 0.0;
+    out.bodyDir[i] = out.headDir[i] = out.pointDir[i] = 0.0;
+    if (n == 3) {
+        // Jugador lejano que señala: sólo llega la dirección del brazo
+        fields |= SEEN_POINTING;
+        out.pointDir[i] = nums[2];
     }
-
-    out.dist = std::stod(std::string(distTok));
-    out.dir  = std::stod(std::string(dirTok));
-    out.visible = true;
-    return true;
+    if (n >= 4) {
+        fields |= SEEN_CHANGE;
+        out.distChange[i] = nums[2];
+        out.dirChange[i] = nums[3];
+    }
+    if (n >= 6) {
+        fields |= SEEN_FACING;
+        out.bodyDir[i] = nums[4];
+        out.headDir[i] = nums[5];
+    }
+    if (n >= 7) {
+        fields |= SEEN_POINTING;
+        out.pointDir[i] = nums[6];
+    }
+    out.fields[i] = fields;
 }
 
-PlayMode mapRefereeTokenToPlayMode(std::string_view tok)
+void parseSeeMsg(std::string_view msg, PlayerInfo &player)
 {
-    std::cout << "[DEBUG] Mapping referee token to PlayMode: " << tok << std::endl;
-
-    if (tok == "before_kick_off")           return PlayMode::BeforeKickOff;
-    if (tok == "play_on")                   return PlayMode::PlayOn;
+    SeeInfo &see = player.see;
+    see.ball = ObjectInfo{};
+    see.ownGoal = ObjectInfo{};
+    see.oppGoal = ObjectInfo{};
+    see.numFlags = 0;
+    see.numLines = 0;
+    see.players.clear();
+
+    SExprCursor cur(msg);
+    if (!cur.consume('(') || cur.atom() != "see")
+        return;
 
-    if (tok == "kick_off_l")                return PlayMode::KickOff_Left;
-    if (tok == "kick_off_r")                return PlayMode::KickOff_Right;
+    cur.number(see.time);
 
-    if (tok == "kick_in_l")                 return PlayMode::KickIn_Left;
-    if (tok == "kick_in_r")                 return PlayMode::KickIn_Right;
+    // Recorrido único: ((nombre) dist dir [distChg dirChg [body head [point]]] [t|k])
+    while (cur.consume('(')) {
+        if (!cur.consume('(')) { // objeto sin nombre: lo saltamos
+            cur.skipList();
+            continue;
+        }
+        std::string_view name = cur.untilClose();
+
+        double nums[8];
+        std::uint8_t markers;
+        int n = readObjectNumbers(cur, nums, 8, markers);
+        if (name.empty() || n < 2)
+            continue;
+
+        switch (name[0]) {
+            case 'b': // Balón
+                see.ball = ObjectInfo{nums[0], nums[1], true, n >= 4, n >= 4 ? nums[2] : 0.0, n >= 4 ? nums[3] : 0.0};
+                break;
+
+            case 'g': // Portería: "g l" o "g r" (también sirve como marca para localizarse)
+                if (name.size() >= 3 && player.side != Side::Unknown) {
+                    // Nuestra portería es la de nuestro lado: g l si jugamos por la izquierda
+                    bool ours = (name[2] == 'l') == (player.side == Side::Left);
+                    (ours ? see.ownGoal : see.oppGoal) = ObjectInfo{nums[0], nums[1], true};
+                }
+                [[fallthrough]];
+
+            case 'f': { // Bandera: sólo las que tienen posición conocida
+                if (see.numFlags >= SeeInfo::MAX_FLAGS) break;
+                FlagId id = lookupFlag(name);
+                if (id == FLAG_NONE) break;
+                see.flags[see.numFlags++] = FlagInfo{id, nums[0], nums[1], true, flagPosition(id)};
+                break;
+            }
 
-    if (tok == "corner_kick_l")             return PlayMode::Corner_Left;
-    if (tok == "corner_kick_r")             return PlayMode::Corner_Right;
+            case 'l': // Línea: "l l", "l r", "l t" o "l b"
+                if (see.numLines < SeeInfo::MAX_LINES && name.size() >= 3)
+                    see.lines[see.numLines++] = LineInfo{name[2], nums[0], nums[1]};
+                break;
 
-    if (tok == "goal_kick_l")               return PlayMode::GoalKick_Left;
-    if (tok == "goal_kick_r")               return PlayMode::GoalKick_Right;
+            case 'p':
+            case 'P':
+                if (!see.players.full())
+                    addSeenPlayer(name, player.team, nums, n, markers, see.players);
+                break;
 
-    if (tok.compare(0, 6, "goal_l") == 0)   return PlayMode::Goal_Left;
-    if (tok.compare(0, 6, "goal_r") == 0)   return PlayMode::Goal_Right;
+            default: // Objetos cercanos sin identificar (B, F, G)
+                break;
+        }
+    }
+}
 
-    if(tok == "free_kick_l")               return PlayMode::FreeKick_Left;
-    if(tok == "free_kick_r")               return PlayMode::FreeKick_Right;
+// Contador de comandos al que corresponde una clave de sense_body, o nullptr
+static int *commandCounter(std::string_view key, CommandCounters &c)
+{
+    if (key == "kick")          return &c.kick;
+    if (key == "dash")          return &c.dash;
+    if (key == "turn")          return &c.turn;
+    if (key == "say")           return &c.say;
+    if (key == "turn_neck")     return &c.turnNeck;
+    if (key == "catch")         return &c.catch_;
+    if (key == "move")          return &c.move;
+    if (key == "change_view")   return &c.changeView;
+    if (key == "change_focus")  return &c.changeFocus;
+    return nullptr;
+}
 
-    if(tok == "penalty_kick_l")            return PlayMode::PenaltyKick_Left;
-    if(tok == "penalty_kick_r")            return PlayMode::PenaltyKick_Right;
+// (arm (movable M) (expires E) (target D A) (count C))
+static void parseArm(SExprCursor &cur, ArmInfo &arm)
+{
+    while (cur.consume('(')) {
+        auto key = cur.atom();
+        if (key == "movable")       cur.number(arm.movable);
+        else if (key == "expires")  cur.number(arm.expires);
+        else if (key == "count")    cur.number(arm.count);
+        else if (key == "target") {
+            cur.number(arm.targetDist);
+            cur.number(arm.targetDir);
+        }
+        cur.skipList();
+    }
+}
 
-    return PlayMode::Unknown;
+// (focus (target none|l 7) (count C))
+static void parseFocus(SExprCursor &cur, FocusInfo &focus)
+{
+    while (cur.consume('(')) {
+        auto key = cur.atom();
+        if (key == "target") {
+            auto side = cur.atom();
+            focus.side = (side == "l" || side == "r") ? side[0] : '\0';
+            focus.number = -1;
+            if (focus.side != '\0')
+                cur.number(focus.number);
+        } else if (key == "count") {
+            cur.number(focus.count);
+        }
+        cur.skipList();
+    }
 }
 
-// Actualiza marcador a partir de tokens tipo goal_l_1 / goal_r_2
-void updateScoreFromGoalToken(std::string_view tok, GameState &game)
+// (collision none) o (collision (ball) (player) (post))
+static std::uint8_t parseCollision(SExprCursor &cur)
 {
-    // Formato esperado: goal_l_3 o goal_r_1
-    if (tok.compare(0, 5, "goal_") != 0)
-        return;
+    std::uint8_t flags = COLLISION_NONE;
+    while (cur.consume('(')) {
+        auto what = cur.atom();
+        if (what == "ball")         flags |= COLLISION_BALL;
+        else if (what == "player")  flags |= COLLISION_PLAYER;
+        else if (what == "post")    flags |= COLLISION_POST;
+        cur.skipList();
+    }
+    return flags;
+}
 
-    if (tok.size() < 7) // mínimo: g o a l _ x _ n
-        return;
+void parseSenseMsg(std::string_view msg, PlayerInfo &player)
+{
+    SenseInfo &sense = player.sense;
 
-    char sideChar = tok[5]; // 'l' o 'r'
-    if (tok[6] != '_')
+    SExprCursor cur(msg);
+    if (!cur.consume('(') || cur.atom() != "sense_body")
         return;
 
-    std::string_view numStr = tok.substr(7); // "3", "10", etc.
-    int goalNumber = 0;
-    try {
-        goalNumber = std::stoi(std::string(numStr));
-    } catch (...) {
-        return;
+    cur.number(sense.time);
+    sense.collision = COLLISION_NONE;
+
+    // Recorrido único: (clave valores...) con sublistas en arm, focus, tackle, collision y foul.
+    // Cada entrada se cierra con skipList, que tolera campos de versiones más nuevas.
+    while (cur.consume('(')) {
+        auto key = cur.atom();
+
+        if (int *counter = commandCounter(key, sense.counters)) {
+            cur.number(*counter);
+        } else if (key == "view_mode") {
+            sense.viewQuality = (cur.atom() == "low") ? ViewQuality::Low : ViewQuality::High;
+            auto width = cur.atom();
+            sense.viewWidth = width == "narrow" ? ViewWidth::Narrow
+                            : width == "wide"   ? ViewWidth::Wide
+                                                : ViewWidth::Normal;
+        } else if (key == "stamina") {
+            cur.number(sense.stamina);
+            cur.number(sense.effort);
+            cur.number(sense.capacity);
+        } else if (key == "speed") {
+            cur.number(sense.speed);
+            cur.number(sense.speedDir);
+        } else if (key == "head_angle") {
+            cur.number(sense.headAngle);
+        } else if (key == "arm") {
+            parseArm(cur, sense.arm);
+        } else if (key == "focus") {
+            parseFocus(cur, sense.focus);
+        } else if (key == "tackle") {
+            while (cur.consume('(')) {
+                auto sub = cur.atom();
+                if (sub == "expires")       cur.number(sense.tackleExpires);
+                else if (sub == "count")    cur.number(sense.tackleCount);
+                cur.skipList();
+            }
+        } else if (key == "collision") {
+            sense.collision = parseCollision(cur);
+        } else if (key == "foul") {
+            while (cur.consume('(')) {
+                auto sub = cur.atom();
+                if (sub == "charged") {
+                    cur.number(sense.foulCharged);
+                } else if (sub == "card") {
+                    auto card = cur.atom();
+                    sense.card = (card == "yellow") ? 'y' : (card == "red") ? 'r' : 'n';
+                }
+                cur.skipList();
+            }
+        }
+        cur.skipList();
     }
-
-    if (sideChar == 'l')
-        game.scoreLeft = goalNumber;
-    else if (sideChar == 'r')
-        game.scoreRight = goalNumber;
 }
 
-void parseInitMsg(const std::string &msg, PlayerInfo &player, GameState &gameState)
+void parseHearMsg(std::string_view msg, PlayerInfo &player, GameState &gameState)
 {
-    std::string_view sv = msg;
-
-    nextToken(sv); // Saltar "(init"
-
-    auto sideTok = nextToken(sv);
-    if (sideTok == "l")
-        player.side = Side::Left;
-    else if (sideTok == "r")
-        player.side = Side::Right;
-    else
-        player.side = Side::Unknown;
+    SExprCursor cur(msg);
+
+    cur.consume('(');
+    cur.atom(); // Saltar "hear"
+
+    int time = 0;
+    if (cur.number(time))
+        gameState.time = time;
+
+    // Compañero: (hear 12 -30 our 7 "msg"); los rivales (opp) y el eco propio (self) se ignoran
+    double direction = 0.0;
+    if (cur.number(direction)) {
+        int sender = -1;
+        SayMessage say;
+        if (cur.atom() == "our" && cur.number(sender) && decodeSay(cur.atom(), time, say))
+            mergeSay(player.heard, sender, say);
+        return;
+    }
 
-    auto numberTok = nextToken(sv);
-    player.number = std::stoi(std::string(numberTok));
+    auto sourceTok = cur.atom();
+    if (sourceTok.rfind("online_coach_", 0) == 0) {
+        // Entrenador en línea: sólo el nuestro, (freeform "...") o el texto tal cual
+        bool ours = player.side != Side::Unknown && (sourceTok == "online_coach_left") == (player.side == Side::Left);
+        if (cur.consume('('))
+            cur.atom(); // "freeform"
+        if (ours && decodeAdvice(cur.atom(), player.advice))
+            player.advice.time = time;
+        return;
+    }
+    if (!(sourceTok == "referee"))
+        return;
 
-    auto playModeTok = nextToken(sv); 
-    gameState.playMode = mapRefereeTokenToPlayMode(std::string(playModeTok));
+    // Modo de juego (ya como nuestro/suyo) y marcador si es un gol
+    RefereeMessage referee = decodeReferee(cur.atom(), player.side);
+    applyReferee(referee, player.side, gameState);
 
-    auto position = calcKickOffPosition(player.number);
-    player.initialPosition = position;
+    if ((referee.event == RefereeEvent::YellowCard || referee.event == RefereeEvent::RedCard) && referee.ours)
+        LOG_INFO("{} card for our player {}", referee.event == RefereeEvent::RedCard ? "Red" : "Yellow",
+                 referee.number);
 }
 
-void parseSeeMsg(const std::string &msg, PlayerInfo &player)
+// Recorre las parejas (clave valor) de server_param, player_param y player_type
+template <typename F>
+static void forEachParam(std::string_view msg, F &&onParam)
 {
-    std::string_view sv = msg;
-
-    nextToken(sv); // Saltar "(see"
-    auto timeTok = nextToken(sv);
-    player.see.time = std::stoi(std::string(timeTok));
-
-    parseObjectInfo(msg, "(b)", player.see.ball);
-
-    // Identificar porterías según el lado del jugador
-    if (player.side == Side::Left) {
-        // Nuestro lado es el izquierdo -> nuestra portería es g l, rival g r
-        parseObjectInfo(msg, "(g l)", player.see.ownGoal);
-        parseObjectInfo(msg, "(g r)", player.see.oppGoal);
-    } else if (player.side == Side::Right) {
-        // Nuestro lado es el derecho -> nuestra portería es g r, rival g l
-        parseObjectInfo(msg, "(g r)", player.see.ownGoal);
-        parseObjectInfo(msg, "(g l)", player.see.oppGoal);
-    } 
+    SExprCursor cur(msg);
+    cur.consume('(');
+    cur.atom(); // Saltar el nombre del mensaje
+
+    while (cur.consume('(')) {
+        auto key = cur.atom();
+        double value = 0.0;
+        if (cur.number(value))
+            onParam(key, value);
+        cur.skipList();
+    }
 }
 
-void parseSenseMsg(const std::string &msg, PlayerInfo &player)
+void parseServerParam(std::string_view msg, ServerParams &params)
 {
-    // TODO: Implementar parsing completo de sense_body
+    forEachParam(msg, [&](std::string_view key, double value) {
+        if (key == "ball_decay")                params.ballDecay = value;
+        else if (key == "ball_size")            params.ballSize = value;
+        else if (key == "ball_speed_max")       params.ballSpeedMax = value;
+        else if (key == "maxpower")             params.maxPower = value;
+        else if (key == "maxmoment")            params.maxMoment = value;
+        else if (key == "kick_power_rate")      params.kickPowerRate = value;
+    });
 }
 
-void parseHearMsg(const std::string &msg, PlayerInfo &player, GameState &gameState)
+void parsePlayerParam(std::string_view msg, ServerParams &params)
 {
-    std::string_view sv = msg;
+    forEachParam(msg, [&](std::string_view key, double value) {
+        if (key == "player_types")
+            params.playerTypes = static_cast<int>(value);
+    });
+}
 
-    nextToken(sv); // Saltar "(hear"
+void parsePlayerType(std::string_view msg, PlayerTypeParams &type)
+{
+    forEachParam(msg, [&](std::string_view key, double value) {
+        if (key == "id")                        type.id = static_cast<int>(value);
+        else if (key == "player_speed_max")     type.playerSpeedMax = value;
+        else if (key == "player_decay")         type.playerDecay = value;
+        else if (key == "inertia_moment")       type.inertiaMoment = value;
+        else if (key == "dash_power_rate")      type.dashPowerRate = value;
+        else if (key == "player_size")          type.playerSize = value;
+        else if (key == "kickable_margin")      type.kickableMargin = value;
+        else if (key == "effort_max")           type.effortMax = value;
+    });
+}
 
-    auto timeTok = nextToken(sv);
-    gameState.time = std::stoi(std::string(timeTok));
+void parseChangePlayerTypeMsg(std::string_view msg, PlayerInfo &player)
+{
+    SExprCursor cur(msg);
+    cur.consume('(');
+    cur.atom();     // Saltar "change_player_type"
 
-    auto sourceTok = nextToken(sv);
-    if (!(sourceTok == "referee")) 
+    int unum = -1, type = -1;
+    if (!cur.number(unum) || !cur.number(type) || unum <= 0 ||
+        static_cast<std::size_t>(unum) >= player.mateTypes.size() || type < 0)
         return;
+    player.mateTypes[static_cast<std::size_t>(unum)] = static_cast<std::uint8_t>(type);
+    if (unum == player.number)
+        player.playerType = static_cast<std::uint8_t>(type);
+}
 
-    auto messageTok = nextToken(sv);
-
-    // 4.1) Actualizar marcador si es un gol
-    updateScoreFromGoalToken(messageTok, gameState);
-
-    gameState.playMode = mapRefereeTokenToPlayMode(std::string(messageTok));
-}
-
-std::vector<FlagInfo> parseVisibleFlags(const std::string &seeMsg)
-{
-    std::vector<FlagInfo> visibleFlags;
-    const std::string &s = seeMsg;
-    std::size_t start = 0;
-    const std::size_t N = s.size();
-
-    // Función auxiliar para eliminar los espacios en blanco al principio y al final de una cadena
-    auto trim = [](std::string &str){
-        std::size_t a = 0;
-        while (a < str.size() && std::isspace((unsigned char)str[a])) ++a; // Eliminar espacios al principio
-        std::size_t b = str.size();
-        while (b > a && std::isspace((unsigned char)str[b-1])) --b; // Eliminar espacios al final
-        str = str.substr(a, b-a);
-    };
-
-    // Bucle para recorrer todo el mensaje en busca de flags
-    while (start < N) {
-        // buscar la próxima ocurrencia de "(f" o "(g" o "(b"
-        std::size_t pos_f = s.find("(f", start);
-        std::size_t pos_g = s.find("(g", start);
-        std::size_t pos_b = s.find("(b", start);
-
-        // Determinar cuál de las posiciones es la más cercana
-        std::size_t pos = std::string::npos;
-        if (pos_f != std::string::npos) pos = pos_f;
-        if (pos_g != std::string::npos && (pos == std::string::npos || pos_g < pos)) pos = pos_g;
-        if (pos_b != std::string::npos && (pos == std::string::npos || pos_b < pos)) pos = pos_b;
-
-        // Si no se encuentran flags, salimos del bucle
-        if (pos == std::string::npos) break;
-
-        // encontrar el cierre de ese paréntesis correspondiente (primer ')' tras pos)
-        std::size_t close = s.find(')', pos);
-        if (close == std::string::npos) break; // formato raro -> salir
-
-        // nombre entre '(' y ')', por ejemplo "f c" o "f t l 40"
-        std::string name = s.substr(pos + 1, close - (pos + 1)); // quitar '('
-        trim(name);
-
-        // validar nombre con FLAG_POSITIONS
-        if (FLAG_POSITIONS.find(name) != FLAG_POSITIONS.end()) {
-            // extraer números que siguen después de close
-            // tomamos una ventana corta a partir de close+1 para parsear dist y dir
-            std::size_t num_start = close + 1;
-            // aumentar la ventana si hace falta, pero limitarla para eficiencia
-            std::size_t len = std::min<std::size_t>(N - num_start, 128);
-            std::string tail = s.substr(num_start, len); // Extraer la parte del mensaje que contiene los números
-            std::istringstream iss(tail); // Convertir la parte extraída a un stream para parsear los números
-            double dist = 0.0, dir = 0.0;
-            // Si se pudieron leer correctamente los números de distancia y dirección
-            if ( (iss >> dist >> dir) ) {
-                FlagInfo fi;
-                fi.name = name;
-                fi.dist = dist;
-                fi.dir  = dir;
-                fi.visible = true;
-                fi.pos = FLAG_POSITIONS.at(name);
-                visibleFlags.push_back(fi);
-            }
-            // si no se pudieron leer números, ignoramos esta ocurrencia
+std::size_t parseVisibleFlags(std::string_view seeMsg, std::span<FlagInfo> out)
+{
+    SExprCursor cur(seeMsg);
+    if (!cur.consume('(') || cur.atom() != "see")
+        return 0;
+    int time = 0;
+    cur.number(time);
+
+    // El mismo recorrido que parseSeeMsg, quedándose sólo con las marcas fijas
+    std::size_t count = 0;
+    while (count < out.size() && cur.consume('(')) {
+        if (!cur.consume('(')) {
+            cur.skipList();
+            continue;
         }
-
-        // avanzar start para seguir buscando (evitar loops infinitos)
-        start = close + 1;
+        std::string_view name = cur.untilClose();
+
+        double nums[8];
+        std::uint8_t markers;
+        int n = readObjectNumbers(cur, nums, 8, markers);
+        if (name.empty() || n < 2 || (name[0] != 'f' && name[0] != 'g'))
+            continue;
+        FlagId id = lookupFlag(name);
+        if (id != FLAG_NONE)
+            out[count++] = FlagInfo{id, nums[0], nums[1], true, flagPosition(id)};
     }
-
-    return visibleFlags;
-}
\ No newline at end of file
+    return count;
+}
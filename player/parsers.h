@@ -3,22 +3,47 @@
 #include "types.h"
 #include "positions.h"
 #include <string_view>
+#include <cstddef>
+#include <span>
 
 // Parsea el mensaje de inicialización del servidor
 // Ejemplo: (init l 1 before_kick_off)
-void parseInitMsg(const std::string &msg, PlayerInfo &player, GameState &gameState);
+void parseInitMsg(std::string_view msg, PlayerInfo &player, GameState &gameState);
 
-// Parsea el mensaje de visión del servidor
+// Parsea el mensaje de visión del servidor en un único recorrido, sin copias:
+// balón, porterías, banderas, líneas y jugadores se rellenan en player.see.
+// Objetivo de rendimiento: >= 100.000 mensajes see/s por núcleo con el campo
+// completo a la vista (~2-3 KB por mensaje).
 // Ejemplo: (see 0 ... ((g r) 102.5 0) ... ((b) 49.4 0) ...)
-void parseSeeMsg(const std::string &msg, PlayerInfo &player);
+void parseSeeMsg(std::string_view msg, PlayerInfo &player);
 
-// Parsea el mensaje de información sensorial interna del jugador
+// Parsea el mensaje de información sensorial interna del jugador en un único
+// recorrido, sin copias: resistencia, velocidad, cuello, contadores de comandos,
+// brazo, atención, entrada, colisiones y faltas se rellenan en player.sense.
 // Ejemplo: (sense_body 0 ... (stamina 8000 1 130600) (speed 0 0) (head_angle 0) ...)
-void parseSenseMsg(const std::string &msg, PlayerInfo &player);
+void parseSenseMsg(std::string_view msg, PlayerInfo &player);
 
-// Parsea el mensaje de audición del jugador
-// Ejemplo: (hear 0 referee kick_off_l)
-void parseHearMsg(const std::string &msg, PlayerInfo &player, GameState &gameState);
+// Parsea el mensaje de audición del jugador: árbitro y mensajes de compañeros,
+// que se incorporan a player.heard
+// Ejemplo: (hear 0 referee kick_off_l), (hear 52 -30 our 7 "3fK.a0<_bQ")
+void parseHearMsg(std::string_view msg, PlayerInfo &player, GameState &gameState);
 
-// Parsea y devuelve una lista de banderas visibles en el mensaje de visión
-std::vector<FlagInfo> parseVisibleFlags(const std::string &see_msg);
\ No newline at end of file
+// Parámetros del servidor que usan los modelos de movimiento; las claves que
+// no se usan se ignoran
+// Ejemplo: (server_param (ball_decay 0.94) (ball_size 0.085) ... (maxmoment 180) ...)
+void parseServerParam(std::string_view msg, ServerParams &params);
+
+// Ejemplo: (player_param (player_types 18) ...)
+void parsePlayerParam(std::string_view msg, ServerParams &params);
+
+// Ejemplo: (player_type (id 3) (player_speed_max 1.05) (player_decay 0.43) ...)
+void parsePlayerType(std::string_view msg, PlayerTypeParams &type);
+
+// Cambio de tipo heterogéneo: (change_player_type UNUM TYPE) para el propio
+// jugador y sus compañeros, (change_player_type UNUM) para un rival, cuyo tipo
+// no se comunica
+void parseChangePlayerTypeMsg(std::string_view msg, PlayerInfo &player);
+
+// Parsea las banderas (y porterías) conocidas del mensaje de visión en out, sin
+// reservar memoria; devuelve cuántas caben (un SeeInfo::MAX_FLAGS basta siempre)
+std::size_t parseVisibleFlags(std::string_view see_msg, std::span<FlagInfo> out);
\ No newline at end of file
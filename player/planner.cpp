@@ -0,0 +1,401 @@
+#include "planner.h"
+#include "cycle.h"
+#include "positions.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+static constexpr double DEG = M_PI / 180.0;
+
+static constexpr double FIELD_HALF_LENGTH = 52.5;
+static constexpr double FIELD_HALF_WIDTH = 34.0;
+static constexpr double GOAL_HALF_WIDTH = 7.01;
+
+// Función de evaluación
+static constexpr double GOAL_VALUE = 2.0;           // un tiro seguro vale más que cualquier posición
+static constexpr double CLEAR_FACTOR = 0.4;         // el despeje cede casi siempre la posesión
+static constexpr double DEPTH_DISCOUNT = 0.95;      // preferir la cadena corta a igualdad de valor
+static constexpr double SUCCESS_SCALE = 2.0;        // ciclos de ventaja para ~73 % de éxito
+static constexpr double MIN_PROBABILITY = 0.1;      // cadenas menos probables no se expanden
+
+// Parámetros de las acciones candidatas
+static constexpr double SHOOT_MAX_DIST = 40.0;
+static constexpr double PASS_MIN_DIST = 3.0;
+static constexpr double PASS_MAX_DIST = 40.0;
+static constexpr double PASS_END_SPEED = 1.0;       // velocidad con la que debe llegar el pase
+static constexpr double PASS_LEAD = 3.0;            // pase al hueco: metros por delante del receptor
+static constexpr double DRIBBLE_DIST = 5.0;
+static constexpr double DRIBBLE_EXTRA_SPEED = 0.3;
+static constexpr std::array<double, 5> SHOOT_Y = {-0.85 * GOAL_HALF_WIDTH, -0.45 * GOAL_HALF_WIDTH, 0.0,
+                                                  0.45 * GOAL_HALF_WIDTH, 0.85 * GOAL_HALF_WIDTH};
+static constexpr std::array<double, 5> DRIBBLE_DIRS = {-60.0, -30.0, 0.0, 30.0, 60.0};
+static constexpr std::array<double, 3> CLEAR_DIRS = {-45.0, 0.0, 45.0};
+
+// Expansiones entre dos consultas del reloj y de la orden de parar
+static constexpr std::size_t PLAN_STEP_EXPANSIONS = 4;
+
+const char *toString(ActionKind kind)
+{
+    switch (kind) {
+        case ActionKind::Pass:      return "pass";
+        case ActionKind::Dribble:   return "dribble";
+        case ActionKind::Shoot:     return "shoot";
+        case ActionKind::Clear:     return "clear";
+    }
+    return "?";
+}
+
+// Valor de tener el balón en p: avance hacia la portería rival y amenaza de gol
+static double fieldValue(Point p)
+{
+    double progress = (std::clamp(p.x, -FIELD_HALF_LENGTH, FIELD_HALF_LENGTH) + FIELD_HALF_LENGTH) / (2 * FIELD_HALF_LENGTH);
+    double threat = std::max(0.0, 1.0 - std::hypot(FIELD_HALF_LENGTH - p.x, p.y) / 30.0);
+    return 0.6 * progress + 0.4 * threat;
+}
+
+static double successProbability(int ours, int theirs)
+{
+    return 1.0 / (1.0 + std::exp(-(theirs - ours) / SUCCESS_SCALE));
+}
+
+static bool insideField(Point p)
+{
+    return std::fabs(p.x) < FIELD_HALF_LENGTH - 0.5 && std::fabs(p.y) < FIELD_HALF_WIDTH - 0.5;
+}
+
+// Velocidad del balón hacia target con módulo speed
+static Point velocityTowards(Point from, Point target, double speed)
+{
+    double d = std::hypot(target.x - from.x, target.y - from.y);
+    if (d < 1e-9)
+        return {};
+    return {(target.x - from.x) / d * speed, (target.y - from.y) / d * speed};
+}
+
+// --- Mundo -----------------------------------------------------------------------
+
+PlanWorld PlanWorld::from(const PlayerInfo &player)
+{
+    PlanWorld w;
+    w.size = gatherInterceptors(player, w.players);
+
+    double a = (player.dir_abs - player.sense.headAngle - player.see.ball.dir) * DEG;
+    w.ball = {player.x_abs + player.see.ball.dist * std::cos(a), player.y_abs + player.see.ball.dist * std::sin(a)};
+    w.ballVel = player.ballVel;
+
+    // Marco de ataque: el lado derecho ataca hacia -x
+    if (player.side == Side::Right) {
+        w.ball = {-w.ball.x, -w.ball.y};
+        w.ballVel = {-w.ballVel.x, -w.ballVel.y};
+        for (std::size_t i = 0; i < w.size; ++i) {
+            Interceptor &p = w.players[i];
+            p.pos = {-p.pos.x, -p.pos.y};
+            p.bodyDir = static_cast<float>(normalizaAngulo(p.bodyDir + 180.0));
+        }
+    }
+    return w;
+}
+
+// --- Búsqueda ----------------------------------------------------------------------
+
+void ChainSearch::start(const PlanWorld &world)
+{
+    model_ = &interceptModel();
+    world_ = world;
+    opponentCount_ = 0;
+    for (std::size_t i = 1; i < world_.size; ++i) {
+        if (world_.players[i].team != TeamSide::Own)
+            opponents_[opponentCount_++] = static_cast<std::int8_t>(i);
+    }
+
+    best_ = ActionChain{};
+    best_.value = -std::numeric_limits<double>::infinity();
+    nodes_ = 0;
+    depth_ = 0;
+
+    tree_[0] = Node{world_.ball, 1.0, fieldValue(world_.ball), -1, 0, 0, {}};
+    count_ = 1;
+    open_[0] = 0;
+    openSize_ = 1;
+}
+
+bool ChainSearch::step(std::size_t maxExpansions)
+{
+    auto lower = [this](std::int16_t a, std::int16_t b) { return tree_[a].value < tree_[b].value; };
+    for (std::size_t n = 0; n < maxExpansions && openSize_ > 0; ++n) {
+        std::pop_heap(open_.begin(), open_.begin() + openSize_, lower);
+        std::int16_t index = open_[--openSize_];
+        depth_ = std::max<int>(depth_, tree_[index].depth + 1);
+        expand(tree_[index], index);
+    }
+    return openSize_ > 0;
+}
+
+void ChainSearch::race(const Node &node, Point vel, int receiver, InterceptResult &ours, int &theirs)
+{
+    std::array<Interceptor, INTERCEPTOR_CAPACITY> who;
+    std::array<InterceptResult, INTERCEPTOR_CAPACITY> res;
+    std::size_t n = 0;
+    if (receiver >= 0) {
+        who[n] = world_.players[static_cast<std::size_t>(receiver)];
+        if (receiver == node.holder)
+            who[n].pos = node.ball;   // Quien conduce va pegado al balón
+        ++n;
+    }
+    for (std::size_t i = 0; i < opponentCount_; ++i)
+        who[n++] = world_.players[static_cast<std::size_t>(opponents_[i])];
+
+    model_->solve(node.ball, vel, std::span(who.data(), n), res);
+
+    std::size_t first = receiver >= 0 ? 1 : 0;
+    if (receiver >= 0)
+        ours = res[0];
+    theirs = std::numeric_limits<int>::max() / 2;
+    for (std::size_t i = first; i < n; ++i)
+        theirs = std::min(theirs, res[i].cycle);
+}
+
+void ChainSearch::expand(const Node &node, std::int16_t index)
+{
+    const ServerParams &server = model_->server();
+    const double decay = server.ballDecay;
+    InterceptResult ours;
+    int theirs;
+
+    // Tiro a varios puntos de la portería a máxima velocidad: gol si el balón
+    // cruza la línea antes de que lo alcance ningún rival
+    for (double y : SHOOT_Y) {
+        Point target{FIELD_HALF_LENGTH, y};
+        double d = std::hypot(target.x - node.ball.x, target.y - node.ball.y);
+        double v = server.ballSpeedMax;
+        if (d > SHOOT_MAX_DIST || d * (1.0 - decay) >= v)
+            continue;
+        int arrival = static_cast<int>(std::ceil(std::log(1.0 - d * (1.0 - decay) / v) / std::log(decay)));
+        race(node, velocityTowards(node.ball, target, v), -1, ours, theirs);
+        double p = successProbability(arrival, theirs);
+        PlanAction a{ActionKind::Shoot, target, v, -1, static_cast<std::uint8_t>(std::min(arrival, 255)),
+                     static_cast<float>(p)};
+        addChild(node, index, a, target, p * GOAL_VALUE, true);
+    }
+
+    // Pases al pie y al hueco a cada compañero visto
+    for (std::size_t j = 1; j < world_.size; ++j) {
+        if (world_.players[j].team != TeamSide::Own || static_cast<int>(j) == node.holder)
+            continue;
+        Point mate = world_.players[j].pos;
+        for (Point target : {mate, Point{mate.x + PASS_LEAD, mate.y}}) {
+            double d = std::hypot(target.x - node.ball.x, target.y - node.ball.y);
+            if (d < PASS_MIN_DIST || d > PASS_MAX_DIST || !insideField(target))
+                continue;
+            double v = std::min(server.ballSpeedMax, d * (1.0 - decay) + PASS_END_SPEED);
+            race(node, velocityTowards(node.ball, target, v), static_cast<int>(j), ours, theirs);
+            if (!insideField(ours.point))
+                continue;
+            double p = successProbability(ours.cycle, theirs);
+            PlanAction a{ActionKind::Pass, target, v, static_cast<std::int8_t>(j),
+                         static_cast<std::uint8_t>(std::min(ours.cycle, 255)), static_cast<float>(p)};
+            addChild(node, index, a, ours.point, p * fieldValue(ours.point), false);
+        }
+    }
+
+    // Conducción: balón corto por delante y recogerlo
+    for (double dir : DRIBBLE_DIRS) {
+        Point target{node.ball.x + DRIBBLE_DIST * std::cos(dir * DEG), node.ball.y + DRIBBLE_DIST * std::sin(dir * DEG)};
+        if (!insideField(target))
+            continue;
+        double v = DRIBBLE_DIST * (1.0 - decay) + DRIBBLE_EXTRA_SPEED;
+        race(node, velocityTowards(node.ball, target, v), node.holder, ours, theirs);
+        double p = successProbability(ours.cycle, theirs);
+        PlanAction a{ActionKind::Dribble, target, v, node.holder,
+                     static_cast<std::uint8_t>(std::min(ours.cycle, 255)), static_cast<float>(p)};
+        addChild(node, index, a, ours.point, p * fieldValue(ours.point), false);
+    }
+
+    // Despeje (sólo como primera acción): lejos y hacia delante, sin contar con recuperarlo
+    if (node.depth == 0) {
+        for (double dir : CLEAR_DIRS) {
+            double v = server.ballSpeedMax;
+            Point vel{v * std::cos(dir * DEG), v * std::sin(dir * DEG)};
+            Point rest = model_->ballAt(node.ball, vel, INTERCEPT_MAX_CYCLES);
+            rest = {std::clamp(rest.x, -FIELD_HALF_LENGTH, FIELD_HALF_LENGTH),
+                    std::clamp(rest.y, -FIELD_HALF_WIDTH, FIELD_HALF_WIDTH)};
+            PlanAction a{ActionKind::Clear, rest, v, -1, 0, 1.0f};
+            addChild(node, index, a, rest, CLEAR_FACTOR * fieldValue(rest), true);
+        }
+    }
+}
+
+void ChainSearch::addChild(const Node &parent, std::int16_t parentIndex, const PlanAction &action, Point ball,
+                           double value, bool terminal)
+{
+    ++nodes_;
+    double probability = parent.probability * action.success;
+    double chainValue = parent.probability * value * std::pow(DEPTH_DISCOUNT, parent.depth);
+
+    if (chainValue > best_.value) {
+        best_ = chainTo(parentIndex);
+        best_.actions[static_cast<std::size_t>(best_.depth++)] = action;
+        best_.value = chainValue;
+    }
+
+    if (terminal || parent.depth + 1 >= PLAN_MAX_DEPTH || probability < MIN_PROBABILITY || count_ >= PLAN_MAX_NODES)
+        return;
+
+    auto index = static_cast<std::int16_t>(count_++);
+    tree_[static_cast<std::size_t>(index)] = Node{ball, probability, chainValue, parentIndex,
+                                                  action.receiver, static_cast<std::int8_t>(parent.depth + 1), action};
+    open_[openSize_++] = index;
+    std::push_heap(open_.begin(), open_.begin() + openSize_,
+                   [this](std::int16_t a, std::int16_t b) { return tree_[a].value < tree_[b].value; });
+}
+
+ActionChain ChainSearch::chainTo(std::int16_t index) const
+{
+    ActionChain chain;
+    chain.depth = tree_[static_cast<std::size_t>(index)].depth;
+    for (int d = chain.depth; d > 0; --d) {
+        const Node &n = tree_[static_cast<std::size_t>(index)];
+        chain.actions[static_cast<std::size_t>(d - 1)] = n.action;
+        index = n.parent;
+    }
+    return chain;
+}
+
+// --- Comando -----------------------------------------------------------------------
+
+Command planKick(const PlayerInfo &player, const PlanAction &action)
+{
+    const InterceptModel &model = interceptModel();
+    const ServerParams &server = model.server();
+    const PlayerTypeParams &type = model.type(0);
+
+    // Balón y objetivo en coordenadas absolutas
+    double a = (player.dir_abs - player.sense.headAngle - player.see.ball.dir) * DEG;
+    Point ball{player.x_abs + player.see.ball.dist * std::cos(a), player.y_abs + player.see.ball.dist * std::sin(a)};
+    Point target = action.target;
+    if (player.side == Side::Right)
+        target = {-target.x, -target.y};
+
+    // El kick suma una aceleración a la velocidad que ya lleva el balón
+    Point want = velocityTowards(ball, target, action.speed);
+    Point accel{want.x - player.ballVel.x, want.y - player.ballVel.y};
+
+    // Eficacia del golpeo según la posición del balón respecto al cuerpo
+    double dirDiff = std::fabs(normalizaAngulo(player.see.ball.dir + player.sense.headAngle));
+    double distDiff = std::max(0.0, player.see.ball.dist - type.playerSize - server.ballSize);
+    double rate = server.kickPowerRate * (1.0 - 0.25 * dirDiff / 180.0 - 0.25 * distDiff / type.kickableMargin);
+    double power = std::min(server.maxPower, std::hypot(accel.x, accel.y) / std::max(rate, 1e-6));
+
+    // Dirección relativa al cuerpo en el convenio del servidor (horario)
+    double rel = normalizaAngulo(std::atan2(accel.y, accel.x) / DEG - player.dir_abs);
+    return Command::kick(power, -rel);
+}
+
+// --- Trabajos y grupo de hilos -----------------------------------------------------
+
+void PlanJob::submit(PlannerPool &pool, const PlanWorld &world, std::int64_t deadlineNs)
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+    if (state_ == State::Running) {
+        stop_.store(true, std::memory_order_relaxed);
+        done_.wait(lock, [this] { return state_ != State::Running; });
+    }
+    bool queued = state_ == State::Queued;
+    world_ = world;
+    deadlineNs_ = deadlineNs;
+    stop_.store(false, std::memory_order_relaxed);
+    state_ = State::Queued;
+    lock.unlock();
+
+    if (!queued)
+        pool.enqueue(this);
+}
+
+const ActionChain &PlanJob::collect(const PlayerInfo &player, PlanStats &stats)
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+    if (state_ == State::Running) {
+        stop_.store(true, std::memory_order_relaxed);
+        done_.wait(lock, [this] { return state_ != State::Running; });
+    }
+    if (state_ == State::Done) {
+        state_ = State::Idle;
+        stats = stats_;
+        return result_;
+    }
+    // Sin encargo o sin empezar todavía: el hilo que lo saque de la cola lo ignorará
+    state_ = State::Idle;
+    lock.unlock();
+
+    std::int64_t t0 = monotonicNowNs();
+    search_.start(PlanWorld::from(player));
+    while (search_.nodes() < PLAN_SYNC_NODES && search_.step(1)) {
+    }
+    result_ = search_.best();
+    stats = {search_.nodes(), search_.depth(), monotonicNowNs() - t0};
+    return result_;
+}
+
+void PlanJob::run()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (state_ != State::Queued)
+            return;
+        state_ = State::Running;
+    }
+
+    std::int64_t t0 = monotonicNowNs();
+    search_.start(world_);
+    while (!stop_.load(std::memory_order_relaxed) && monotonicNowNs() < deadlineNs_ &&
+           search_.step(PLAN_STEP_EXPANSIONS)) {
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    result_ = search_.best();
+    stats_ = {search_.nodes(), search_.depth(), monotonicNowNs() - t0};
+    state_ = State::Done;
+    done_.notify_all();
+}
+
+PlannerPool::PlannerPool(int threads)
+{
+    for (int i = 0; i < threads; ++i)
+        threads_.emplace_back([this] { work(); });
+}
+
+PlannerPool::~PlannerPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    ready_.notify_all();
+    for (auto &t : threads_)
+        t.join();
+}
+
+void PlannerPool::enqueue(PlanJob *job)
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        queue_.push_back(job);
+    }
+    ready_.notify_one();
+}
+
+void PlannerPool::work()
+{
+    while (true) {
+        PlanJob *job;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            ready_.wait(lock, [this] { return stopping_ || !queue_.empty(); });
+            if (stopping_)
+                return;
+            job = queue_.front();
+            queue_.pop_front();
+        }
+        job->run();
+    }
+}
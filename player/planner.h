@@ -0,0 +1,199 @@
+#pragma once
+
+#include "types.h"
+#include "command.h"
+#include "intercept.h"
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Planificador de cadenas de acciones con balón.
+//
+// Desde el jugador que tiene el balón se expanden cadenas de hasta
+// PLAN_MAX_DEPTH acciones (pase a un compañero, conducción, tiro a un tramo de
+// la portería, despeje). Cada acción se simula con el modelo de intercepción:
+// la probabilidad de éxito sale de la ventaja en ciclos del receptor sobre el
+// rival más rápido, y el estado resultante (quién tiene el balón y dónde) se
+// puntúa con una función de evaluación del campo. La búsqueda es primero el
+// mejor y "anytime": se puede cortar tras cualquier nodo y siempre tiene la
+// mejor cadena encontrada hasta entonces.
+//
+// Todo va en el marco de ataque (atacamos hacia +x); el lado derecho se refleja
+// al construir el mundo y al convertir la acción en comando.
+
+inline constexpr int PLAN_MAX_DEPTH = 3;
+inline constexpr std::size_t PLAN_MAX_NODES = 2048;
+
+// Nodos de la búsqueda síncrona (sin grupo de hilos): el resultado no depende
+// del reloj, así que player_replay reproduce la misma decisión. Con el grupo
+// de hilos la cadena depende de cuánto llegó a buscar, por eso --record
+// desactiva --plan-threads.
+inline constexpr std::size_t PLAN_SYNC_NODES = 256;
+
+// Margen que se deja antes del envío para recoger el resultado
+inline constexpr std::int64_t PLAN_GUARD_NS = 2'000'000;
+
+// Distancia al balón a partir de la cual se chuta (el resto del tiempo se corre)
+inline constexpr double BALL_CONTROL_DIST = 1.0;
+
+inline bool hasBall(const PlayerInfo &player)
+{
+    return player.see.ball.visible && player.see.ball.dist <= BALL_CONTROL_DIST;
+}
+
+enum class ActionKind : std::uint8_t
+{
+    Pass, Dribble, Shoot, Clear
+};
+
+const char *toString(ActionKind kind);
+
+struct PlanAction
+{
+    ActionKind kind{ActionKind::Shoot};
+    Point target{};           // Punto al que se envía el balón (marco de ataque)
+    double speed{0.0};        // Velocidad inicial del balón (m/ciclo)
+    std::int8_t receiver{0};  // Índice en PlanWorld::players de quien lo recibe
+    std::uint8_t cycles{0};   // Ciclos hasta que lo controla (o hasta la portería)
+    float success{0.0f};      // Probabilidad de éxito estimada
+};
+
+struct ActionChain
+{
+    std::array<PlanAction, PLAN_MAX_DEPTH> actions{};
+    int depth{0};
+    double value{0.0};
+
+    bool empty() const { return depth == 0; }
+};
+
+// Instantánea del partido para la búsqueda: el propio jugador (índice 0, con
+// el balón) y los jugadores vistos, en el marco de ataque
+struct PlanWorld
+{
+    Point ball{};
+    Point ballVel{};
+    std::array<Interceptor, INTERCEPTOR_CAPACITY> players{};
+    std::size_t size{0};
+
+    static PlanWorld from(const PlayerInfo &player);
+};
+
+// Resultado de una búsqueda
+struct PlanStats
+{
+    std::uint64_t nodes{0};   // acciones simuladas y evaluadas
+    int depth{0};             // profundidad máxima expandida
+    std::int64_t ns{0};       // tiempo de búsqueda
+};
+
+// Búsqueda primero el mejor con memoria fija: start() la prepara y step()
+// expande nodos hasta el presupuesto; best() vale en cualquier momento
+class ChainSearch
+{
+public:
+    void start(const PlanWorld &world);
+
+    // Expande como mucho maxExpansions nodos; false cuando ya no queda nada que expandir
+    bool step(std::size_t maxExpansions);
+
+    const ActionChain &best() const { return best_; }
+    std::uint64_t nodes() const { return nodes_; }
+    int depth() const { return depth_; }
+
+private:
+    struct Node
+    {
+        Point ball{};             // Balón controlado por holder
+        double probability{1.0};  // Probabilidad de que la cadena llegue hasta aquí
+        double value{0.0};        // Valor de la cadena si termina aquí
+        std::int16_t parent{-1};
+        std::int8_t holder{0};
+        std::int8_t depth{0};
+        PlanAction action{};
+    };
+
+    void expand(const Node &node, std::int16_t index);
+    void addChild(const Node &parent, std::int16_t parentIndex, const PlanAction &action, Point ball, double value,
+                  bool terminal);
+    // Simula el balón saliendo de from con velocidad vel: ciclo en el que lo
+    // controla receiver y el del rival más rápido
+    void race(const Node &node, Point vel, int receiver, InterceptResult &ours, int &theirs);
+    ActionChain chainTo(std::int16_t index) const;
+
+    const InterceptModel *model_{nullptr};
+    PlanWorld world_{};
+    std::array<std::int8_t, INTERCEPTOR_CAPACITY> opponents_{};   // índices de rivales (y desconocidos)
+    std::size_t opponentCount_{0};
+    std::array<Node, PLAN_MAX_NODES> tree_{};
+    std::size_t count_{0};
+    std::array<std::int16_t, PLAN_MAX_NODES> open_{};   // montículo de nodos por expandir
+    std::size_t openSize_{0};
+    ActionChain best_{};
+    std::uint64_t nodes_{0};
+    int depth_{0};
+};
+
+// Convierte la primera acción de la cadena en el kick que da al balón esa velocidad
+Command planKick(const PlayerInfo &player, const PlanAction &action);
+
+class PlannerPool;
+
+// Trabajo de planificación de un agente: el hilo del agente lo encarga con
+// submit() al recibir una estimación nueva y lo recoge con collect() al
+// vencer el ciclo; entre medias un hilo del grupo busca hasta el plazo
+class PlanJob
+{
+public:
+    // Sustituye la búsqueda en curso por una sobre world que se corta en deadlineNs
+    void submit(PlannerPool &pool, const PlanWorld &world, std::int64_t deadlineNs);
+
+    // Detiene la búsqueda y devuelve la mejor cadena. Sin búsqueda encargada
+    // (o si ningún hilo llegó a empezarla), busca aquí con PLAN_SYNC_NODES nodos.
+    const ActionChain &collect(const PlayerInfo &player, PlanStats &stats);
+
+private:
+    friend class PlannerPool;
+
+    enum class State : std::uint8_t { Idle, Queued, Running, Done };
+
+    void run();
+
+    std::mutex mutex_;
+    std::condition_variable done_;
+    State state_{State::Idle};
+    std::atomic<bool> stop_{false};
+    PlanWorld world_{};
+    std::int64_t deadlineNs_{0};
+    ChainSearch search_;
+    ActionChain result_{};
+    PlanStats stats_{};
+};
+
+// Hilos de búsqueda compartidos por todos los agentes del proceso
+class PlannerPool
+{
+public:
+    explicit PlannerPool(int threads);
+    ~PlannerPool();
+    PlannerPool(const PlannerPool &) = delete;
+    PlannerPool &operator=(const PlannerPool &) = delete;
+
+private:
+    friend class PlanJob;
+
+    void enqueue(PlanJob *job);
+    void work();
+
+    std::mutex mutex_;
+    std::condition_variable ready_;
+    std::deque<PlanJob *> queue_;
+    bool stopping_{false};
+    std::vector<std::thread> threads_;
+};
@@ -1,5 +1,6 @@
 #include "positions.h"
 #include "parsers.h"
+#include "log.h"
 #include <cmath>
 
 // Calcula la posición inicial en el campo según el número de dorsal (1-11)
@@ -19,86 +20,38 @@ Point calcKickOffPosition(int unum)
     return positions[unum - 1];
 }
 
-//Zona de cada jugador según su número
-Zona definirZonaJugador(PlayerInfo &p) {
-    Zona zona{};
-
-    switch(p.number) {
-        case 1:
-            zona = { -52.5, -40.0, -12.0, 12.0 };
-            break;
-        case 2:
-            zona = { -52.5, -15.0, 10.0, 34.0 };
-            break;
-        case 3:
-            zona = { -52.5, -20.0, -2.0, 20.0 };
-            break;
-        case 4:
-            zona = { -52.5, -20.0, -20.0, 2.0 };
-            break;
-        case 5:
-            zona = { -52.5, -15.0, -34.0, -10.0 };
-            break;
-        case 6:
-            zona = { -35.0, 10.0, -15.0, 15.0 };
-            break;
-        case 7:
-            zona = { -30.0, 25.0, 10.0, 34.0 };
-            break;
-        case 8:
-            zona = { -30.0, 25.0, -34.0, -10.0 };
-            break;
-        case 9:
-            zona = { -5.0, 52.5, 10.0, 34.0 };
-            break;
-        case 10:
-            zona = { -10.0, 52.5, -15.0, 15.0 };
-            break;
-        case 11:
-            zona = { -5.0, 52.5, -34.0, -10.0 };
-            break;
-        default:
-            zona = { -52.5, 52.5, -34.0, 34.0 };
-            break;
-    }
-
-    if (p.side == Side::Right) {
-        // Invertir coordenadas X para el lado derecho
-        double x_min = -zona.x_max;
-        double x_max = -zona.x_min;
-        zona.x_min = x_min;
-        zona.x_max = x_max;
-        double y_min = -zona.y_max;
-        double y_max = -zona.y_min;
-        zona.y_min = y_min;
-        zona.y_max = y_max;
-    }
-
-    return zona;
-}
-
-// Función para obtener las dos mejores flags según la distancia y dirección
+// Función para obtener las dos mejores flags a partir de un mensaje de visión
 std::pair<FlagInfo, FlagInfo> getTwoBestFlags(const std::string &see_msg)
 {
     // Parseamos el mensaje "see_msg" para obtener todas las flags visibles
-    auto flags = parseVisibleFlags(see_msg);
+    std::array<FlagInfo, SeeInfo::MAX_FLAGS> flags;
+    std::size_t n = parseVisibleFlags(see_msg, flags);
+    return getTwoBestFlags(std::span<const FlagInfo>(flags.data(), n));
+}
 
+// Función para obtener las dos mejores flags según la distancia y dirección
+std::pair<FlagInfo, FlagInfo> getTwoBestFlags(std::span<const FlagInfo> flags)
+{
     if (flags.size() < 2)
         return {FlagInfo{}, FlagInfo{}};
 
     // Eliminar duplicados: Si hay varias entradas de la misma flag, nos quedamos con la más cercana
-    std::map<std::string, FlagInfo> unique;
-    for (auto &f : flags)
-        // Si la flag no está en el mapa o tiene una distancia menor, la agregamos
-        if (!unique.count(f.name) || f.dist < unique[f.name].dist)
-            unique[f.name] = f;
-
-    // Convertimos las flags únicas en un vector
-    std::vector<FlagInfo> v;
-    for (auto &kv : unique)
-        v.push_back(kv.second);
-
-    if (v.size() < 2)
+    std::array<std::uint8_t, FLAG_COUNT> slot; // posición de cada FlagId en v (0xFF = no vista)
+    slot.fill(0xFF);
+    std::array<FlagInfo, FLAG_COUNT> v;
+    std::size_t n = 0;
+    for (auto &f : flags) {
+        if (f.id >= FLAG_COUNT) continue;
+        // Si la flag no está aún o tiene una distancia menor, la guardamos
+        if (slot[f.id] == 0xFF) {
+            slot[f.id] = static_cast<std::uint8_t>(n);
+            v[n++] = f;
+        } else if (f.dist < v[slot[f.id]].dist) {
+            v[slot[f.id]] = f;
+        }
+    }
+
+    if (n < 2)
         return {FlagInfo{}, FlagInfo{}};
 
     // Inicializamos variables para encontrar las mejores dos flags
@@ -111,15 +64,15 @@ std::pair<FlagInfo, FlagInfo> getTwoBestFlags(const std::string &see_msg)
     const double MIN_ANG  = 0.001;
 
     // Comparamos todas las combinaciones posibles de flags para encontrar las mejores
-    for (size_t i = 0; i < v.size(); ++i) {
-        for (size_t j = i + 1; j < v.size(); ++j) {
+    for (size_t i = 0; i < n; ++i) {
+        for (size_t j = i + 1; j < n; ++j) {
 
             const auto &A = v[i]; // Primera flag
             const auto &B = v[j]; // Segunda flag
 
-            // Obtenemos las posiciones de las flags desde FLAG_POSITIONS
-            auto pA = FLAG_POSITIONS.at(A.name);
-            auto pB = FLAG_POSITIONS.at(B.name);
+            // Obtenemos las posiciones de las flags desde FLAG_TABLE
+            auto pA = flagPosition(A.id);
+            auto pB = flagPosition(B.id);
 
             // Calculamos la distancia entre las dos flags y la separación angular
             double dx = pB.x - pA.x;
@@ -152,11 +105,11 @@ std::pair<FlagInfo, FlagInfo> getTwoBestFlags(const std::string &see_msg)
 }
 
 // Función para calcular los puntos de intersección de dos circunferencias dadas sus posiciones y radios
-std::vector<Point> corteCircunferencias(
+int corteCircunferencias(
         float x1, float y1, float r1,
-        float x2, float y2, float r2)
+        float x2, float y2, float r2,
+        std::array<Point, 2> &out)
 {
-    std::vector<Point> res; // Vector para almacenar los puntos de intersección.
 
     // Calcular la distancia entre los centros de las circunferencias
     float dx = x2 - x1;
@@ -166,7 +119,7 @@ std::vector<Point> corteCircunferencias(
     // Si la distancia es mayor que la suma de los radios o menor que la diferencia absoluta
     // entre los radios, o si las circunferencias están concéntricas (d == 0), no hay intersección válida.
     if (d > r1 + r2 || d < std::fabs(r1 - r2) || d == 0) {
-        return res;
+        return 0;
     }
 
     // Calcular los puntos de intersección
@@ -183,9 +136,9 @@ std::vector<Point> corteCircunferencias(
     float xs2 = xm - h * dy / d;
     float ys2 = ym + h * dx / d;
 
-    res.push_back({xs1, ys1});
-    res.push_back({xs2, ys2});
-    return res;
+    out[0] = {xs1, ys1};
+    out[1] = {xs2, ys2};
+    return 2;
 }
 
 // Función para calcular la posición de un jugador basada en las dos flags visibles
@@ -194,8 +147,8 @@ Point calcularPosicionJugador(const std::pair<FlagInfo,FlagInfo>& flags, const P
     const auto& f1 = flags.first;
     const auto& f2 = flags.second;
 
-    Point p1 = FLAG_POSITIONS[f1.name];
-    Point p2 = FLAG_POSITIONS[f2.name];
+    Point p1 = flagPosition(f1.id);
+    Point p2 = flagPosition(f2.id);
 
     float x1 = p1.x, y1 = p1.y;
     float x2 = p2.x, y2 = p2.y;
@@ -204,24 +157,18 @@ Point calcularPosicionJugador(const std::pair<FlagInfo,FlagInfo>& flags, const P
     float r2 = f2.dist; // Distancia de la segunda flag
 
     double dx = x2 - x1, dy = y2 - y1;
-    double d = std::sqrt(dx*dx + dy*dy); // Distancia entre las dos flags
+    [[maybe_unused]] double d = std::sqrt(dx*dx + dy*dy); // Distancia entre las dos flags
 
-    std::cout << "[DEBUG] Centers: ("<<x1<<","<<y1<<") r1="<<r1
-              << " - ("<<x2<<","<<y2<<") r2="<<r2
-              << " ; d="<<d << std::endl;
+    LOG_DEBUG("Centers: ({},{}) r1={} - ({},{}) r2={} ; d={}", x1, y1, r1, x2, y2, r2, d);
 
-    auto puntos = corteCircunferencias(x1, y1, r1, x2, y2, r2);
+    std::array<Point, 2> puntos;
+    int n = corteCircunferencias(x1, y1, r1, x2, y2, r2, puntos);
 
     // Si no hay puntos de intersección, mantenemos la última posición conocida
-    if (puntos.empty()) {
+    if (n == 0) {
         return last_pos;
     }
 
-    // Si hay solo un punto de intersección, devolvemos ese punto
-    if (puntos.size() == 1) {
-        return puntos[0];
-    }
-
     auto& pA = puntos[0];
     auto& pB = puntos[1];
 
@@ -232,18 +179,16 @@ Point calcularPosicionJugador(const std::pair<FlagInfo,FlagInfo>& flags, const P
     return (dA < dB) ? pA : pB; // Devolvemos el punto más cercano
 }
 
-// Asegura que el ángulo esté entre -180 y 180
+// Asegura que el ángulo esté entre -180 y 180 (sin bucles: resta las vueltas completas)
 double normalizaAngulo(double ang){
-    while (ang > 180) ang -= 360;
-    while (ang < -180) ang += 360;
-    return ang;
+    return ang - 360.0 * std::nearbyint(ang / 360.0);
 }
 
 // Calcula la orientación absoluta hacia una flag (en grados)
 double calcularOrientacion(const Point& mi_pos, const FlagInfo& flag)
 {
     // Ángulo absoluto desde el jugador hacia la flag (Matemático CCW)
-    Point pFlag = FLAG_POSITIONS[flag.name];
+    Point pFlag = flagPosition(flag.id);
     double anguloAbsolutoAFlag = atan2(pFlag.y - mi_pos.y, pFlag.x - mi_pos.x) * 180.0 / M_PI;
 
     // Convertimos la dirección del servidor (CW) a dirección matemática (CCW)    
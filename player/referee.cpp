@@ -0,0 +1,188 @@
+#include "referee.h"
+#include "sexpr.h"
+#include "log.h"
+#include <array>
+#include <cstdint>
+
+namespace
+{
+
+// Entrada de la tabla: para los tokens con lado, ours es el modo cuando el
+// sufijo es el nuestro y theirs cuando es el del rival
+struct RefereeEntry
+{
+    std::string_view name;
+    bool sided;
+    PlayMode ours;
+    PlayMode theirs;
+    RefereeEvent event{RefereeEvent::None};
+    bool setsMode{true};
+};
+
+constexpr RefereeEntry unsided(std::string_view name, PlayMode mode)
+{
+    return {name, false, mode, mode};
+}
+
+constexpr RefereeEntry sided(std::string_view name, PlayMode ours, PlayMode theirs,
+                             RefereeEvent event = RefereeEvent::None, bool setsMode = true)
+{
+    return {name, true, ours, theirs, event, setsMode};
+}
+
+constexpr std::array REFEREE_TABLE = {
+    unsided("before_kick_off",          PlayMode::BeforeKickOff),
+    unsided("play_on",                  PlayMode::PlayOn),
+    unsided("time_over",                PlayMode::TimeOver),
+    unsided("time_up",                  PlayMode::TimeOver),
+    unsided("time_up_without_a_team",   PlayMode::TimeOver),
+    unsided("drop_ball",                PlayMode::DropBall),
+    unsided("first_half_over",          PlayMode::FirstHalfOver),
+    unsided("half_time",                PlayMode::FirstHalfOver),
+    unsided("pause",                    PlayMode::Pause),
+    unsided("human_judge",              PlayMode::HumanJudge),
+    unsided("penalty_draw",             PlayMode::PenaltyDraw),
+    RefereeEntry{"time_extended", false, PlayMode::Unknown, PlayMode::Unknown, RefereeEvent::TimeExtended, false},
+
+    sided("kick_off",                   PlayMode::OurKickOff,           PlayMode::TheirKickOff),
+    sided("kick_in",                    PlayMode::OurKickIn,            PlayMode::TheirKickIn),
+    sided("free_kick",                  PlayMode::OurFreeKick,          PlayMode::TheirFreeKick),
+    sided("indirect_free_kick",         PlayMode::OurIndirectFreeKick,  PlayMode::TheirIndirectFreeKick),
+    sided("corner_kick",                PlayMode::OurCorner,            PlayMode::TheirCorner),
+    sided("goal_kick",                  PlayMode::OurGoalKick,          PlayMode::TheirGoalKick),
+    sided("goalie_catch_ball",          PlayMode::OurGoalieCatch,       PlayMode::TheirGoalieCatch),
+    sided("goal",                       PlayMode::OurGoal,              PlayMode::TheirGoal, RefereeEvent::Goal),
+
+    sided("penalty_kick",               PlayMode::OurPenaltyKick,       PlayMode::TheirPenaltyKick),
+    sided("penalty_setup",              PlayMode::OurPenaltySetup,      PlayMode::TheirPenaltySetup),
+    sided("penalty_ready",              PlayMode::OurPenaltyReady,      PlayMode::TheirPenaltyReady),
+    sided("penalty_taken",              PlayMode::OurPenaltyTaken,      PlayMode::TheirPenaltyTaken),
+    sided("penalty_miss",               PlayMode::OurPenaltyMiss,       PlayMode::TheirPenaltyMiss),
+    sided("penalty_score",              PlayMode::OurPenaltyScore,      PlayMode::TheirPenaltyScore),
+    sided("penalty_winner",             PlayMode::OurPenaltyWinner,     PlayMode::TheirPenaltyWinner),
+    sided("penalty_onfield",            PlayMode::PenaltyOnField,       PlayMode::PenaltyOnField),
+    sided("penalty_foul",               PlayMode::PenaltyFoulByUs,      PlayMode::PenaltyFoulByThem),
+
+    sided("foul",                       PlayMode::FoulByUs,             PlayMode::FoulByThem),
+    sided("foul_charge",                PlayMode::FoulByUs,             PlayMode::FoulByThem),
+    sided("foul_push",                  PlayMode::FoulByUs,             PlayMode::FoulByThem),
+    sided("foul_multiple_attack",       PlayMode::FoulByUs,             PlayMode::FoulByThem),
+    sided("foul_ballout",               PlayMode::FoulByUs,             PlayMode::FoulByThem),
+    sided("offside",                    PlayMode::OffsideByUs,          PlayMode::OffsideByThem),
+    sided("back_pass",                  PlayMode::BackPassByUs,         PlayMode::BackPassByThem),
+    sided("free_kick_fault",            PlayMode::FreeKickFaultByUs,    PlayMode::FreeKickFaultByThem),
+    sided("catch_fault",                PlayMode::CatchFaultByUs,       PlayMode::CatchFaultByThem),
+    sided("illegal_defense",            PlayMode::IllegalDefenseByUs,   PlayMode::IllegalDefenseByThem),
+
+    sided("yellow_card",                PlayMode::Unknown, PlayMode::Unknown, RefereeEvent::YellowCard, false),
+    sided("red_card",                   PlayMode::Unknown, PlayMode::Unknown, RefereeEvent::RedCard, false),
+};
+
+// FNV-1a con semilla; la semilla se elige al compilar para que no haya colisiones
+constexpr std::uint32_t tokenHash(std::string_view s, std::uint32_t seed)
+{
+    std::uint32_t h = 2166136261u ^ seed;
+    for (char c : s) {
+        h ^= static_cast<std::uint8_t>(c);
+        h *= 16777619u;
+    }
+    return h;
+}
+
+constexpr std::size_t HASH_SLOTS = 256;
+constexpr std::uint8_t NO_ENTRY = 0xFF;
+
+static_assert(REFEREE_TABLE.size() < NO_ENTRY);
+
+constexpr std::uint32_t findSeed()
+{
+    for (std::uint32_t seed = 0; seed < 100000; ++seed) {
+        std::array<bool, HASH_SLOTS> used{};
+        bool ok = true;
+        for (const RefereeEntry &e : REFEREE_TABLE) {
+            std::size_t slot = tokenHash(e.name, seed) % HASH_SLOTS;
+            if (used[slot]) {
+                ok = false;
+                break;
+            }
+            used[slot] = true;
+        }
+        if (ok)
+            return seed;
+    }
+    return ~0u;
+}
+
+constexpr std::uint32_t HASH_SEED = findSeed();
+static_assert(HASH_SEED != ~0u, "no perfect hash seed for the referee table");
+
+constexpr std::array<std::uint8_t, HASH_SLOTS> HASH_INDEX = [] {
+    std::array<std::uint8_t, HASH_SLOTS> index{};
+    for (auto &slot : index)
+        slot = NO_ENTRY;
+    for (std::size_t i = 0; i < REFEREE_TABLE.size(); ++i)
+        index[tokenHash(REFEREE_TABLE[i].name, HASH_SEED) % HASH_SLOTS] = static_cast<std::uint8_t>(i);
+    return index;
+}();
+
+const RefereeEntry *findEntry(std::string_view name)
+{
+    std::uint8_t i = HASH_INDEX[tokenHash(name, HASH_SEED) % HASH_SLOTS];
+    if (i == NO_ENTRY || REFEREE_TABLE[i].name != name)
+        return nullptr;
+    return &REFEREE_TABLE[i];
+}
+
+bool isDigit(char c)
+{
+    return c >= '0' && c <= '9';
+}
+
+} // namespace
+
+RefereeMessage decodeReferee(std::string_view token, Side side)
+{
+    RefereeMessage msg;
+    std::string_view base = token;
+
+    // Número final: goal_l_3, yellow_card_r_7
+    std::size_t end = base.size();
+    while (end > 0 && isDigit(base[end - 1]))
+        --end;
+    if (end < base.size() && end > 0 && base[end - 1] == '_') {
+        msg.number = toInt(base.substr(end), -1);
+        base = base.substr(0, end - 1);
+    }
+
+    // Sufijo de lado
+    char sideChar = '\0';
+    if (base.size() > 2 && base[base.size() - 2] == '_' && (base.back() == 'l' || base.back() == 'r')) {
+        sideChar = base.back();
+        base.remove_suffix(2);
+    }
+
+    const RefereeEntry *e = findEntry(base);
+    if (!e || e->sided != (sideChar != '\0')) {
+        LOG_WARN("Unknown referee message: {}", token);
+        return msg;
+    }
+
+    char ourChar = side == Side::Right ? 'r' : 'l';
+    msg.known = true;
+    msg.setsMode = e->setsMode;
+    msg.ours = sideChar == ourChar;
+    msg.mode = (e->sided && !msg.ours) ? e->theirs : e->ours;
+    msg.event = e->event;
+    return msg;
+}
+
+void applyReferee(const RefereeMessage &msg, Side side, GameState &game)
+{
+    if (msg.setsMode)
+        game.playMode = msg.mode;
+
+    if (msg.event == RefereeEvent::Goal && msg.number >= 0) {
+        bool left = msg.ours == (side != Side::Right);
+        (left ? game.scoreLeft : game.scoreRight) = msg.number;
+    }
+}
@@ -0,0 +1,36 @@
+#pragma once
+
+#include "types.h"
+#include <string_view>
+
+// Decodificador de los mensajes del árbitro (hear ... referee <token>) con todo
+// el vocabulario de rcssserver v19. El token se separa en nombre base, sufijo
+// de lado (_l/_r) y número final (goal_l_3, yellow_card_r_7); el nombre base
+// se busca en una tabla con hash perfecto calculado al compilar, así que cada
+// mensaje cuesta un hash y una comparación. El modo resultante ya está
+// normalizado a nuestro/suyo según el lado del jugador.
+
+// Lo que aporta un mensaje además del modo de juego
+enum class RefereeEvent : std::uint8_t
+{
+    None,
+    Goal,           // number: goles del equipo que marca
+    YellowCard,     // number: dorsal amonestado
+    RedCard,        // number: dorsal expulsado
+    TimeExtended    // prórroga: el modo llega en el mensaje siguiente
+};
+
+struct RefereeMessage
+{
+    bool known{false};          // token reconocido
+    bool setsMode{false};       // cambia el modo de juego (tarjetas y prórroga no)
+    PlayMode mode{PlayMode::Unknown};
+    RefereeEvent event{RefereeEvent::None};
+    bool ours{false};           // el evento es de nuestro equipo (gol marcado, tarjeta recibida)
+    int number{-1};
+};
+
+RefereeMessage decodeReferee(std::string_view token, Side side);
+
+// Aplica el mensaje al estado del partido: modo de juego y marcador
+void applyReferee(const RefereeMessage &msg, Side side, GameState &game);
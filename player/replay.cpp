@@ -0,0 +1,165 @@
+// player_replay: reproduce una grabación (--record) sin servidor ni sockets.
+// Pasa cada datagrama por el mismo camino que el agente en vivo, vuelve a
+// decidir en cada ciclo en el que se envió un comando y comprueba que el
+// datagrama generado coincide byte a byte con el grabado. Informa del tiempo
+// de cada etapa.
+#include "agent.h"
+#include "args.h"
+#include "parsers.h"
+#include "localization.h"
+#include "trace.h"
+#include "log.h"
+#include "formation.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <string_view>
+
+// Tiempo acumulado de una etapa
+struct StageTimer
+{
+    const char *name;
+    std::uint64_t count{0};
+    std::int64_t totalNs{0};
+
+    template <typename F>
+    auto measure(F &&f)
+    {
+        auto t0 = std::chrono::steady_clock::now();
+        struct Done
+        {
+            StageTimer &timer;
+            std::chrono::steady_clock::time_point t0;
+            ~Done()
+            {
+                timer.totalNs += std::chrono::duration_cast<std::chrono::nanoseconds>(
+                    std::chrono::steady_clock::now() - t0).count();
+                ++timer.count;
+            }
+        } done{*this, t0};
+        return f();
+    }
+};
+
+struct ReplayResult
+{
+    std::uint64_t commands{0};
+    std::uint64_t mismatches{0};
+};
+
+enum Stage { PARSE_SEE, LOCALIZE, SEE, SENSE_BODY, HEAR, OTHER, DECIDE, STAGE_COUNT };
+
+static ReplayResult replayOnce(const TraceReader &trace, StageTimer *timers, bool report)
+{
+    ReplayResult result;
+    auto agent = std::make_unique<Agent>();
+    agent->team = trace.team();
+    agent->port = trace.port();
+    agent->player.team = trace.team();
+
+    PlayerInfo scratch;     // Para medir el parser y la localización por separado
+    const UdpAddress server{};
+
+    for (const TraceRecord &rec : trace.records()) {
+        std::string_view msg = rec.data;
+
+        if (rec.dir == TraceDirection::Out) {
+            // El agente en vivo decidió y envió aquí: repetir la decisión
+            char buf[COMMAND_MAX_SIZE];
+            std::size_t n = timers[DECIDE].measure([&] {
+                CommandFrame frame = decideCycleCommands(*agent);
+                agent->motion.onCommandSent(frame.body);
+                return frame.serialize(buf, sizeof(buf));
+            });
+
+            ++result.commands;
+            std::string_view got(buf, n);
+            if (got != msg) {
+                if (report && result.mismatches < 10) {
+                    std::printf("mismatch at t=%lld: recorded \"%.*s\", replayed \"%.*s\"\n",
+                                static_cast<long long>(rec.timestampNs),
+                                static_cast<int>(msg.size()), msg.data(),
+                                static_cast<int>(got.size()), got.data());
+                }
+                ++result.mismatches;
+            }
+            continue;
+        }
+
+        if (msg.rfind("(see", 0) == 0) {
+            scratch.side = agent->player.side;
+            timers[PARSE_SEE].measure([&] { parseSeeMsg(msg, scratch); });
+            timers[LOCALIZE].measure([&] { return localize(scratch.see.visibleFlags()); });
+            timers[SEE].measure([&] { handleServerMessage(*agent, msg, server); });
+        } else if (msg.rfind("(sense_body", 0) == 0) {
+            timers[SENSE_BODY].measure([&] { handleServerMessage(*agent, msg, server); });
+        } else if (msg.rfind("(hear", 0) == 0) {
+            timers[HEAR].measure([&] { handleServerMessage(*agent, msg, server); });
+        } else {
+            timers[OTHER].measure([&] { handleServerMessage(*agent, msg, server); });
+        }
+    }
+    return result;
+}
+
+int main(int argc, char *argv[])
+{
+    if (argc < 2 || argc % 2 != 0) {
+        std::printf("Usage: %s <trace-file> [--repeat N] [--formation FILE]\n", argv[0]);
+        return 1;
+    }
+    int repeat = 1;
+    for (int i = 2; i + 1 < argc; i += 2) {
+        std::string_view arg = argv[i];
+        if (arg == "--repeat") {
+            if (!parseArg(argv[i + 1], repeat, 1)) {
+                std::printf("Invalid --repeat %s\n", argv[i + 1]);
+                return 1;
+            }
+        } else if (arg == "--formation") {
+            // La grabación sólo se reproduce igual con la formación con la que se jugó
+            if (!loadActiveFormation(argv[i + 1])) {
+                std::printf("Cannot load formation %s\n", argv[i + 1]);
+                return 1;
+            }
+        } else {
+            std::printf("Unknown option %s\n", argv[i]);
+            return 1;
+        }
+    }
+
+    TraceReader trace;
+    if (!trace.load(argv[1])) {
+        std::printf("Cannot read trace %s\n", argv[1]);
+        return 1;
+    }
+
+    StageTimer timers[STAGE_COUNT] = {
+        {"parseSeeMsg"}, {"localize"}, {"see (total)"}, {"sense_body"}, {"hear"}, {"other"}, {"decide"}
+    };
+
+    auto t0 = std::chrono::steady_clock::now();
+    ReplayResult result;
+    for (int i = 0; i < repeat; ++i)
+        result = replayOnce(trace, timers, i == 0);
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+
+    std::printf("trace: %s (team %s, port %u), %zu records, %d run(s) in %.3f s\n",
+                argv[1], trace.team().c_str(), trace.port(), trace.records().size(), repeat, seconds);
+    std::printf("%-14s %12s %14s %12s\n", "stage", "calls", "total ms", "ns/call");
+    for (const StageTimer &t : timers) {
+        if (t.count == 0)
+            continue;
+        std::printf("%-14s %12llu %14.3f %12.0f\n", t.name,
+                    static_cast<unsigned long long>(t.count), t.totalNs / 1e6,
+                    static_cast<double>(t.totalNs) / static_cast<double>(t.count));
+    }
+    std::printf("commands: %llu, mismatches: %llu\n",
+                static_cast<unsigned long long>(result.commands),
+                static_cast<unsigned long long>(result.mismatches));
+
+    logShutdown();
+    return result.mismatches == 0 ? 0 : 2;
+}
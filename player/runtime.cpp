@@ -0,0 +1,85 @@
+#include "runtime.h"
+#include "agent.h"
+#include "log.h"
+#include "metrics.h"
+#include <algorithm>
+#include <chrono>
+#include <memory>
+#include <thread>
+
+int runTeamRuntime(const RuntimeOptions &options)
+{
+    auto t0 = std::chrono::steady_clock::now();
+
+    // Cada agente en su propia reserva alineada a línea de caché
+    std::vector<std::unique_ptr<Agent>> agents;
+    for (const auto &team : options.teams) {
+        for (int i = 0; i < team.players; ++i) {
+            auto agent = std::make_unique<Agent>();
+            auto port = static_cast<std::uint16_t>(team.firstPort + i);
+            if (!options.recordDir.empty()) {
+                std::string path = options.recordDir + "/" + team.name + "_" + std::to_string(port) + ".rstrace";
+                if (!agent->trace.open(path, team.name, port)) {
+                    LOG_ERROR("Cannot open trace file {}", path);
+                    return 1;
+                }
+            }
+            agent->goalie = i == 0;     // El primero de cada equipo es el portero
+            agent->synch = options.synch;
+            if (!startAgent(*agent, team.name, port, options.server, options.sendOffsetNs))
+                return 1;
+            agents.push_back(std::move(agent));
+        }
+    }
+
+    if (agents.empty()) {
+        LOG_ERROR("No agents to run");
+        return 1;
+    }
+
+    auto startup = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0);
+    LOG_INFO("Started {} agents in {} ms", agents.size(), startup.count());
+
+    // Un único endpoint por proceso con las métricas de todos sus agentes
+    MetricsServer metrics;
+    if (!options.metricsDir.empty()) {
+        std::vector<const AgentMetrics *> all;
+        for (const auto &agent : agents)
+            all.push_back(&agent->metrics);
+        if (!metrics.start(options.metricsDir, std::move(all)))
+            return 1;
+    }
+
+    // Búsqueda anytime de los agentes con balón en el tiempo que queda hasta cada envío.
+    // Se destruye antes que los agentes: ningún hilo sigue buscando sobre uno ya liberado.
+    // En modo síncrono no hay tiempo hasta el envío: la búsqueda es la corta al decidir.
+    // Al grabar, también: la cadena anytime depende del reloj y player_replay no la reproduciría.
+    std::unique_ptr<PlannerPool> planner;
+    if (options.planThreads > 0 && options.synch) {
+        LOG_WARN("--plan-threads ignored in synch mode");
+    } else if (options.planThreads > 0 && !options.recordDir.empty()) {
+        LOG_WARN("--plan-threads ignored with --record: replay needs the synchronous search");
+    } else if (options.planThreads > 0) {
+        planner = std::make_unique<PlannerPool>(options.planThreads);
+        for (const auto &agent : agents)
+            agent->planner = planner.get();
+        LOG_INFO("Planner running on {} threads", options.planThreads);
+    }
+
+    // Repartir los agentes en round-robin entre los hilos de trabajo
+    int threads = std::clamp<int>(options.threads, 1, static_cast<int>(agents.size()));
+    std::vector<std::vector<Agent *>> shards(threads);
+    for (std::size_t i = 0; i < agents.size(); ++i)
+        shards[i % threads].push_back(agents[i].get());
+
+    std::vector<std::thread> workers;
+    for (int t = 1; t < threads; ++t)
+        workers.emplace_back([&shards, t] { runAgentLoop(shards[t]); });
+
+    // El hilo principal atiende el primer grupo
+    int rc = runAgentLoop(shards[0]);
+
+    for (auto &w : workers)
+        w.join();
+    return rc;
+}
@@ -0,0 +1,35 @@
+#pragma once
+
+#include "net.h"
+#include "cycle.h"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Equipo alojado en el runtime: nombre, primer puerto local y número de jugadores
+struct TeamSpec
+{
+    std::string name;
+    std::uint16_t firstPort{7001};
+    int players{11};
+};
+
+// Opciones del modo multiagente (un proceso para uno o dos equipos)
+struct RuntimeOptions
+{
+    std::vector<TeamSpec> teams;
+    int threads{2};                                   // Hilos de trabajo que reparten a los agentes
+    int planThreads{0};                               // Hilos del planificador (0: búsqueda corta al decidir)
+    std::int64_t sendOffsetNs{DEFAULT_SEND_OFFSET_NS};
+    UdpAddress server{UdpAddress::make("127.0.0.1", 6000)};
+    std::string recordDir;                            // Si no está vacío, graba el tráfico de cada agente aquí
+    std::string metricsDir;                           // Si no está vacío, sirve las métricas en un socket Unix aquí
+    bool synch{false};                                // Servidor en synch_mode: decidir al recibir (think)
+};
+
+// Arranca todos los agentes (un socket UDP por agente) y los reparte entre
+// un pequeño grupo de hilos, cada uno con su propio bucle epoll.
+// Las tablas inmutables (banderas, posiciones de saque, zonas) son únicas
+// en el proceso y se comparten entre todos los agentes, igual que el grupo de
+// hilos del planificador.
+int runTeamRuntime(const RuntimeOptions &options);
@@ -0,0 +1,106 @@
+#pragma once
+
+#include <charconv>
+#include <string_view>
+
+// Cursor de lectura sobre un mensaje S-expression del servidor.
+// Recorre el datagrama una sola vez, sin copias ni reservas de memoria:
+// los átomos se devuelven como string_view sobre el propio mensaje y los
+// números se decodifican con std::from_chars (sin excepciones).
+struct SExprCursor
+{
+    const char *p{nullptr};
+    const char *end{nullptr};
+
+    SExprCursor() = default;
+    explicit SExprCursor(std::string_view sv) : p(sv.data()), end(sv.data() + sv.size()) {}
+
+    bool atEnd() const { return p >= end; }
+
+    // Salta espacios y terminadores nulos (el servidor añade '\0' al final)
+    void skipSpaces()
+    {
+        while (p < end && (*p == ' ' || *p == '\0' || *p == '\n' || *p == '\t')) ++p;
+    }
+
+    // Devuelve el siguiente carácter significativo sin consumirlo
+    char peek()
+    {
+        skipSpaces();
+        return p < end ? *p : '\0';
+    }
+
+    // Consume el carácter c si es el siguiente
+    bool consume(char c)
+    {
+        skipSpaces();
+        if (p < end && *p == c) {
+            ++p;
+            return true;
+        }
+        return false;
+    }
+
+    // Siguiente átomo: secuencia hasta espacio o paréntesis.
+    // Las comillas de los nombres de equipo ("RealSuciedad") se eliminan.
+    std::string_view atom()
+    {
+        skipSpaces();
+        if (p < end && *p == '"') {
+            const char *start = ++p;
+            while (p < end && *p != '"') ++p;
+            std::string_view tok(start, p - start);
+            if (p < end) ++p;
+            return tok;
+        }
+        const char *start = p;
+        while (p < end && *p != ' ' && *p != '(' && *p != ')' && *p != '\0') ++p;
+        return std::string_view(start, p - start);
+    }
+
+    // Lee un número si el siguiente átomo lo es; si no, no avanza
+    template <typename T>
+    bool number(T &out)
+    {
+        skipSpaces();
+        const char *start = p;
+        auto [ptr, ec] = std::from_chars(start, end, out);
+        if (ec != std::errc{} || (ptr < end && *ptr != ' ' && *ptr != ')' && *ptr != '(' && *ptr != '\0')) {
+            return false;
+        }
+        p = ptr;
+        return true;
+    }
+
+    // Devuelve el texto hasta el ')' que cierra la lista actual (sin anidar)
+    // y deja el cursor después de ese ')'
+    std::string_view untilClose()
+    {
+        skipSpaces();
+        const char *start = p;
+        while (p < end && *p != ')') ++p;
+        const char *stop = p;
+        while (stop > start && stop[-1] == ' ') --stop;
+        if (p < end) ++p;
+        return std::string_view(start, stop - start);
+    }
+
+    // Salta el resto de la lista actual, incluidas sublistas, hasta su ')'
+    void skipList()
+    {
+        int depth = 1;
+        while (p < end && depth > 0) {
+            if (*p == '(') ++depth;
+            else if (*p == ')') --depth;
+            ++p;
+        }
+    }
+};
+
+// Convierte un átomo entero sin excepciones; devuelve fallback si no es válido
+inline int toInt(std::string_view tok, int fallback = 0)
+{
+    int value = fallback;
+    auto [ptr, ec] = std::from_chars(tok.data(), tok.data() + tok.size(), value);
+    return (ec == std::errc{} && ptr == tok.data() + tok.size()) ? value : fallback;
+}
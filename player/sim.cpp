@@ -0,0 +1,687 @@
+#include "sim.h"
+#include "comm.h"
+#include "command.h"
+#include "decisions.h"
+#include "flags.h"
+#include "localization.h"
+#include "motion.h"
+#include "parsers.h"
+#include "planner.h"
+#include "positions.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <memory>
+
+static constexpr double DEG = M_PI / 180.0;
+
+// Parámetros de rcssserver v19 (tipo de jugador 0)
+static constexpr double PLAYER_DECAY = 0.4;
+static constexpr double INERTIA_MOMENT = 5.0;
+static constexpr double BALL_DECAY = 0.94;
+static constexpr double PLAYER_SPEED_MAX = 1.05;
+static constexpr double PLAYER_RAND = 0.1;
+static constexpr double DASH_POWER_RATE = 0.006;
+static constexpr double SIDE_DASH_RATE = 0.4;
+static constexpr double BACK_DASH_RATE = 0.7;
+static constexpr double PLAYER_SIZE = 0.3;
+static constexpr double BALL_SIZE = 0.085;
+static constexpr double KICKABLE_MARGIN = 0.7;
+static constexpr double KICKABLE_DIST = KICKABLE_MARGIN + PLAYER_SIZE + BALL_SIZE;
+static constexpr double KICK_POWER_RATE = 0.027;
+static constexpr double KICK_RAND = 0.1;
+static constexpr double BALL_SPEED_MAX = 3.0;
+static constexpr double BALL_ACCEL_MAX = 2.7;
+static constexpr double BALL_RAND = 0.05;
+
+static constexpr double STAMINA_MAX = 8000.0;
+static constexpr double STAMINA_INC_MAX = 45.0;
+static constexpr double STAMINA_CAPACITY = 130600.0;
+static constexpr double EXTRA_STAMINA = 50.0;
+static constexpr double RECOVER_DEC_THR = 0.3;
+static constexpr double RECOVER_DEC = 0.002;
+static constexpr double RECOVER_MIN = 0.5;
+static constexpr double EFFORT_DEC_THR = 0.3;
+static constexpr double EFFORT_DEC = 0.005;
+static constexpr double EFFORT_INC_THR = 0.6;
+static constexpr double EFFORT_INC = 0.01;
+static constexpr double EFFORT_MIN = 0.6;
+
+static constexpr double VISIBLE_COS = 0.5;   // cos(60º): media amplitud de la vista normal
+static constexpr double UNUM_FAR_LENGTH = 20.0;
+static constexpr double TEAM_FAR_LENGTH = 40.0;
+static constexpr double QUANTIZE_STEP = 0.1;
+static constexpr double QUANTIZE_STEP_LANDMARK = 0.01;
+static constexpr double AUDIO_CUT_DIST = 50.0;
+
+static constexpr double FIELD_LIMIT_X = PITCH_HALF_LENGTH + PITCH_MARGIN;
+static constexpr double FIELD_LIMIT_Y = PITCH_HALF_WIDTH + PITCH_MARGIN;
+static constexpr double KICK_OFF_CLEARANCE = 9.15;
+static constexpr double CORNER_KICK_MARGIN = 1.0;
+static constexpr double GOAL_AREA_X = PITCH_HALF_LENGTH - 5.5;
+static constexpr double GOAL_AREA_Y = 9.16;
+
+static constexpr int KICK_OFF_WAIT = 10;         // ciclos de colocación antes del primer saque
+static constexpr int AFTER_GOAL_CYCLES = 50;
+static constexpr int DROP_BALL_CYCLES = 100;      // saque no ejecutado: balón a tierra
+
+// Partidos que avanzan juntos en un hilo: sus agentes (unos 5 KB por jugador)
+// caben en la caché de segundo nivel mientras se juega el bloque
+static constexpr std::size_t SIM_BLOCK = 16;
+
+static constexpr FlagId FLAG_GOAL_L = lookupFlag("g l");
+static constexpr FlagId FLAG_GOAL_R = lookupFlag("g r");
+
+// Agente de un jugador simulado y lo que habla cada equipo en el ciclo
+struct SimBatch::Block
+{
+    struct Agent
+    {
+        PlayerInfo player{};
+        GameState game{};
+        MotionModel motion{};
+        bool fresh{false};     // hay estimación nueva sobre la que decidir
+    };
+
+    struct Say
+    {
+        std::array<char, SAY_MAX_SIZE> text{};
+        std::uint8_t len{0};
+        int sender{0};         // índice del jugador en el partido
+    };
+
+    std::size_t first{0};
+    std::vector<Agent> agents;                     // SIM_BLOCK * SIM_PLAYERS
+    std::vector<std::array<Say, 2>> says;          // SIM_BLOCK
+    std::array<Command, SIM_PLAYERS> commands{};
+    ChainSearch search;
+
+    Agent &agent(std::size_t e, int p) { return agents[(e - first) * SIM_PLAYERS + static_cast<std::size_t>(p)]; }
+};
+
+// --- Utilidades ---------------------------------------------------------------
+
+// xorshift64*: uniforme en [-1, 1)
+static double uniform(std::uint64_t &state)
+{
+    state ^= state >> 12;
+    state ^= state << 25;
+    state ^= state >> 27;
+    std::uint64_t r = state * 0x2545F4914F6CDD1DULL;
+    return static_cast<double>(r >> 11) * (2.0 / 9007199254740992.0) - 1.0;
+}
+
+static std::uint64_t seedFor(std::uint64_t seed, std::size_t episode)
+{
+    // splitmix64: semillas independientes por partido, nunca cero
+    std::uint64_t z = seed + 0x9E3779B97F4A7C15ULL * (episode + 1);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    z ^= z >> 31;
+    return z ? z : 1;
+}
+
+// Cuantización de distancias de rcssserver: log(d) en pasos de qstep, luego 0.1
+static double quantizeDist(double d, double qstep)
+{
+    double q = std::exp(std::rint(std::log(d + 1e-10) / qstep) * qstep);
+    return std::rint(q / 0.1) * 0.1;
+}
+
+static int teamOf(int p) { return p / SIM_TEAM_SIZE; }
+
+static bool isSetPiece(SimMode m)
+{
+    return m == SimMode::KickOff || m == SimMode::KickIn || m == SimMode::CornerKick || m == SimMode::GoalKick;
+}
+
+// Variación radial y angular (convenio horario) de un objeto que se mueve con
+// velocidad relativa (rvx, rvy) a distancia dist en la dirección unitaria (ex, ey)
+static void changeOf(double ex, double ey, double dist, double rvx, double rvy, double &distChg, double &dirChg)
+{
+    distChg = std::rint((rvx * ex + rvy * ey) / 0.02) * 0.02;
+    dirChg = std::rint(-(ex * rvy - ey * rvx) / std::max(dist, 1e-6) / DEG / 0.1) * 0.1;
+}
+
+// --- Integración por columnas -------------------------------------------------
+
+// Ruido, límite de velocidad, avance, decaimiento y recuperación de
+// resistencia de los jugadores [begin, end)
+static void integratePlayers(SimState &s, std::size_t begin, std::size_t end)
+{
+    double *px = s.px.data(), *py = s.py.data(), *vx = s.vx.data(), *vy = s.vy.data();
+    double *stamina = s.stamina.data(), *effort = s.effort.data();
+    double *recovery = s.recovery.data(), *capacity = s.capacity.data();
+    const double *nx = s.noiseX.data(), *ny = s.noiseY.data();
+
+    for (std::size_t i = begin; i < end; ++i) {
+        double r = PLAYER_RAND * std::sqrt(vx[i] * vx[i] + vy[i] * vy[i]);
+        double x = vx[i] + nx[i] * r;
+        double y = vy[i] + ny[i] * r;
+        double speed = std::sqrt(x * x + y * y);
+        double scale = speed > PLAYER_SPEED_MAX ? PLAYER_SPEED_MAX / speed : 1.0;
+        x *= scale;
+        y *= scale;
+        px[i] = std::clamp(px[i] + x, -FIELD_LIMIT_X, FIELD_LIMIT_X);
+        py[i] = std::clamp(py[i] + y, -FIELD_LIMIT_Y, FIELD_LIMIT_Y);
+        vx[i] = x * PLAYER_DECAY;
+        vy[i] = y * PLAYER_DECAY;
+
+        double st = stamina[i];
+        double rec = st <= RECOVER_DEC_THR * STAMINA_MAX ? std::max(RECOVER_MIN, recovery[i] - RECOVER_DEC) : recovery[i];
+        double eff = st <= EFFORT_DEC_THR * STAMINA_MAX ? std::max(EFFORT_MIN, effort[i] - EFFORT_DEC) : effort[i];
+        eff = st >= EFFORT_INC_THR * STAMINA_MAX ? std::min(1.0, eff + EFFORT_INC) : eff;
+        double inc = std::min(std::min(STAMINA_INC_MAX * rec, STAMINA_MAX - st), capacity[i]);
+        stamina[i] = st + inc;
+        capacity[i] -= inc;
+        recovery[i] = rec;
+        effort[i] = eff;
+    }
+}
+
+// Aceleración de los chutes, ruido, límite de velocidad, avance y decaimiento
+// del balón de los partidos [begin, end)
+static void integrateBall(SimState &s, std::size_t begin, std::size_t end)
+{
+    double *bx = s.bx.data(), *by = s.by.data(), *bvx = s.bvx.data(), *bvy = s.bvy.data();
+    double *bax = s.bax.data(), *bay = s.bay.data();
+    const double *nx = s.bnoiseX.data(), *ny = s.bnoiseY.data();
+
+    for (std::size_t e = begin; e < end; ++e) {
+        double accel = std::sqrt(bax[e] * bax[e] + bay[e] * bay[e]);
+        double scale = accel > BALL_ACCEL_MAX ? BALL_ACCEL_MAX / accel : 1.0;
+        double x = bvx[e] + bax[e] * scale;
+        double y = bvy[e] + bay[e] * scale;
+        double r = BALL_RAND * std::sqrt(x * x + y * y);
+        x += nx[e] * r;
+        y += ny[e] * r;
+        double speed = std::sqrt(x * x + y * y);
+        scale = speed > BALL_SPEED_MAX ? BALL_SPEED_MAX / speed : 1.0;
+        x *= scale;
+        y *= scale;
+        bx[e] += x;
+        by[e] += y;
+        bvx[e] = x * BALL_DECAY;
+        bvy[e] = y * BALL_DECAY;
+        bax[e] = 0.0;
+        bay[e] = 0.0;
+    }
+}
+
+void SimState::resize(std::size_t episodes)
+{
+    const std::size_t n = episodes * SIM_PLAYERS;
+    for (auto *col : {&px, &py, &vx, &vy, &body, &stamina, &effort, &recovery, &capacity, &noiseX, &noiseY})
+        col->assign(n, 0.0);
+    counters.assign(n, CommandCounters{});
+
+    for (auto *col : {&bx, &by, &bvx, &bvy, &bax, &bay, &bnoiseX, &bnoiseY})
+        col->assign(episodes, 0.0);
+    mode.assign(episodes, SimMode::BeforeKickOff);
+    modeSide.assign(episodes, 0);
+    modeStart.assign(episodes, 0);
+    setPieceTaken.assign(episodes, 0);
+    lastKicker.assign(episodes, -1);
+    rng.assign(episodes, 1);
+}
+
+// --- Partido ------------------------------------------------------------------
+
+SimBatch::SimBatch(std::size_t episodes, const SimConfig &config) : config_(config), results_(episodes)
+{
+    state_.resize(episodes);
+}
+
+void SimBatch::reset(Block &block, std::size_t e)
+{
+    SimState &s = state_;
+    s.rng[e] = seedFor(config_.seed, e);
+    s.bx[e] = s.by[e] = s.bvx[e] = s.bvy[e] = s.bax[e] = s.bay[e] = 0.0;
+    s.mode[e] = SimMode::BeforeKickOff;
+    s.modeSide[e] = 0;
+    s.modeStart[e] = 0;
+    s.setPieceTaken[e] = 0;
+    s.lastKicker[e] = -1;
+    results_[e] = SimResult{};
+    block.says[e - block.first] = {};
+
+    char init[48];
+    for (int p = 0; p < SIM_PLAYERS; ++p) {
+        const std::size_t i = e * SIM_PLAYERS + p;
+        const int team = teamOf(p);
+        const int unum = p % SIM_TEAM_SIZE + 1;
+
+        // Fuera del campo, como al conectarse: el primer move los coloca
+        s.px[i] = (team == 0 ? -3.0 : 3.0) * unum;
+        s.py[i] = -PITCH_HALF_WIDTH - 3.0;
+        s.vx[i] = s.vy[i] = 0.0;
+        s.body[i] = team == 0 ? 0.0 : 180.0;
+        s.stamina[i] = STAMINA_MAX;
+        s.effort[i] = 1.0;
+        s.recovery[i] = 1.0;
+        s.capacity[i] = STAMINA_CAPACITY;
+        s.counters[i] = CommandCounters{};
+
+        Block::Agent &a = block.agent(e, p);
+        a.player = PlayerInfo{};
+        a.player.team = team == 0 ? "SimLeft" : "SimRight";
+        a.game = GameState{};
+        a.motion = MotionModel{};
+        a.fresh = false;
+        std::snprintf(init, sizeof(init), "(init %c %d before_kick_off)", team == 0 ? 'l' : 'r', unum);
+        parseInitMsg(init, a.player, a.game);
+    }
+}
+
+void SimBatch::announce(Block &block, std::size_t e, int time, const char *token)
+{
+    char msg[64];
+    std::snprintf(msg, sizeof(msg), "(hear %d referee %s)", time, token);
+    for (int p = 0; p < SIM_PLAYERS; ++p) {
+        Block::Agent &a = block.agent(e, p);
+        parseHearMsg(msg, a.player, a.game);
+        a.motion.onHear(a.player, a.game.time);
+    }
+}
+
+// Percepciones del ciclo: lo dicho el ciclo anterior, sense_body y, en dos de
+// cada tres ciclos (vista normal, calidad alta), see
+void SimBatch::perceive(Block &block, std::size_t e, int time)
+{
+    const SimState &s = state_;
+    const std::size_t base = e * SIM_PLAYERS;
+
+    auto &says = block.says[e - block.first];
+    for (int team = 0; team < 2; ++team) {
+        Block::Say &say = says[team];
+        if (say.len == 0)
+            continue;
+        char msg[64];
+        std::snprintf(msg, sizeof(msg), "(hear %d 0 our %d \"%.*s\")", time - 1, say.sender % SIM_TEAM_SIZE + 1,
+                      static_cast<int>(say.len), say.text.data());
+        const std::size_t from = base + static_cast<std::size_t>(say.sender);
+        for (int p = team * SIM_TEAM_SIZE; p < (team + 1) * SIM_TEAM_SIZE; ++p) {
+            const std::size_t i = base + p;
+            if (p == say.sender || std::hypot(s.px[i] - s.px[from], s.py[i] - s.py[from]) > AUDIO_CUT_DIST)
+                continue;
+            Block::Agent &a = block.agent(e, p);
+            parseHearMsg(msg, a.player, a.game);
+            a.motion.onHear(a.player, a.game.time);
+        }
+        say.len = 0;
+    }
+
+    const double ballX = s.bx[e], ballY = s.by[e];
+    for (int p = 0; p < SIM_PLAYERS; ++p) {
+        const std::size_t i = base + p;
+        Block::Agent &a = block.agent(e, p);
+        PlayerInfo &player = a.player;
+        const double face = s.body[i];   // sin turn_neck el cuello sigue al cuerpo
+
+        SenseInfo &sense = player.sense;
+        double speed = std::hypot(s.vx[i], s.vy[i]);
+        sense.time = time;
+        sense.stamina = std::rint(s.stamina[i]);
+        sense.effort = s.effort[i];
+        sense.capacity = std::rint(s.capacity[i]);
+        sense.speed = std::rint(speed / 0.01) * 0.01;
+        sense.speedDir = speed > 1e-6 ? std::rint(-normalizaAngulo(std::atan2(s.vy[i], s.vx[i]) / DEG - face)) : 0.0;
+        sense.headAngle = 0.0;
+        sense.counters = s.counters[i];
+        if (a.motion.onSenseBody(player))
+            a.fresh = true;
+
+        if ((time + p) % 3 == 2)
+            continue;
+
+        SeeInfo &see = player.see;
+        see.time = time;
+        see.ball = ObjectInfo{};
+        see.ownGoal = ObjectInfo{};
+        see.oppGoal = ObjectInfo{};
+        see.numFlags = 0;
+        see.numLines = 0;
+        see.players.clear();
+
+        const double x = s.px[i], y = s.py[i];
+        const double fx = std::cos(face * DEG), fy = std::sin(face * DEG);
+        // El cono de visión se comprueba con un producto escalar; atan2 sólo para lo que se ve
+        auto inView = [&](double tx, double ty, double dist) { return (tx - x) * fx + (ty - y) * fy >= VISIBLE_COS * dist; };
+        auto relDir = [&](double tx, double ty) { return -normalizaAngulo(std::atan2(ty - y, tx - x) / DEG - face); };
+
+        for (std::size_t f = 0; f < FLAG_COUNT && see.numFlags < SeeInfo::MAX_FLAGS; ++f) {
+            const Point pos = FLAG_TABLE[f].pos;
+            double raw = std::hypot(pos.x - x, pos.y - y);
+            if (!inView(pos.x, pos.y, raw))
+                continue;
+            ObjectInfo obj{quantizeDist(raw, QUANTIZE_STEP_LANDMARK), std::rint(relDir(pos.x, pos.y)), true};
+            if (f == FLAG_GOAL_L || f == FLAG_GOAL_R)
+                ((f == FLAG_GOAL_L) == (player.side == Side::Left) ? see.ownGoal : see.oppGoal) = obj;
+            see.flags[see.numFlags++] = FlagInfo{static_cast<FlagId>(f), obj.dist, obj.dir, true, pos};
+        }
+
+        double ballRaw = std::hypot(ballX - x, ballY - y);
+        if (inView(ballX, ballY, ballRaw)) {
+            double raw = ballRaw;
+            double ex = (ballX - x) / std::max(raw, 1e-6), ey = (ballY - y) / std::max(raw, 1e-6);
+            ObjectInfo &ball = see.ball;
+            ball = ObjectInfo{quantizeDist(raw, QUANTIZE_STEP), std::rint(relDir(ballX, ballY)), true, true};
+            changeOf(ex, ey, raw, s.bvx[e] - s.vx[i], s.bvy[e] - s.vy[i], ball.distChange, ball.dirChange);
+        }
+
+        SeenPlayers &seen = see.players;
+        for (int q = 0; q < SIM_PLAYERS; ++q) {
+            const std::size_t j = base + q;
+            if (q == p)
+                continue;
+            double raw = std::hypot(s.px[j] - x, s.py[j] - y);
+            if (!inView(s.px[j], s.py[j], raw))
+                continue;
+            std::size_t k = seen.size++;
+            seen.dist[k] = quantizeDist(raw, QUANTIZE_STEP);
+            seen.dir[k] = std::rint(relDir(s.px[j], s.py[j]));
+            seen.team[k] = raw > TEAM_FAR_LENGTH ? TeamSide::Unknown
+                         : teamOf(q) == teamOf(p) ? TeamSide::Own : TeamSide::Opp;
+            seen.number[k] = -1;
+            seen.fields[k] = SEEN_NONE;
+            seen.distChange[k] = seen.dirChange[k] = 0.0;
+            seen.bodyDir[k] = seen.headDir[k] = seen.pointDir[k] = 0.0;
+            if (raw <= UNUM_FAR_LENGTH) {
+                const int unum = q % SIM_TEAM_SIZE + 1;
+                seen.number[k] = static_cast<std::int8_t>(unum);
+                seen.fields[k] = SEEN_CHANGE | SEEN_FACING | (unum == 1 ? SEEN_GOALIE : SEEN_NONE);
+                double ex = (s.px[j] - x) / std::max(raw, 1e-6), ey = (s.py[j] - y) / std::max(raw, 1e-6);
+                changeOf(ex, ey, raw, s.vx[j] - s.vx[i], s.vy[j] - s.vy[i], seen.distChange[k], seen.dirChange[k]);
+                seen.bodyDir[k] = seen.headDir[k] = std::rint(-normalizaAngulo(s.body[j] - face));
+            }
+        }
+
+        // Igual que el agente tras un see: pose por banderas y modelo de movimiento
+        PoseEstimate pose = localize(see.visibleFlags());
+        if (pose.valid) {
+            player.x_abs = static_cast<float>(pose.pos.x);
+            player.y_abs = static_cast<float>(pose.pos.y);
+            player.dir_abs = static_cast<float>(normalizaAngulo(pose.dir + sense.headAngle));
+        }
+        a.motion.onSee(player, pose.valid);
+        a.fresh = true;
+    }
+}
+
+// Decisiones de los 22 agentes y su ejecución por el servidor
+void SimBatch::decide(Block &block, std::size_t e, int time)
+{
+    SimState &s = state_;
+    const std::size_t base = e * SIM_PLAYERS;
+    std::uint64_t &rng = s.rng[e];
+
+    for (int p = 0; p < SIM_PLAYERS; ++p) {
+        Block::Agent &a = block.agent(e, p);
+        Command &cmd = block.commands[p];
+        cmd = Command{};
+        if (!a.fresh)
+            continue;
+        a.fresh = false;
+
+        const ActionChain *plan = nullptr;
+        if (config_.policy[teamOf(p)] == SimPolicy::Plan && hasBall(a.player)) {
+            block.search.start(PlanWorld::from(a.player));
+            while (block.search.nodes() < PLAN_SYNC_NODES && block.search.step(1)) {
+            }
+            plan = &block.search.best();
+        }
+        cmd = decideAction(a.player, a.game, plan);
+        if (!cmd.empty())
+            a.motion.onCommandSent(cmd);
+
+        if (config_.say && isSayTurn(time, a.player.number)) {
+            Command say = composeSay(a.player, a.motion.ball(), time);
+            if (!say.empty()) {
+                Block::Say &out = block.says[e - block.first][teamOf(p)];
+                out.text = say.text;
+                out.len = say.textLen;
+                out.sender = p;
+                ++s.counters[base + p].say;
+            }
+        }
+    }
+
+    // Ejecución simultánea: todos decidieron sobre el mismo estado
+    const SimMode mode = s.mode[e];
+    const bool canMove = mode == SimMode::BeforeKickOff || mode == SimMode::AfterGoal;
+    for (int p = 0; p < SIM_PLAYERS; ++p) {
+        const std::size_t i = base + p;
+        const Command &cmd = block.commands[p];
+        const int team = teamOf(p);
+        CommandCounters &counters = s.counters[i];
+
+        switch (cmd.type) {
+            case CommandType::Dash: {
+                double power = std::clamp(cmd.a, -100.0, 100.0);
+                double dir = std::rint(std::clamp(cmd.b, -180.0, 180.0));
+                const bool back = power < 0.0;
+                double need = back ? -2.0 * power : power;
+                if (need > s.stamina[i] + EXTRA_STAMINA) {
+                    need = s.stamina[i] + EXTRA_STAMINA;
+                    power = back ? -need / 2.0 : need;
+                }
+                s.stamina[i] = std::max(0.0, s.stamina[i] - need);
+                double adir = std::fabs(dir);
+                double dirRate = adir > 90.0 ? BACK_DASH_RATE - (BACK_DASH_RATE - SIDE_DASH_RATE) * (1.0 - (adir - 90.0) / 90.0)
+                                             : SIDE_DASH_RATE + (1.0 - SIDE_DASH_RATE) * (1.0 - adir / 90.0);
+                double accel = std::fabs(s.effort[i] * power * std::clamp(dirRate, 0.0, 1.0)) * DASH_POWER_RATE;
+                double a = (s.body[i] - dir - (back ? 180.0 : 0.0)) * DEG;
+                s.vx[i] += accel * std::cos(a);
+                s.vy[i] += accel * std::sin(a);
+                ++counters.dash;
+                break;
+            }
+            case CommandType::Turn: {
+                double speed = std::hypot(s.vx[i], s.vy[i]);
+                double moment = std::clamp(cmd.a, -180.0, 180.0) * (1.0 + PLAYER_RAND * uniform(rng));
+                s.body[i] = normalizaAngulo(s.body[i] - moment / (1.0 + INERTIA_MOMENT * speed));
+                ++counters.turn;
+                break;
+            }
+            case CommandType::Kick: {
+                ++counters.kick;
+                const bool canKick = mode == SimMode::PlayOn || (isSetPiece(mode) && s.modeSide[e] == team);
+                double dx = s.bx[e] - s.px[i], dy = s.by[e] - s.py[i];
+                double dist = std::hypot(dx, dy);
+                if (!canKick || dist > KICKABLE_DIST)
+                    break;
+                double dirDiff = std::fabs(normalizaAngulo(std::atan2(dy, dx) / DEG - s.body[i]));
+                double rate = KICK_POWER_RATE * (1.0 - 0.25 * dirDiff / 180.0
+                                                 - 0.25 * (dist - PLAYER_SIZE - BALL_SIZE) / KICKABLE_MARGIN);
+                double power = std::clamp(cmd.a, -100.0, 100.0);
+                double a = (s.body[i] - std::clamp(cmd.b, -180.0, 180.0)) * DEG;
+                double noise = KICK_RAND * std::fabs(power) / 100.0;
+                s.bax[e] += power * rate * std::cos(a) + noise * uniform(rng);
+                s.bay[e] += power * rate * std::sin(a) + noise * uniform(rng);
+                s.lastKicker[e] = static_cast<std::int8_t>(team);
+                if (isSetPiece(mode))
+                    s.setPieceTaken[e] = 1;
+                ++results_[e].kicks[team];
+                break;
+            }
+            case CommandType::Move: {
+                if (!canMove)
+                    break;
+                // Coordenadas propias: para el equipo derecho el campo está girado
+                double sx = team == 1 ? -1.0 : 1.0;
+                s.px[i] = std::clamp(sx * cmd.a, -FIELD_LIMIT_X, FIELD_LIMIT_X);
+                s.py[i] = std::clamp(-sx * cmd.b, -FIELD_LIMIT_Y, FIELD_LIMIT_Y);
+                s.vx[i] = s.vy[i] = 0.0;
+                ++counters.move;
+                break;
+            }
+            default:
+                break;
+        }
+        s.noiseX[i] = uniform(rng);
+        s.noiseY[i] = uniform(rng);
+    }
+    s.bnoiseX[e] = uniform(rng);
+    s.bnoiseY[e] = uniform(rng);
+}
+
+void SimBatch::startKickOff(Block &block, std::size_t e, int time, int side)
+{
+    SimState &s = state_;
+    s.bx[e] = s.by[e] = s.bvx[e] = s.bvy[e] = 0.0;
+    // Cada equipo en su campo
+    for (int p = 0; p < SIM_PLAYERS; ++p) {
+        const std::size_t i = e * SIM_PLAYERS + p;
+        s.px[i] = teamOf(p) == 0 ? std::min(s.px[i], 0.0) : std::max(s.px[i], 0.0);
+    }
+    s.mode[e] = SimMode::KickOff;
+    s.modeSide[e] = static_cast<std::int8_t>(side);
+    s.modeStart[e] = time;
+    s.setPieceTaken[e] = 0;
+    announce(block, e, time, side == 0 ? "kick_off_l" : "kick_off_r");
+}
+
+void SimBatch::startSetPiece(Block &block, std::size_t e, int time, SimMode mode, int side, Point ball)
+{
+    SimState &s = state_;
+    s.bx[e] = ball.x;
+    s.by[e] = ball.y;
+    s.bvx[e] = s.bvy[e] = 0.0;
+    s.mode[e] = mode;
+    s.modeSide[e] = static_cast<std::int8_t>(side);
+    s.modeStart[e] = time;
+    s.setPieceTaken[e] = 0;
+
+    const char *name = mode == SimMode::KickIn ? "kick_in" : mode == SimMode::CornerKick ? "corner_kick" : "goal_kick";
+    char token[24];
+    std::snprintf(token, sizeof(token), "%s_%c", name, side == 0 ? 'l' : 'r');
+    announce(block, e, time, token);
+}
+
+// Árbitro al final del ciclo (time ya es el ciclo siguiente)
+void SimBatch::referee(Block &block, std::size_t e, int time)
+{
+    SimState &s = state_;
+    SimResult &result = results_[e];
+
+    switch (s.mode[e]) {
+        case SimMode::BeforeKickOff:
+            if (time >= KICK_OFF_WAIT)
+                startKickOff(block, e, time, 0);
+            break;
+        case SimMode::AfterGoal:
+            if (time - s.modeStart[e] >= AFTER_GOAL_CYCLES)
+                startKickOff(block, e, time, 1 - s.modeSide[e]);
+            break;
+        case SimMode::KickOff:
+        case SimMode::KickIn:
+        case SimMode::CornerKick:
+        case SimMode::GoalKick:
+            if (s.setPieceTaken[e]) {
+                s.mode[e] = SimMode::PlayOn;
+                announce(block, e, time, "play_on");
+            } else if (time - s.modeStart[e] >= DROP_BALL_CYCLES) {
+                s.mode[e] = SimMode::PlayOn;
+                announce(block, e, time, "drop_ball");
+                announce(block, e, time, "play_on");
+            } else {
+                // Los rivales del que saca, fuera del círculo de 9,15 m
+                for (int p = 0; p < SIM_PLAYERS; ++p) {
+                    if (teamOf(p) == s.modeSide[e])
+                        continue;
+                    const std::size_t i = e * SIM_PLAYERS + p;
+                    double dx = s.px[i] - s.bx[e], dy = s.py[i] - s.by[e];
+                    double d = std::hypot(dx, dy);
+                    if (d >= KICK_OFF_CLEARANCE)
+                        continue;
+                    if (d < 1e-6) {
+                        dx = teamOf(p) == 0 ? -1.0 : 1.0;
+                        dy = 0.0;
+                        d = 1.0;
+                    }
+                    s.px[i] = s.bx[e] + dx * KICK_OFF_CLEARANCE / d;
+                    s.py[i] = s.by[e] + dy * KICK_OFF_CLEARANCE / d;
+                }
+            }
+            break;
+        default:
+            break;
+    }
+
+    if (s.mode[e] == SimMode::PlayOn) {
+        const double x = s.bx[e], y = s.by[e];
+        if (x > 0.0)
+            ++result.territory[0];
+        else if (x < 0.0)
+            ++result.territory[1];
+
+        const double sx = x > 0.0 ? 1.0 : -1.0, sy = y > 0.0 ? 1.0 : -1.0;
+        if (std::fabs(x) > PITCH_HALF_LENGTH) {
+            const int defender = x > 0.0 ? 1 : 0;
+            const int attacker = 1 - defender;
+            if (std::fabs(y) < GOAL_POST_Y) {
+                int goals = ++result.goals[attacker];
+                s.mode[e] = SimMode::AfterGoal;
+                s.modeSide[e] = static_cast<std::int8_t>(attacker);
+                s.modeStart[e] = time;
+                s.bvx[e] = s.bvy[e] = 0.0;
+                char token[24];
+                std::snprintf(token, sizeof(token), "goal_%c_%d", attacker == 0 ? 'l' : 'r', goals);
+                announce(block, e, time, token);
+            } else if (s.lastKicker[e] == defender) {
+                startSetPiece(block, e, time, SimMode::CornerKick, attacker,
+                              {sx * (PITCH_HALF_LENGTH - CORNER_KICK_MARGIN), sy * (PITCH_HALF_WIDTH - CORNER_KICK_MARGIN)});
+            } else {
+                startSetPiece(block, e, time, SimMode::GoalKick, defender, {sx * GOAL_AREA_X, sy * GOAL_AREA_Y});
+            }
+        } else if (std::fabs(y) > PITCH_HALF_WIDTH) {
+            startSetPiece(block, e, time, SimMode::KickIn, s.lastKicker[e] == 0 ? 1 : 0, {x, sy * PITCH_HALF_WIDTH});
+        }
+    }
+
+    if (time == SIM_HALF_CYCLES && config_.cycles > SIM_HALF_CYCLES) {
+        // Descanso: cada uno a su posición de saque y saca el derecho
+        announce(block, e, time, "half_time");
+        for (int p = 0; p < SIM_PLAYERS; ++p) {
+            const std::size_t i = e * SIM_PLAYERS + p;
+            const Point home = block.agent(e, p).player.initialPosition;
+            const double sx = teamOf(p) == 1 ? -1.0 : 1.0;
+            s.px[i] = sx * home.x;
+            s.py[i] = -sx * home.y;
+            s.vx[i] = s.vy[i] = 0.0;
+            s.body[i] = teamOf(p) == 0 ? 0.0 : 180.0;
+        }
+        startKickOff(block, e, time, 1);
+    }
+
+    if (time >= config_.cycles && s.mode[e] != SimMode::TimeOver) {
+        s.mode[e] = SimMode::TimeOver;
+        result.cycles = time;
+        announce(block, e, time, "time_over");
+    }
+}
+
+void SimBatch::play(std::size_t begin, std::size_t end)
+{
+    auto block = std::make_unique<Block>();
+    block->agents.resize(SIM_BLOCK * SIM_PLAYERS);
+    block->says.resize(SIM_BLOCK);
+
+    for (std::size_t first = begin; first < end; first += SIM_BLOCK) {
+        const std::size_t last = std::min(end, first + SIM_BLOCK);
+        block->first = first;
+        for (std::size_t e = first; e < last; ++e)
+            reset(*block, e);
+
+        for (int t = 0; t < config_.cycles; ++t) {
+            for (std::size_t e = first; e < last; ++e) {
+                perceive(*block, e, t);
+                decide(*block, e, t);
+            }
+            integratePlayers(state_, first * SIM_PLAYERS, last * SIM_PLAYERS);
+            integrateBall(state_, first, last);
+            for (std::size_t e = first; e < last; ++e)
+                referee(*block, e, t + 1);
+        }
+    }
+}
@@ -0,0 +1,109 @@
+#pragma once
+
+#include "types.h"
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Simulador 2D en proceso para evaluar políticas sin rcssserver.
+//
+// Reproduce la dinámica básica del servidor (dash, turn, kick y move con sus
+// ruidos, decaimiento y límites de velocidad, área de chute, resistencia,
+// modos de juego con saques, goles y descanso, visión polar cuantizada) y a
+// cada jugador le da el agente completo: localize, MotionModel, el
+// planificador síncrono y decideAction. Las percepciones se escriben ya
+// estructuradas en PlayerInfo (sin pasar por texto); el árbitro y los
+// mensajes de compañeros llegan como texto a parseHearMsg. No hay colisiones,
+// fueras de juego, faltas, atrapadas del portero ni tipos heterogéneos.
+//
+// El estado físico de todos los partidos es una estructura de arrays (una
+// columna por magnitud; el jugador p del partido e en e * SIM_PLAYERS + p) que
+// se integra con bucles vectorizables sobre un bloque de partidos a la vez.
+// Cada partido tiene su propio generador, así que el resultado depende sólo de
+// la semilla y no del reparto entre hilos.
+
+inline constexpr int SIM_TEAM_SIZE = 11;
+inline constexpr int SIM_PLAYERS = 2 * SIM_TEAM_SIZE;
+inline constexpr int SIM_HALF_CYCLES = 3000;     // half_time de rcssserver (300 s)
+
+// Cómo juega un equipo el balón controlado
+enum class SimPolicy : std::uint8_t
+{
+    Plan,    // primera acción de la cadena del planificador (PLAN_SYNC_NODES nodos)
+    Shoot    // tiro directo a portería
+};
+
+struct SimConfig
+{
+    int cycles{2 * SIM_HALF_CYCLES};
+    std::array<SimPolicy, 2> policy{SimPolicy::Plan, SimPolicy::Plan};   // izquierdo, derecho
+    bool say{true};                // comunicación de equipo por say/hear
+    std::uint64_t seed{1};
+};
+
+// Resultado de un partido por equipo (0 izquierdo, 1 derecho)
+struct SimResult
+{
+    std::array<int, 2> goals{};
+    std::array<int, 2> kicks{};       // chutes con el balón al alcance
+    std::array<int, 2> territory{};   // ciclos de juego con el balón en campo rival
+    int cycles{0};
+};
+
+// Modo de juego del árbitro; el lado del saque va aparte
+enum class SimMode : std::uint8_t
+{
+    BeforeKickOff, KickOff, PlayOn, KickIn, CornerKick, GoalKick, AfterGoal, TimeOver
+};
+
+// Estado físico de los partidos en estructura de arrays
+struct SimState
+{
+    // Jugadores (episodes * SIM_PLAYERS)
+    std::vector<double> px, py, vx, vy;
+    std::vector<double> body;                       // grados, antihorario
+    std::vector<double> stamina, effort, recovery, capacity;
+    std::vector<double> noiseX, noiseY;             // ruido del ciclo en [-1, 1]
+    std::vector<CommandCounters> counters;
+
+    // Balón y árbitro (episodes)
+    std::vector<double> bx, by, bvx, bvy, bax, bay, bnoiseX, bnoiseY;
+    std::vector<SimMode> mode;
+    std::vector<std::int8_t> modeSide;              // 0 izquierdo, 1 derecho
+    std::vector<int> modeStart;
+    std::vector<std::uint8_t> setPieceTaken;
+    std::vector<std::int8_t> lastKicker;            // -1 si nadie ha chutado
+    std::vector<std::uint64_t> rng;
+
+    void resize(std::size_t episodes);
+};
+
+class SimBatch
+{
+public:
+    SimBatch(std::size_t episodes, const SimConfig &config);
+
+    // Juega enteros los partidos [begin, end). Rangos disjuntos se pueden
+    // jugar a la vez desde hilos distintos.
+    void play(std::size_t begin, std::size_t end);
+
+    std::size_t size() const { return results_.size(); }
+    const SimConfig &config() const { return config_; }
+    const SimResult &result(std::size_t e) const { return results_[e]; }
+
+private:
+    struct Block;
+
+    void reset(Block &block, std::size_t e);
+    void perceive(Block &block, std::size_t e, int time);
+    void decide(Block &block, std::size_t e, int time);
+    void referee(Block &block, std::size_t e, int time);
+    void announce(Block &block, std::size_t e, int time, const char *token);
+    void startKickOff(Block &block, std::size_t e, int time, int side);
+    void startSetPiece(Block &block, std::size_t e, int time, SimMode mode, int side, Point ball);
+
+    SimConfig config_;
+    SimState state_;
+    std::vector<SimResult> results_;
+};
@@ -0,0 +1,176 @@
+// player_sim: juega en proceso muchos partidos simulados (sim.h) repartidos
+// entre hilos, para comparar políticas y barrer parámetros sin rcssserver.
+//
+// Cada hilo juega un tramo contiguo de partidos; el resultado de cada partido
+// depende sólo de --seed y de su índice. Al final se informa del rendimiento
+// (ciclos de partido por segundo y partidos completos por hora) y, para el
+// equipo izquierdo, de victorias, empates y derrotas con intervalos de Wilson
+// al 95 %, la diferencia de goles media con su intervalo, los chutes y el
+// dominio territorial. Con --csv se escribe una fila por partido.
+//
+//   player_sim [--episodes N] [--cycles N] [--threads N] [--seed S]
+//              [--formation FILE] [--left-policy plan|shoot]
+//              [--right-policy plan|shoot] [--no-say] [--csv FILE]
+#include "args.h"
+#include "sim.h"
+#include "formation.h"
+#include "stats.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+struct SimOptions
+{
+    std::size_t episodes{64};
+    int threads{0};               // 0: todos los núcleos
+    std::string csvPath;
+    SimConfig config{};
+};
+
+static bool parsePolicy(std::string_view value, SimPolicy &out)
+{
+    if (value == "plan") out = SimPolicy::Plan;
+    else if (value == "shoot") out = SimPolicy::Shoot;
+    else return false;
+    return true;
+}
+
+static const char *policyName(SimPolicy p)
+{
+    return p == SimPolicy::Plan ? "plan" : "shoot";
+}
+
+static void printUsage(const char *prog)
+{
+    std::printf("Usage: %s [--episodes N] [--cycles N] [--threads N] [--seed S] [--formation FILE]\n"
+                "       [--left-policy plan|shoot] [--right-policy plan|shoot] [--no-say] [--csv FILE]\n", prog);
+}
+
+static bool parseOptions(int argc, char *argv[], SimOptions &o)
+{
+    for (int i = 1; i < argc; ++i) {
+        std::string_view arg = argv[i];
+        if (arg == "--no-say") {
+            o.config.say = false;
+            continue;
+        }
+        if (i + 1 >= argc)
+            return false;
+        std::string value = argv[++i];
+
+        if (arg == "--episodes") { if (!parseArg<std::size_t>(value, o.episodes, 1)) return false; }
+        else if (arg == "--cycles") { if (!parseArg(value, o.config.cycles, 1)) return false; }
+        else if (arg == "--threads") { if (!parseArg(value, o.threads, 0, 1024)) return false; }
+        else if (arg == "--seed") { if (!parseArg(value, o.config.seed)) return false; }
+        else if (arg == "--csv") o.csvPath = value;
+        else if (arg == "--left-policy") { if (!parsePolicy(value, o.config.policy[0])) return false; }
+        else if (arg == "--right-policy") { if (!parsePolicy(value, o.config.policy[1])) return false; }
+        else if (arg == "--formation") {
+            if (!loadActiveFormation(value)) {
+                std::fprintf(stderr, "Cannot load formation %s\n", value.c_str());
+                return false;
+            }
+        } else {
+            return false;
+        }
+    }
+    return o.episodes > 0 && o.config.cycles > 0 && o.threads >= 0;
+}
+
+static void printSummary(const SimBatch &batch, int threads, double wallSeconds)
+{
+    const std::size_t n = batch.size();
+    const SimConfig &config = batch.config();
+    int wins = 0, draws = 0, losses = 0;
+    double goals[2]{}, kicks[2]{}, territory[2]{}, sumDiff = 0.0, sumDiff2 = 0.0, cycles = 0.0;
+    for (std::size_t e = 0; e < n; ++e) {
+        const SimResult &r = batch.result(e);
+        int diff = r.goals[0] - r.goals[1];
+        wins += diff > 0;
+        draws += diff == 0;
+        losses += diff < 0;
+        for (int t = 0; t < 2; ++t) {
+            goals[t] += r.goals[t];
+            kicks[t] += r.kicks[t];
+            territory[t] += r.territory[t];
+        }
+        sumDiff += diff;
+        sumDiff2 += static_cast<double>(diff) * diff;
+        cycles += r.cycles;
+    }
+
+    const double perSecond = wallSeconds > 0 ? cycles / wallSeconds : 0.0;
+    std::printf("%zu matches of %d cycles on %d threads in %.1f s\n", n, config.cycles, threads, wallSeconds);
+    std::printf("  %.0f match-cycles/s, %.0f agent decisions/s, %.1f full matches/hour (%.0fx real time)\n",
+                perSecond, perSecond * SIM_PLAYERS, 3600.0 * perSecond / (2 * SIM_HALF_CYCLES), perSecond / 10.0);
+
+    std::printf("left (%s) vs right (%s) (95%% intervals)\n", policyName(config.policy[0]),
+                policyName(config.policy[1]));
+    const char *labels[3] = {"win", "draw", "loss"};
+    int counts[3] = {wins, draws, losses};
+    const int total = static_cast<int>(n);
+    for (int i = 0; i < 3; ++i) {
+        double lo, hi;
+        wilsonInterval(counts[i], total, lo, hi);
+        std::printf("  %-5s %4d  %5.1f%%  [%5.1f%%, %5.1f%%]\n", labels[i], counts[i], 100.0 * counts[i] / total,
+                    100.0 * lo, 100.0 * hi);
+    }
+    double mean = sumDiff / total;
+    double var = total > 1 ? (sumDiff2 - total * mean * mean) / (total - 1) : 0.0;
+    std::printf("  goals %.2f - %.2f per match, difference %+.2f +/- %.2f\n", goals[0] / total, goals[1] / total,
+                mean, 1.96 * std::sqrt(std::max(var, 0.0) / total));
+    double played = territory[0] + territory[1];
+    std::printf("  kicks %.1f - %.1f per match, ball in opponent half %.1f%% - %.1f%%\n", kicks[0] / total,
+                kicks[1] / total, played > 0 ? 100.0 * territory[0] / played : 0.0,
+                played > 0 ? 100.0 * territory[1] / played : 0.0);
+}
+
+static bool writeCsv(const SimBatch &batch, const std::string &path)
+{
+    std::FILE *f = std::fopen(path.c_str(), "w");
+    if (!f)
+        return false;
+    std::fprintf(f, "episode,cycles,goals_left,goals_right,kicks_left,kicks_right,territory_left,territory_right\n");
+    for (std::size_t e = 0; e < batch.size(); ++e) {
+        const SimResult &r = batch.result(e);
+        std::fprintf(f, "%zu,%d,%d,%d,%d,%d,%d,%d\n", e, r.cycles, r.goals[0], r.goals[1], r.kicks[0], r.kicks[1],
+                     r.territory[0], r.territory[1]);
+    }
+    return std::fclose(f) == 0;
+}
+
+int main(int argc, char *argv[])
+{
+    SimOptions options;
+    if (!parseOptions(argc, argv, options)) {
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    int threads = options.threads > 0 ? options.threads : static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+    threads = static_cast<int>(std::min<std::size_t>(static_cast<std::size_t>(threads), options.episodes));
+
+    SimBatch batch(options.episodes, options.config);
+    auto t0 = std::chrono::steady_clock::now();
+    std::vector<std::thread> workers;
+    for (int t = 0; t < threads; ++t) {
+        std::size_t begin = options.episodes * t / threads;
+        std::size_t end = options.episodes * (t + 1) / threads;
+        workers.emplace_back([&batch, begin, end] { batch.play(begin, end); });
+    }
+    for (auto &w : workers)
+        w.join();
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+
+    printSummary(batch, threads, seconds);
+    if (!options.csvPath.empty() && !writeCsv(batch, options.csvPath)) {
+        std::fprintf(stderr, "Cannot write %s\n", options.csvPath.c_str());
+        return 1;
+    }
+    return 0;
+}
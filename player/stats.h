@@ -0,0 +1,20 @@
+#pragma once
+
+#include <cmath>
+
+// Intervalo de Wilson al 95 % para k éxitos en n pruebas
+inline void wilsonInterval(int k, int n, double &lo, double &hi)
+{
+    constexpr double Z = 1.96;
+    if (n == 0) {
+        lo = 0.0;
+        hi = 1.0;
+        return;
+    }
+    double p = static_cast<double>(k) / n;
+    double denom = 1.0 + Z * Z / n;
+    double center = (p + Z * Z / (2.0 * n)) / denom;
+    double half = Z * std::sqrt(p * (1.0 - p) / n + Z * Z / (4.0 * n * n)) / denom;
+    lo = center - half;
+    hi = center + half;
+}
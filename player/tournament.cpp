@@ -0,0 +1,596 @@
+// player_tournament: juega en lote partidos sin interfaz entre dos equipos,
+// varios a la vez en la misma máquina.
+//
+// Cada partido ocupa una "plaza" con sus propios puertos (servidor, entrenadores
+// y los dos equipos, PORTS_PER_SLOT por plaza) y sus propios núcleos: el
+// servidor y los dos procesos de equipo heredan la afinidad de la plaza. Al
+// terminar el servidor se leen las métricas de los jugadores (--metrics), de
+// donde salen el marcador (goals_for/goals_against) y los ciclos, y se
+// termina a los equipos. Los lados se alternan entre partidos. Al final se
+// informa de victorias, empates y derrotas del primer equipo con intervalos de
+// Wilson al 95 %, de la diferencia de goles media con su intervalo y de los
+// partidos por hora; cada partido queda en <out>/results.csv y sus métricas y
+// salidas en <out>/match_NNNN/.
+//
+//   player_tournament [--matches N] [--parallel N] [--cores-per-match N]
+//                     [--player PATH] [--right-player PATH] [--teams A,B]
+//                     [--player-args "..."] [--server-cmd "..."] [--base-port N]
+//                     [--synch] [--startup-ms N] [--timeout S] [--out DIR]
+//
+// --server-cmd admite {port}, {coach_port}, {olcoach_port}, {synch} y {dir};
+// por defecto lanza rcssserver en modo automático (arranca al conectarse los
+// equipos y sale al acabar el partido).
+#include "args.h"
+#include "metrics.h"
+#include "stats.h"
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cmath>
+#include <csignal>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <fcntl.h>
+#include <poll.h>
+#include <sched.h>
+#include <sys/syscall.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+static constexpr int PORTS_PER_SLOT = 100;
+static constexpr int SLOT_TEAM_PORT[2] = {10, 30};   // Primer puerto local de cada equipo dentro de la plaza
+static constexpr int TEAM_SIZE = 11;
+
+// El servidor da el lado izquierdo al primer equipo que se conecta: el derecho
+// se lanza un poco después para que los lados sean los previstos
+static constexpr std::int64_t TEAM_STAGGER_NS = 300'000'000;
+
+static constexpr std::string_view DEFAULT_SERVER_CMD =
+    "rcssserver server::port={port} server::coach_port={coach_port} server::olcoach_port={olcoach_port}"
+    " server::auto_mode=true server::synch_mode={synch} server::game_log_dir={dir} server::text_log_dir={dir}";
+
+struct TournamentOptions
+{
+    int matches{10};
+    int parallel{1};
+    int coresPerMatch{0};                   // 0: los núcleos disponibles a partes iguales
+    std::uint16_t basePort{6000};
+    std::string serverCmd{DEFAULT_SERVER_CMD};
+    std::string player{"./player"};
+    std::string rightPlayer;                // Binario del segundo equipo (vacío: el mismo)
+    std::string teams[2]{"RealSuciedad", "RayoCayetano"};
+    std::string playerArgs;
+    std::string outDir{"tournament"};
+    bool synch{false};
+    int startupMs{1000};                    // Espera entre lanzar el servidor y los equipos
+    double timeoutSec{900.0};
+};
+
+enum class MatchStatus : std::uint8_t
+{
+    Ok, Timeout, Incomplete
+};
+
+static const char *toString(MatchStatus s)
+{
+    switch (s) {
+        case MatchStatus::Ok:      return "ok";
+        case MatchStatus::Timeout: return "timeout";
+        default:                   return "incomplete";
+    }
+}
+
+// Resultado de un partido, siempre desde el punto de vista de teams[0]
+struct MatchResult
+{
+    int index{0};
+    int slot{0};
+    bool swapped{false};                    // teams[0] jugó en el lado derecho
+    MatchStatus status{MatchStatus::Incomplete};
+    double seconds{0.0};
+    int goals[2]{0, 0};                     // goles de teams[0] y teams[1]
+    double cycles{0.0};                     // ciclos medios por agente
+    std::uint64_t missedCycles{0};
+    std::uint64_t noCommand{0};
+    double cycleToSendP99Us{0.0};
+};
+
+// Partido en curso en una plaza
+struct RunningMatch
+{
+    int index{-1};
+    bool swapped{false};
+    std::string dir;
+    pid_t server{-1};
+    int serverFd{-1};                       // pidfd del servidor: legible al terminar
+    pid_t teams[2]{-1, -1};                 // por lado (izquierdo, derecho)
+    std::int64_t startNs{0};
+    int launched{0};                        // equipos lanzados (primero el izquierdo)
+    std::int64_t teamsAtNs{0};              // instante de lanzar el siguiente equipo (0: ya lanzados)
+    std::int64_t deadlineNs{0};
+};
+
+static volatile std::sig_atomic_t interrupted = 0;
+
+static std::int64_t nowNs()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+static void replaceAll(std::string &text, std::string_view key, const std::string &value)
+{
+    for (std::size_t at = text.find(key); at != std::string::npos; at = text.find(key, at + value.size()))
+        text.replace(at, key.size(), value);
+}
+
+// --- Procesos -----------------------------------------------------------------
+
+// Lanza el comando en su propio grupo de procesos, con la afinidad de la plaza
+// y la salida a logPath
+static pid_t spawn(const std::string &command, const cpu_set_t &cpus, const std::string &logPath)
+{
+    pid_t pid = fork();
+    if (pid == 0) {
+        setpgid(0, 0);
+        sched_setaffinity(0, sizeof(cpus), &cpus);
+        int fd = open(logPath.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        if (fd >= 0) {
+            dup2(fd, STDOUT_FILENO);
+            dup2(fd, STDERR_FILENO);
+            close(fd);
+        }
+        std::string line = "exec " + command;
+        execl("/bin/sh", "sh", "-c", line.c_str(), static_cast<char *>(nullptr));
+        _exit(127);
+    }
+    return pid;
+}
+
+// Termina el grupo de procesos y lo recoge; SIGKILL si no sale en un segundo
+static void stopGroup(pid_t &pid)
+{
+    if (pid <= 0)
+        return;
+    kill(-pid, SIGTERM);
+    for (int i = 0; i < 100; ++i) {
+        if (waitpid(pid, nullptr, WNOHANG) == pid) {
+            pid = -1;
+            return;
+        }
+        usleep(10'000);
+    }
+    kill(-pid, SIGKILL);
+    waitpid(pid, nullptr, 0);
+    pid = -1;
+}
+
+// --- Plazas -------------------------------------------------------------------
+
+class Tournament
+{
+public:
+    explicit Tournament(const TournamentOptions &options) : options_(options) {}
+
+    bool prepare();
+    int run();
+
+private:
+    std::uint16_t port(int slot, int offset) const
+    {
+        return static_cast<std::uint16_t>(options_.basePort + slot * PORTS_PER_SLOT + offset);
+    }
+
+    void startMatch(int slot, int index);
+    void launchTeam(int slot);
+    void finishMatch(int slot, MatchStatus status);
+    void collect(RunningMatch &m, MatchResult &r) const;
+    void writeResult(const MatchResult &r, const cpu_set_t &cpus);
+    void printSummary(double wallSeconds) const;
+
+    TournamentOptions options_;
+    std::vector<cpu_set_t> slotCpus_;
+    std::vector<RunningMatch> slots_;
+    std::vector<MatchResult> results_;
+    std::FILE *csv_{nullptr};
+    int nextMatch_{0};
+};
+
+// Mayor pid del sistema (kernel.pid_max), para acotar los nombres de los sockets de métricas
+static long maxPid()
+{
+    long pidMax = 4'194'304;    // PID_MAX_LIMIT en 64 bits
+    if (std::FILE *f = std::fopen("/proc/sys/kernel/pid_max", "r")) {
+        if (std::fscanf(f, "%ld", &pidMax) != 1)
+            pidMax = 4'194'304;
+        std::fclose(f);
+    }
+    return pidMax;
+}
+
+bool Tournament::prepare()
+{
+    namespace fs = std::filesystem;
+    std::error_code ec;
+    fs::create_directories(options_.outDir, ec);
+    if (ec) {
+        std::printf("Cannot create %s\n", options_.outDir.c_str());
+        return false;
+    }
+    // Rutas absolutas: los sockets de métricas y los comandos no dependen del directorio de trabajo
+    options_.outDir = fs::absolute(options_.outDir).string();
+    if (options_.player.find('/') != std::string::npos)
+        options_.player = fs::absolute(options_.player).string();
+    if (options_.rightPlayer.empty())
+        options_.rightPlayer = options_.player;
+    else if (options_.rightPlayer.find('/') != std::string::npos)
+        options_.rightPlayer = fs::absolute(options_.rightPlayer).string();
+
+    // El socket de métricas más largo, <out>/match_NNNN/player_<pid>.sock, debe caber en sun_path
+    char longest[64];
+    std::snprintf(longest, sizeof(longest), "/match_%04d/player_%ld.sock", std::max(options_.matches - 1, 0),
+                  maxPid() - 1);
+    const std::string socketPath = options_.outDir + longest;
+    if (socketPath.size() >= sizeof(sockaddr_un::sun_path)) {
+        std::printf("Output directory too long for metrics sockets: %s (%zu bytes, limit %zu)\n", socketPath.c_str(),
+                    socketPath.size(), sizeof(sockaddr_un::sun_path) - 1);
+        return false;
+    }
+
+    if (options_.basePort + options_.parallel * PORTS_PER_SLOT > 65535) {
+        std::printf("Not enough ports above %u for %d parallel matches\n", options_.basePort, options_.parallel);
+        return false;
+    }
+
+    // Núcleos permitidos al proceso, repartidos en bloques contiguos por plaza
+    cpu_set_t allowed;
+    CPU_ZERO(&allowed);
+    sched_getaffinity(0, sizeof(allowed), &allowed);
+    std::vector<int> cpus;
+    for (int c = 0; c < CPU_SETSIZE; ++c) {
+        if (CPU_ISSET(c, &allowed))
+            cpus.push_back(c);
+    }
+    int perMatch = options_.coresPerMatch > 0 ? options_.coresPerMatch
+                                              : std::max(1, static_cast<int>(cpus.size()) / options_.parallel);
+    slotCpus_.resize(static_cast<std::size_t>(options_.parallel));
+    for (int s = 0; s < options_.parallel; ++s) {
+        CPU_ZERO(&slotCpus_[s]);
+        for (int j = 0; j < perMatch; ++j)
+            CPU_SET(cpus[static_cast<std::size_t>(s * perMatch + j) % cpus.size()], &slotCpus_[s]);
+    }
+    if (perMatch * options_.parallel > static_cast<int>(cpus.size()))
+        std::printf("warning: %d matches x %d cores oversubscribe %zu cores\n", options_.parallel, perMatch, cpus.size());
+
+    csv_ = std::fopen((options_.outDir + "/results.csv").c_str(), "w");
+    if (!csv_) {
+        std::printf("Cannot write %s/results.csv\n", options_.outDir.c_str());
+        return false;
+    }
+    std::fprintf(csv_, "match,slot,cpus,status,seconds,left,right,goals_%s,goals_%s,cycles,cycles_per_s,"
+                       "missed_cycles,no_command,cycle_to_send_p99_us\n",
+                 options_.teams[0].c_str(), options_.teams[1].c_str());
+
+    slots_.resize(static_cast<std::size_t>(options_.parallel));
+    std::printf("tournament: %d matches %s vs %s, %d in parallel, %d cores each, ports from %u, results in %s\n",
+                options_.matches, options_.teams[0].c_str(), options_.teams[1].c_str(), options_.parallel, perMatch,
+                options_.basePort, options_.outDir.c_str());
+    return true;
+}
+
+void Tournament::startMatch(int slot, int index)
+{
+    RunningMatch &m = slots_[static_cast<std::size_t>(slot)];
+    m = RunningMatch{};
+    m.index = index;
+    m.swapped = index % 2 == 1;
+    char name[32];
+    std::snprintf(name, sizeof(name), "/match_%04d", index);
+    m.dir = options_.outDir + name;
+    std::error_code ec;
+    std::filesystem::create_directories(m.dir, ec);
+
+    std::string cmd = options_.serverCmd;
+    replaceAll(cmd, "{port}", std::to_string(port(slot, 0)));
+    replaceAll(cmd, "{coach_port}", std::to_string(port(slot, 1)));
+    replaceAll(cmd, "{olcoach_port}", std::to_string(port(slot, 2)));
+    replaceAll(cmd, "{synch}", options_.synch ? "true" : "false");
+    replaceAll(cmd, "{dir}", m.dir);
+
+    m.startNs = nowNs();
+    m.server = spawn(cmd, slotCpus_[static_cast<std::size_t>(slot)], m.dir + "/server.log");
+    m.serverFd = static_cast<int>(syscall(SYS_pidfd_open, m.server, 0));
+    m.teamsAtNs = m.startNs + static_cast<std::int64_t>(options_.startupMs) * 1'000'000;
+    m.deadlineNs = m.startNs + static_cast<std::int64_t>(options_.timeoutSec * 1e9);
+}
+
+void Tournament::launchTeam(int slot)
+{
+    RunningMatch &m = slots_[static_cast<std::size_t>(slot)];
+    const int side = m.launched++;
+    // En los partidos impares teams[0] juega en el lado derecho
+    const int team = m.swapped ? 1 - side : side;
+    std::string cmd = (team == 0 ? options_.player : options_.rightPlayer) + " --team " + options_.teams[team] + ":" +
+                      std::to_string(port(slot, SLOT_TEAM_PORT[side])) + " --server 127.0.0.1:" +
+                      std::to_string(port(slot, 0)) + " --metrics " + m.dir;
+    if (options_.synch)
+        cmd += " --synch";
+    if (!options_.playerArgs.empty())
+        cmd += " " + options_.playerArgs;
+    m.teams[side] = spawn(cmd, slotCpus_[static_cast<std::size_t>(slot)], m.dir + "/" + options_.teams[team] + ".log");
+    m.teamsAtNs = m.launched < 2 ? nowNs() + TEAM_STAGGER_NS : 0;
+}
+
+// Marcador y ciclos a partir de las métricas de todos los jugadores del partido
+void Tournament::collect(RunningMatch &m, MatchResult &r) const
+{
+    std::string text;
+    std::error_code ec;
+    for (const auto &entry : std::filesystem::directory_iterator(m.dir, ec)) {
+        std::string name = entry.path().filename().string();
+        if (name.rfind("player_", 0) == 0 && name.ends_with(".sock"))
+            queryMetrics(entry.path().string(), text);
+    }
+    std::ofstream(m.dir + "/metrics.txt") << text;
+
+    std::vector<MetricsReport> reports;
+    parseMetrics(text, reports);
+
+    auto counter = [](const MetricsReport &rep, MetricCounter c) { return rep.counters[static_cast<std::size_t>(c)]; };
+    std::uint64_t goalsFor[2]{}, goalsAgainst[2]{};
+    std::size_t agents[2]{};
+    std::uint64_t cycles = 0;
+    HistogramSnapshot cycleToSend;
+    for (const MetricsReport &rep : reports) {
+        int team = rep.team == options_.teams[0] ? 0 : rep.team == options_.teams[1] ? 1 : -1;
+        if (team < 0)
+            continue;
+        ++agents[team];
+        // Todos los jugadores oyen al árbitro: el mayor recuento cubre a quien se perdiera un mensaje
+        goalsFor[team] = std::max(goalsFor[team], counter(rep, MetricCounter::GoalsFor));
+        goalsAgainst[team] = std::max(goalsAgainst[team], counter(rep, MetricCounter::GoalsAgainst));
+        cycles += counter(rep, MetricCounter::Cycles);
+        r.missedCycles += counter(rep, MetricCounter::MissedCycles);
+        r.noCommand += counter(rep, MetricCounter::NoCommand);
+        cycleToSend.merge(rep.stages[static_cast<std::size_t>(MetricStage::CycleToSend)]);
+    }
+
+    r.goals[0] = static_cast<int>(std::max(goalsFor[0], goalsAgainst[1]));
+    r.goals[1] = static_cast<int>(std::max(goalsFor[1], goalsAgainst[0]));
+    std::size_t total = agents[0] + agents[1];
+    r.cycles = total > 0 ? static_cast<double>(cycles) / static_cast<double>(total) : 0.0;
+    r.cycleToSendP99Us = static_cast<double>(cycleToSend.percentile(0.99)) / 1000.0;
+    if (r.status == MatchStatus::Ok && (agents[0] != TEAM_SIZE || agents[1] != TEAM_SIZE))
+        r.status = MatchStatus::Incomplete;
+}
+
+void Tournament::finishMatch(int slot, MatchStatus status)
+{
+    RunningMatch &m = slots_[static_cast<std::size_t>(slot)];
+    MatchResult r;
+    r.index = m.index;
+    r.slot = slot;
+    r.swapped = m.swapped;
+    r.status = status;
+    r.seconds = static_cast<double>(nowNs() - m.startNs) / 1e9;
+
+    // Con el servidor ya terminado los jugadores siguen vivos: sus métricas son las del partido completo
+    stopGroup(m.server);
+    if (m.teamsAtNs == 0)
+        collect(m, r);
+    else
+        r.status = MatchStatus::Incomplete;
+    stopGroup(m.teams[0]);
+    stopGroup(m.teams[1]);
+    if (m.serverFd >= 0)
+        close(m.serverFd);
+
+    writeResult(r, slotCpus_[static_cast<std::size_t>(slot)]);
+    results_.push_back(r);
+    m = RunningMatch{};
+}
+
+void Tournament::writeResult(const MatchResult &r, const cpu_set_t &cpus)
+{
+    std::string cpuList;
+    for (int c = 0; c < CPU_SETSIZE; ++c) {
+        if (CPU_ISSET(c, &cpus)) {
+            if (!cpuList.empty())
+                cpuList += ' ';
+            cpuList += std::to_string(c);
+        }
+    }
+    const std::string &left = options_.teams[r.swapped ? 1 : 0];
+    const std::string &right = options_.teams[r.swapped ? 0 : 1];
+    std::fprintf(csv_, "%d,%d,%s,%s,%.1f,%s,%s,%d,%d,%.0f,%.1f,%llu,%llu,%.1f\n", r.index, r.slot, cpuList.c_str(),
+                 toString(r.status), r.seconds, left.c_str(), right.c_str(), r.goals[0], r.goals[1], r.cycles,
+                 r.seconds > 0 ? r.cycles / r.seconds : 0.0, static_cast<unsigned long long>(r.missedCycles),
+                 static_cast<unsigned long long>(r.noCommand), r.cycleToSendP99Us);
+    std::fflush(csv_);
+    std::printf("match %4d (slot %d) %-10s %s %d - %d %s  %.1f s, %.0f cycles\n", r.index, r.slot, toString(r.status),
+                options_.teams[0].c_str(), r.goals[0], r.goals[1], options_.teams[1].c_str(), r.seconds, r.cycles);
+    std::fflush(stdout);
+}
+
+int Tournament::run()
+{
+    std::int64_t t0 = nowNs();
+    for (int s = 0; s < options_.parallel && nextMatch_ < options_.matches; ++s)
+        startMatch(s, nextMatch_++);
+
+    std::vector<pollfd> fds;
+    std::vector<int> fdSlot;
+    while (true) {
+        if (interrupted) {
+            std::printf("interrupted: stopping running matches\n");
+            for (int s = 0; s < options_.parallel; ++s) {
+                if (slots_[static_cast<std::size_t>(s)].index >= 0)
+                    finishMatch(s, MatchStatus::Incomplete);
+            }
+            break;
+        }
+
+        // Plazo más próximo: lanzar equipos o agotar el tiempo de un partido
+        std::int64_t now = nowNs();
+        std::int64_t wake = now + 1'000'000'000;
+        fds.clear();
+        fdSlot.clear();
+        bool active = false;
+        for (int s = 0; s < options_.parallel; ++s) {
+            RunningMatch &m = slots_[static_cast<std::size_t>(s)];
+            if (m.index < 0)
+                continue;
+            if (m.teamsAtNs != 0 && now >= m.teamsAtNs)
+                launchTeam(s);
+            if (now >= m.deadlineNs) {
+                finishMatch(s, MatchStatus::Timeout);
+                if (nextMatch_ < options_.matches)
+                    startMatch(s, nextMatch_++);
+                active = active || slots_[static_cast<std::size_t>(s)].index >= 0;
+                wake = now;
+                continue;
+            }
+            active = true;
+            wake = std::min(wake, m.teamsAtNs != 0 ? m.teamsAtNs : m.deadlineNs);
+            fds.push_back({m.serverFd, POLLIN, 0});
+            fdSlot.push_back(s);
+        }
+        if (!active)
+            break;
+
+        int timeoutMs = static_cast<int>(std::max<std::int64_t>(0, (wake - now) / 1'000'000) + 1);
+        int n = poll(fds.data(), fds.size(), timeoutMs);
+        if (n < 0 && errno != EINTR)
+            break;
+        for (std::size_t i = 0; n > 0 && i < fds.size(); ++i) {
+            if (!(fds[i].revents & POLLIN))
+                continue;
+            // El servidor terminó: fin del partido (ok aunque no llegaran a lanzarse los equipos)
+            int s = fdSlot[i];
+            finishMatch(s, MatchStatus::Ok);
+            if (nextMatch_ < options_.matches)
+                startMatch(s, nextMatch_++);
+        }
+    }
+
+    std::fclose(csv_);
+    printSummary(static_cast<double>(nowNs() - t0) / 1e9);
+    return 0;
+}
+
+// --- Informe ------------------------------------------------------------------
+
+void Tournament::printSummary(double wallSeconds) const
+{
+    int ok = 0, wins = 0, draws = 0, losses = 0;
+    double goals[2]{}, sumDiff = 0.0, sumDiff2 = 0.0, cyclesPerSecond = 0.0;
+    std::uint64_t missed = 0;
+    double cycles = 0.0;
+    for (const MatchResult &r : results_) {
+        if (r.status != MatchStatus::Ok)
+            continue;
+        ++ok;
+        int diff = r.goals[0] - r.goals[1];
+        wins += diff > 0;
+        draws += diff == 0;
+        losses += diff < 0;
+        goals[0] += r.goals[0];
+        goals[1] += r.goals[1];
+        sumDiff += diff;
+        sumDiff2 += static_cast<double>(diff) * diff;
+        cyclesPerSecond += r.seconds > 0 ? r.cycles / r.seconds : 0.0;
+        cycles += r.cycles;
+        missed += r.missedCycles;
+    }
+
+    std::printf("\n%zu matches (%d ok) in %.1f s: %.1f matches/hour\n", results_.size(), ok, wallSeconds,
+                wallSeconds > 0 ? 3600.0 * ok / wallSeconds : 0.0);
+    if (ok == 0)
+        return;
+
+    std::printf("%s vs %s (95%% intervals)\n", options_.teams[0].c_str(), options_.teams[1].c_str());
+    const char *labels[3] = {"win", "draw", "loss"};
+    int counts[3] = {wins, draws, losses};
+    for (int i = 0; i < 3; ++i) {
+        double lo, hi;
+        wilsonInterval(counts[i], ok, lo, hi);
+        std::printf("  %-5s %4d  %5.1f%%  [%5.1f%%, %5.1f%%]\n", labels[i], counts[i], 100.0 * counts[i] / ok,
+                    100.0 * lo, 100.0 * hi);
+    }
+    double mean = sumDiff / ok;
+    double var = ok > 1 ? (sumDiff2 - ok * mean * mean) / (ok - 1) : 0.0;
+    std::printf("  goals %.2f - %.2f per match, difference %+.2f +/- %.2f\n", goals[0] / ok, goals[1] / ok, mean,
+                1.96 * std::sqrt(std::max(var, 0.0) / ok));
+    std::printf("  %.0f cycles per match, %.1f cycles/s per match, %.4f missed cycles per agent-cycle\n", cycles / ok,
+                cyclesPerSecond / ok, cycles > 0 ? static_cast<double>(missed) / (cycles * 2 * TEAM_SIZE) : 0.0);
+}
+
+// --- Programa -----------------------------------------------------------------
+
+static void printUsage(const char *prog)
+{
+    std::printf("Usage: %s [--matches N] [--parallel N] [--cores-per-match N]\n"
+                "       [--player PATH] [--right-player PATH] [--teams A,B] [--player-args \"...\"]\n"
+                "       [--server-cmd \"...\"] [--base-port N] [--synch] [--startup-ms N]\n"
+                "       [--timeout S] [--out DIR]\n", prog);
+}
+
+static bool parseOptions(int argc, char *argv[], TournamentOptions &o)
+{
+    for (int i = 1; i < argc; ++i) {
+        std::string_view arg = argv[i];
+        if (arg == "--synch") {
+            o.synch = true;
+            continue;
+        }
+        if (i + 1 >= argc)
+            return false;
+        std::string value = argv[++i];
+
+        if (arg == "--matches") { if (!parseArg(value, o.matches, 1, 9999)) return false; }
+        else if (arg == "--parallel") { if (!parseArg(value, o.parallel, 1, 1024)) return false; }
+        else if (arg == "--cores-per-match") { if (!parseArg(value, o.coresPerMatch, 0, CPU_SETSIZE)) return false; }
+        else if (arg == "--player") o.player = value;
+        else if (arg == "--right-player") o.rightPlayer = value;
+        else if (arg == "--player-args") o.playerArgs = value;
+        else if (arg == "--server-cmd") o.serverCmd = value;
+        else if (arg == "--base-port") { if (!parseArg<std::uint16_t>(value, o.basePort, 1)) return false; }
+        else if (arg == "--startup-ms") { if (!parseArg(value, o.startupMs, 0, 600'000)) return false; }
+        else if (arg == "--timeout") { if (!parseArg(value, o.timeoutSec, 0.0)) return false; }
+        else if (arg == "--out") o.outDir = value;
+        else if (arg == "--teams") {
+            auto comma = value.find(',');
+            if (comma == std::string::npos)
+                return false;
+            o.teams[0] = value.substr(0, comma);
+            o.teams[1] = value.substr(comma + 1);
+        } else {
+            return false;
+        }
+    }
+    return o.matches > 0 && o.parallel > 0 && o.timeoutSec > 0 && o.teams[0] != o.teams[1];
+}
+
+int main(int argc, char *argv[])
+{
+    TournamentOptions options;
+    if (!parseOptions(argc, argv, options)) {
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    struct sigaction sa{};
+    sa.sa_handler = [](int) { interrupted = 1; };
+    sigaction(SIGINT, &sa, nullptr);
+    sigaction(SIGTERM, &sa, nullptr);
+
+    Tournament tournament(options);
+    if (!tournament.prepare())
+        return 1;
+    return tournament.run();
+}
@@ -0,0 +1,113 @@
+#include "trace.h"
+#include <cstring>
+#include <fstream>
+#include <iterator>
+
+// Tamaño del búfer de stdio de la grabación
+static constexpr std::size_t TRACE_BUFFER_SIZE = 1 << 20;
+
+TraceWriter::~TraceWriter()
+{
+    close();
+}
+
+template <typename T>
+static void writeValue(std::FILE *f, T v)
+{
+    std::fwrite(&v, sizeof(v), 1, f);
+}
+
+bool TraceWriter::open(const std::string &path, const std::string &team, std::uint16_t port)
+{
+    close();
+    file_ = std::fopen(path.c_str(), "wb");
+    if (!file_)
+        return false;
+
+    buffer_.resize(TRACE_BUFFER_SIZE);
+    std::setvbuf(file_, buffer_.data(), _IOFBF, buffer_.size());
+
+    std::fwrite(TRACE_MAGIC, sizeof(TRACE_MAGIC), 1, file_);
+    writeValue(file_, TRACE_VERSION);
+    writeValue(file_, port);
+    writeValue(file_, static_cast<std::uint16_t>(team.size()));
+    std::fwrite(team.data(), 1, team.size(), file_);
+    return true;
+}
+
+void TraceWriter::close()
+{
+    if (file_) {
+        std::fclose(file_);
+        file_ = nullptr;
+    }
+}
+
+void TraceWriter::record(TraceDirection dir, std::int64_t timestampNs, std::string_view data)
+{
+    if (!file_)
+        return;
+
+    // Los datagramas del servidor llegan con '\0' final: no se graba
+    while (!data.empty() && data.back() == '\0')
+        data.remove_suffix(1);
+
+    writeValue(file_, timestampNs);
+    writeValue(file_, static_cast<std::uint32_t>(data.size()));
+    writeValue(file_, static_cast<std::uint8_t>(dir));
+    std::fwrite(data.data(), 1, data.size(), file_);
+}
+
+void TraceWriter::flush()
+{
+    if (file_)
+        std::fflush(file_);
+}
+
+template <typename T>
+static bool readValue(const std::string &s, std::size_t &pos, T &out)
+{
+    if (s.size() - pos < sizeof(T))
+        return false;
+    std::memcpy(&out, s.data() + pos, sizeof(T));
+    pos += sizeof(T);
+    return true;
+}
+
+bool TraceReader::load(const std::string &path)
+{
+    std::ifstream in(path, std::ios::binary);
+    if (!in)
+        return false;
+    contents_.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+    records_.clear();
+
+    std::size_t pos = 0;
+    std::uint32_t version = 0;
+    std::uint16_t teamLen = 0;
+    if (contents_.size() < sizeof(TRACE_MAGIC) ||
+        std::memcmp(contents_.data(), TRACE_MAGIC, sizeof(TRACE_MAGIC)) != 0)
+        return false;
+    pos = sizeof(TRACE_MAGIC);
+    if (!readValue(contents_, pos, version) || version != TRACE_VERSION ||
+        !readValue(contents_, pos, port_) || !readValue(contents_, pos, teamLen) ||
+        contents_.size() - pos < teamLen)
+        return false;
+    team_.assign(contents_.data() + pos, teamLen);
+    pos += teamLen;
+
+    // Un registro truncado al final (proceso interrumpido) se ignora
+    while (pos < contents_.size()) {
+        TraceRecord rec{};
+        std::uint32_t len = 0;
+        std::uint8_t dir = 0;
+        if (!readValue(contents_, pos, rec.timestampNs) || !readValue(contents_, pos, len) ||
+            !readValue(contents_, pos, dir) || contents_.size() - pos < len)
+            break;
+        rec.dir = static_cast<TraceDirection>(dir);
+        rec.data = std::string_view(contents_.data() + pos, len);
+        pos += len;
+        records_.push_back(rec);
+    }
+    return true;
+}
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Grabación binaria del tráfico de un agente, para reproducirlo sin servidor
+// (player_replay). Formato:
+//   cabecera: "RSTRACE" '\0', versión (u32), puerto (u16), longitud del equipo (u16), equipo
+//   registros: timestamp ns (i64), longitud (u32), dirección (u8), datos sin '\0' final
+enum class TraceDirection : std::uint8_t
+{
+    In,     // Datagrama del servidor entregado al agente
+    Out     // Comandos del ciclo enviados tras decidir
+};
+
+inline constexpr char TRACE_MAGIC[8] = {'R', 'S', 'T', 'R', 'A', 'C', 'E', '\0'};
+inline constexpr std::uint32_t TRACE_VERSION = 1;
+
+class TraceWriter
+{
+public:
+    TraceWriter() = default;
+    ~TraceWriter();
+    TraceWriter(const TraceWriter &) = delete;
+    TraceWriter &operator=(const TraceWriter &) = delete;
+
+    // Crea el fichero y escribe la cabecera; devuelve false si no se puede abrir
+    bool open(const std::string &path, const std::string &team, std::uint16_t port);
+    void close();
+    bool isOpen() const { return file_ != nullptr; }
+
+    // No hace nada si la grabación no está abierta
+    void record(TraceDirection dir, std::int64_t timestampNs, std::string_view data);
+
+    // Vuelca el búfer al fichero (una vez por ciclo, para no perder la cola si se mata el proceso)
+    void flush();
+
+private:
+    std::FILE *file_{nullptr};
+    std::vector<char> buffer_;
+};
+
+struct TraceRecord
+{
+    std::int64_t timestampNs;
+    TraceDirection dir;
+    std::string_view data;  // Vista sobre el contenido cargado por TraceReader
+};
+
+// Carga una grabación entera en memoria
+class TraceReader
+{
+public:
+    // Devuelve false si el fichero no existe o no es una grabación válida
+    bool load(const std::string &path);
+
+    const std::string &team() const { return team_; }
+    std::uint16_t port() const { return port_; }
+    const std::vector<TraceRecord> &records() const { return records_; }
+
+private:
+    std::string contents_;
+    std::string team_;
+    std::uint16_t port_{0};
+    std::vector<TraceRecord> records_;
+};
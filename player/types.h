@@ -1,7 +1,12 @@
 #pragma once
 
+#include <array>
+#include <cstddef>
+#include <cstdint>
 #include <iostream>
+#include <span>
 #include <string>
+#include <string_view>
 #include <map>
 
 
@@ -11,51 +16,82 @@ enum class Side
     Left, Right, Unknown 
 };
 
-inline std::ostream& operator<<(std::ostream& os, Side s)
+constexpr const char *toString(Side s)
 {
     switch (s) {
-        case Side::Left:    os << "Left"; break;
-        case Side::Right:   os << "Right"; break;
-        default:            os << "Unknown"; break;
+        case Side::Left:    return "Left";
+        case Side::Right:   return "Right";
+        default:            return "Unknown";
     }
-    return os;
 }
 
-// Representa el modo de juego actual
-enum class PlayMode
+inline std::ostream& operator<<(std::ostream& os, Side s)
+{
+    return os << toString(s);
+}
+
+// Modo de juego visto desde nuestro equipo: el decodificador del árbitro
+// (referee.h) ya resuelve los sufijos _l/_r a nuestro/suyo según el lado.
+enum class PlayMode : std::uint8_t
 {
-    Unknown, BeforeKickOff, PlayOn,
-    KickOff_Left, KickOff_Right,
-    KickIn_Left, KickIn_Right,
-    Corner_Left, Corner_Right,
-    GoalKick_Left, GoalKick_Right,
-    Goal_Left, Goal_Right,
-    FreeKick_Left, FreeKick_Right,
-    PenaltyKick_Left, PenaltyKick_Right
+    Unknown,
+    BeforeKickOff, PlayOn, TimeOver, DropBall, FirstHalfOver, Pause, HumanJudge,
+    PenaltyOnField, PenaltyDraw,
+    // Saques y estados a favor de un equipo (Our: nuestro saque, nuestro gol...)
+    OurKickOff, TheirKickOff,
+    OurKickIn, TheirKickIn,
+    OurFreeKick, TheirFreeKick,
+    OurIndirectFreeKick, TheirIndirectFreeKick,
+    OurCorner, TheirCorner,
+    OurGoalKick, TheirGoalKick,
+    OurGoalieCatch, TheirGoalieCatch,
+    OurGoal, TheirGoal,
+    OurPenaltyKick, TheirPenaltyKick,
+    OurPenaltySetup, TheirPenaltySetup,
+    OurPenaltyReady, TheirPenaltyReady,
+    OurPenaltyTaken, TheirPenaltyTaken,
+    OurPenaltyMiss, TheirPenaltyMiss,
+    OurPenaltyScore, TheirPenaltyScore,
+    OurPenaltyWinner, TheirPenaltyWinner,
+    // Infracciones, según quién la comete (el saque siguiente es del otro equipo)
+    FoulByUs, FoulByThem,
+    OffsideByUs, OffsideByThem,
+    BackPassByUs, BackPassByThem,
+    FreeKickFaultByUs, FreeKickFaultByThem,
+    CatchFaultByUs, CatchFaultByThem,
+    IllegalDefenseByUs, IllegalDefenseByThem,
+    PenaltyFoulByUs, PenaltyFoulByThem,
+    Count
 };
 
+inline constexpr std::size_t PLAY_MODE_COUNT = static_cast<std::size_t>(PlayMode::Count);
+
+inline constexpr std::array<std::string_view, PLAY_MODE_COUNT> PLAY_MODE_NAMES = {
+    "Unknown", "BeforeKickOff", "PlayOn", "TimeOver",
+    "DropBall", "FirstHalfOver", "Pause", "HumanJudge",
+    "PenaltyOnField", "PenaltyDraw", "OurKickOff", "TheirKickOff",
+    "OurKickIn", "TheirKickIn", "OurFreeKick", "TheirFreeKick",
+    "OurIndirectFreeKick", "TheirIndirectFreeKick", "OurCorner", "TheirCorner",
+    "OurGoalKick", "TheirGoalKick", "OurGoalieCatch", "TheirGoalieCatch",
+    "OurGoal", "TheirGoal", "OurPenaltyKick", "TheirPenaltyKick",
+    "OurPenaltySetup", "TheirPenaltySetup", "OurPenaltyReady", "TheirPenaltyReady",
+    "OurPenaltyTaken", "TheirPenaltyTaken", "OurPenaltyMiss", "TheirPenaltyMiss",
+    "OurPenaltyScore", "TheirPenaltyScore", "OurPenaltyWinner", "TheirPenaltyWinner",
+    "FoulByUs", "FoulByThem", "OffsideByUs", "OffsideByThem",
+    "BackPassByUs", "BackPassByThem", "FreeKickFaultByUs", "FreeKickFaultByThem",
+    "CatchFaultByUs", "CatchFaultByThem", "IllegalDefenseByUs", "IllegalDefenseByThem",
+    "PenaltyFoulByUs", "PenaltyFoulByThem"
+};
+
+constexpr std::string_view toString(PlayMode pm)
+{
+    auto i = static_cast<std::size_t>(pm);
+    return i < PLAY_MODE_COUNT ? PLAY_MODE_NAMES[i] : PLAY_MODE_NAMES[0];
+}
+
 inline std::ostream& operator<<(std::ostream& os, PlayMode pm)
 {
-    switch (pm) {
-        case PlayMode::BeforeKickOff:   os << "BeforeKickOff";  break;
-        case PlayMode::PlayOn:          os << "PlayOn";         break;
-        case PlayMode::KickOff_Left:    os << "KickOff_Left";   break;
-        case PlayMode::KickOff_Right:   os << "KickOff_Right";  break;
-        case PlayMode::KickIn_Left:     os << "KickIn_Left";    break;
-        case PlayMode::KickIn_Right:    os << "KickIn_Right";   break;
-        case PlayMode::Corner_Left:     os << "Corner_Left";    break;
-        case PlayMode::Corner_Right:    os << "Corner_Right";   break;
-        case PlayMode::GoalKick_Left:   os << "GoalKick_Left";  break;
-        case PlayMode::GoalKick_Right:  os << "GoalKick_Right"; break;
-        case PlayMode::Goal_Left:       os << "Goal_Left";      break;
-        case PlayMode::Goal_Right:      os << "Goal_Right";     break;
-        case PlayMode::FreeKick_Left:    os << "FreeKick_Left";   break;
-        case PlayMode::FreeKick_Right:   os << "FreeKick_Right";  break;
-        case PlayMode::PenaltyKick_Left:  os << "PenaltyKick_Left"; break;
-        case PlayMode::PenaltyKick_Right: os << "PenaltyKick_Right";break;
-        default:                        os << "Unknown";        break;
-    }
-    return os;
+    return os << toString(pm);
 }
 
 // Coordenadas 2D en el campo
@@ -75,12 +111,16 @@ struct Zona {
     double x_min, x_max, y_min, y_max;
 };
 
+// Identificador compacto de bandera: índice en FLAG_TABLE (flags.h)
+using FlagId = std::uint8_t;
+inline constexpr FlagId FLAG_NONE = 0xFF;
+
 struct FlagInfo {
-    std::string name;
-    double dist;
-    double dir;
-    bool visible;
-    Point pos; // coordenadas absolutas desde FLAG_POSITIONS
+    FlagId id{FLAG_NONE};
+    double dist{0.0};
+    double dir{0.0};
+    bool visible{false};
+    Point pos; // coordenadas absolutas desde FLAG_TABLE
 };
 
 // Información sobre un objeto visto: distancia, dirección y visibilidad
@@ -89,6 +129,9 @@ struct ObjectInfo
     double dist{0.0};     // Distancia al objeto
     double dir{0.0};      // Dirección en grados
     bool visible{false};  // Si el objeto es visible
+    bool hasChange{false};  // El servidor envió distChange y dirChange (objeto cercano)
+    double distChange{0.0}; // Variación radial de la distancia (m/ciclo)
+    double dirChange{0.0};  // Variación de la dirección (grados/ciclo)
 };
 
 inline std::ostream& operator<<(std::ostream& os, const ObjectInfo& o)
@@ -99,13 +142,78 @@ inline std::ostream& operator<<(std::ostream& os, const ObjectInfo& o)
     return os;
 }
 
+// Línea del campo vista, ej: ((l r) 30.2 -80)
+struct LineInfo
+{
+    char side{'\0'};     // 'l', 'r', 't' o 'b'
+    double dist{0.0};
+    double dir{0.0};
+};
+
+// Equipo de un jugador visto respecto al nuestro
+enum class TeamSide
+{
+    Unknown, Own, Opp
+};
+
+// Datos presentes en la observación de un jugador (bits combinables)
+enum SeenPlayerFields : std::uint8_t
+{
+    SEEN_NONE     = 0,
+    SEEN_GOALIE   = 1 << 0,
+    SEEN_CHANGE   = 1 << 1,   // distChange y dirChange
+    SEEN_FACING   = 1 << 2,   // bodyDir y headDir
+    SEEN_POINTING = 1 << 3,   // pointDir
+    SEEN_TACKLING = 1 << 4,   // marcador 't'
+    SEEN_KICKING  = 1 << 5,   // marcador 'k'
+    SEEN_CARD     = 1 << 6    // marcador 'y' o 'r': tarjeta
+};
+
+// Jugadores vistos en un see, ej: ((p "RealSuciedad" 7 goalie) 12.2 -30 0.1 2 45 60 -10 t)
+// Estructura de arrays: cada campo es una columna contigua de capacidad fija
+// que se reutiliza en cada see (clear() sólo pone el tamaño a cero), así que
+// rellenarla no reserva memoria. Las direcciones van en el convenio del servidor.
+struct SeenPlayers
+{
+    static constexpr std::size_t CAPACITY = 22;
+
+    std::size_t size{0};
+    std::array<TeamSide, CAPACITY> team{};
+    std::array<std::int8_t, CAPACITY> number{};     // -1 si el dorsal no se distingue
+    std::array<std::uint8_t, CAPACITY> fields{};    // SEEN_*
+    std::array<double, CAPACITY> dist{};
+    std::array<double, CAPACITY> dir{};
+    std::array<double, CAPACITY> distChange{};
+    std::array<double, CAPACITY> dirChange{};
+    std::array<double, CAPACITY> bodyDir{};         // orientación del cuerpo respecto a nuestra cara
+    std::array<double, CAPACITY> headDir{};         // orientación de la cabeza respecto a nuestra cara
+    std::array<double, CAPACITY> pointDir{};        // dirección a la que señala con el brazo
+
+    void clear() { size = 0; }
+    bool full() const { return size == CAPACITY; }
+    bool has(std::size_t i, SeenPlayerFields f) const { return (fields[i] & f) != 0; }
+};
+
 // Información visual del jugador en un instante dado
 struct SeeInfo
 {
+    static constexpr std::size_t MAX_FLAGS = 64;
+    static constexpr std::size_t MAX_LINES = 4;
+
     int time{0};              // Tiempo de simulación
     ObjectInfo ball{};        // Información del balón
     ObjectInfo ownGoal{};    // Información de portería propia
     ObjectInfo oppGoal{};    // Información de portería rival
+
+    // Objetos vistos en el mismo ciclo (capacidad fija, sin memoria dinámica)
+    std::array<FlagInfo, MAX_FLAGS> flags{};
+    std::size_t numFlags{0};
+    std::array<LineInfo, MAX_LINES> lines{};
+    std::size_t numLines{0};
+    SeenPlayers players{};
+
+    std::span<const FlagInfo> visibleFlags() const { return {flags.data(), numFlags}; }
+    std::span<const LineInfo> visibleLines() const { return {lines.data(), numLines}; }
 };
 
 inline std::ostream& operator<<(std::ostream& os, const SeeInfo& s)
@@ -114,29 +222,171 @@ inline std::ostream& operator<<(std::ostream& os, const SeeInfo& s)
        << ", ball=" << s.ball
        << ", ownGoal=" << s.ownGoal
        << ", oppGoal=" << s.oppGoal
+       << ", flags=" << s.numFlags
+       << ", lines=" << s.numLines
+       << ", players=" << s.players.size
        << ")";
     return os;
 }
 
+// Modo de visión (change_view)
+enum class ViewQuality { High, Low };
+enum class ViewWidth { Narrow, Normal, Wide };
+
+// Medio ángulo del cono de visión de cada anchura, en grados (visible_angle 90 en normal)
+constexpr double viewHalfAngle(ViewWidth w)
+{
+    return w == ViewWidth::Narrow ? 30.0 : w == ViewWidth::Wide ? 90.0 : 60.0;
+}
+
+// Contadores de comandos ejecutados que informa sense_body
+struct CommandCounters
+{
+    int kick{0};
+    int dash{0};
+    int turn{0};
+    int say{0};
+    int turnNeck{0};
+    int catch_{0};
+    int move{0};
+    int changeView{0};
+    int changeFocus{0};
+};
+
+// Estado del brazo (pointto)
+struct ArmInfo
+{
+    int movable{0};       // Ciclos hasta que se puede volver a mover
+    int expires{0};       // Ciclos hasta que deja de señalar
+    double targetDist{0.0};
+    double targetDir{0.0};
+    int count{0};
+};
+
+// Jugador en el que está fijada la atención (attentionto)
+struct FocusInfo
+{
+    char side{'\0'};      // 'l', 'r' o '\0' si no hay
+    int number{-1};
+    int count{0};
+};
+
+// Colisiones del último ciclo (bits combinables)
+enum CollisionFlags : std::uint8_t
+{
+    COLLISION_NONE   = 0,
+    COLLISION_BALL   = 1 << 0,
+    COLLISION_PLAYER = 1 << 1,
+    COLLISION_POST   = 1 << 2
+};
+
 // Información sensorial interna del jugador
 struct SenseInfo 
 {
     int time{0};              // Tiempo de simulación
-    double speed{0.0};        // Velocidad actual
+    ViewQuality viewQuality{ViewQuality::High};
+    ViewWidth viewWidth{ViewWidth::Normal};
     double stamina{0.0};      // Resistencia actual
-    double headAngle{0.0};    // Ángulo de la cabeza
+    double effort{0.0};       // Eficacia del dash (0..1)
+    double capacity{0.0};     // Reserva de resistencia del partido
+    double speed{0.0};        // Velocidad actual
+    double speedDir{0.0};     // Dirección de la velocidad respecto a la cara (grados)
+    double headAngle{0.0};    // Ángulo de la cabeza respecto al cuerpo
+    CommandCounters counters{};
+    ArmInfo arm{};
+    FocusInfo focus{};
+    int tackleExpires{0};
+    int tackleCount{0};
+    std::uint8_t collision{COLLISION_NONE};
+    int foulCharged{0};
+    char card{'n'};           // 'n' (ninguna), 'y' (amarilla) o 'r' (roja)
 };
 
 inline std::ostream& operator<<(std::ostream& os, const SenseInfo& s)
 {
     os << "SenseInfo(time=" << s.time
-       << ", speed=" << s.speed
        << ", stamina=" << s.stamina
+       << ", effort=" << s.effort
+       << ", speed=" << s.speed
+       << ", speedDir=" << s.speedDir
        << ", headAngle=" << s.headAngle
        << ")";
     return os;
 }
 
+// Parámetros del servidor que usan los modelos de movimiento (server_param y
+// player_param); los valores por defecto son los de rcssserver v19
+struct ServerParams
+{
+    double ballDecay{0.94};
+    double ballSize{0.085};
+    double ballSpeedMax{3.0};
+    double maxPower{100.0};
+    double maxMoment{180.0};
+    double kickPowerRate{0.027};
+    int playerTypes{18};      // player_param: número de tipos heterogéneos
+
+    bool operator==(const ServerParams &) const = default;
+};
+
+// Tipo de jugador (player_type); el tipo 0 es el que usa todo el equipo sin entrenador
+struct PlayerTypeParams
+{
+    int id{0};
+    double playerSpeedMax{1.05};
+    double playerDecay{0.4};
+    double inertiaMoment{5.0};
+    double dashPowerRate{0.006};
+    double playerSize{0.3};
+    double kickableMargin{0.7};
+    double effortMax{1.0};
+
+    bool operator==(const PlayerTypeParams &) const = default;
+};
+
+inline constexpr std::size_t MAX_PLAYER_TYPES = 18;
+
+// Lo que cuentan los compañeros por say (hear ... our N "..."), en coordenadas absolutas
+struct HeardMate
+{
+    Point pos{};
+    int time{-1};             // Ciclo de la posición (-1: nunca oído)
+    int claimArrival{-1};     // Ciclo absoluto en el que dice que llega al balón
+};
+
+struct HeardOpponent
+{
+    Point pos{};
+    std::int8_t number{-1};   // -1 si el dorsal no se distinguía
+    int time{-1};
+};
+
+struct HeardInfo
+{
+    static constexpr std::size_t MAX_OPPONENTS = 11;
+
+    // Balón según el compañero que lo vio más recientemente
+    Point ballPos{};
+    Point ballVel{};
+    int ballTime{-1};
+    int ballSender{-1};
+
+    std::array<HeardMate, 12> mates{};   // por dorsal (1..11)
+    std::array<HeardOpponent, MAX_OPPONENTS> opponents{};
+    std::size_t opponentCount{0};
+};
+
+// Consejo del entrenador en línea (hear ... online_coach_left|right ...), en
+// coordenadas propias: x positiva hacia la portería rival
+struct CoachAdvice
+{
+    int time{-1};                  // Ciclo en que se oyó (-1: nunca)
+    double offsideLine{0.0};       // Penúltimo defensor rival en el ciclo del consejo
+    int possession{50};            // Posesión propia (%)
+    std::array<std::int8_t, 3> opponentLines{};   // Rivales de campo en defensa, medio y ataque
+    int setPieceZone{-1};          // Zona 0..8 (tercio * 3 + carril) a la que más sacan los rivales
+};
+
 // Información completa del jugador
 struct PlayerInfo 
 {
@@ -145,7 +395,13 @@ struct PlayerInfo
     int number{-1};
     SeeInfo see{};
     SenseInfo sense{};
+    HeardInfo heard{};
+    CoachAdvice advice{};
     Point initialPosition{};  // Posición inicial asignada según el dorsal
+    Point ballPos{};          // Última posición absoluta conocida del balón (para la formación)
+    Point ballVel{};          // Velocidad estimada del balón (m/ciclo), nula si no se conoce
+    std::uint8_t playerType{0};                 // player_type propio (change_player_type)
+    std::array<std::uint8_t, 12> mateTypes{};   // player_type de los compañeros por dorsal
 
     // posición absoluta
     float x_abs{0.0f};
@@ -0,0 +1,151 @@
+#include "view.h"
+#include "intercept.h"
+#include "positions.h"
+#include <algorithm>
+#include <cmath>
+
+static constexpr double DEG = M_PI / 180.0;
+
+// Error de posición del balón recién visto (cuantización del see) y lo que
+// crece por cada ciclo sin verlo, en metros
+static constexpr double BALL_ERROR_BASE = 0.5;
+static constexpr double BALL_ERROR_PER_CYCLE = 0.3;
+
+// visible_distance: por debajo se percibe el balón aunque quede fuera del cono
+static constexpr double VISIBLE_DISTANCE = 3.0;
+
+// Con el balón más lejos no compensa la vista estrecha: vale más ver el campo
+static constexpr double BALL_FAR_DIST = 40.0;
+
+// Rivales que se vigilan con la holgura del cono
+static constexpr double OPPONENT_WATCH_DIST = 20.0;
+static constexpr double OPPONENT_MATCH_DIST = 3.0;   // mismo rival sin dorsal entre dos see
+static constexpr int OPPONENT_MAX_AGE = 30;          // ciclos tras los que se olvida un avistamiento
+
+// Giros de cuello menores no se envían
+static constexpr double NECK_MIN_TURN = 1.0;
+
+void ViewScheduler::onSee(const PlayerInfo &player)
+{
+    const SeenPlayers &seen = player.see.players;
+    const int time = player.see.time;
+    lastSeeTime_ = time;
+
+    for (std::size_t i = 0; i < seen.size; ++i) {
+        if (seen.team[i] != TeamSide::Opp)
+            continue;
+        Point pos = seenPlayerPosition(player, i);
+        std::int8_t number = seen.number[i];
+
+        // El mismo dorsal, si no el avistamiento cercano sin dorsal, si no el más antiguo
+        Opponent *slot = nullptr;
+        double best = OPPONENT_MATCH_DIST;
+        for (Opponent &o : opponents_) {
+            if (number >= 0 && o.number == number) {
+                slot = &o;
+                break;
+            }
+            double d = std::hypot(o.pos.x - pos.x, o.pos.y - pos.y);
+            if (o.time >= 0 && (number < 0 || o.number < 0) && d < best) {
+                best = d;
+                slot = &o;
+            }
+        }
+        if (!slot)
+            slot = &*std::min_element(opponents_.begin(), opponents_.end(),
+                                      [](const Opponent &a, const Opponent &b) { return a.time < b.time; });
+        *slot = Opponent{pos, time, number >= 0 ? number : slot->number};
+    }
+}
+
+const ViewScheduler::Opponent *ViewScheduler::stalestOpponent(Point self, int time) const
+{
+    const Opponent *stalest = nullptr;
+    int stalestAge = 0;
+    for (const Opponent &o : opponents_) {
+        int age = time - o.time;
+        if (o.time < 0 || age > OPPONENT_MAX_AGE || std::hypot(o.pos.x - self.x, o.pos.y - self.y) > OPPONENT_WATCH_DIST)
+            continue;
+        if (age > stalestAge) {
+            stalest = &o;
+            stalestAge = age;
+        }
+    }
+    return stalest;
+}
+
+void ViewScheduler::decide(const PlayerInfo &player, const MotionModel &motion, CommandFrame &frame)
+{
+    const BallEstimate &ball = motion.ball();
+    const SenseInfo &sense = player.sense;
+    const int next = sense.time + 1;
+
+    // Cuerpo y posición al comienzo del próximo ciclo, cuando llega el see
+    double body = player.dir_abs;
+    if (frame.body.type == CommandType::Turn)
+        body = normalizaAngulo(body - frame.body.a / (1.0 + motion.playerType().inertiaMoment * sense.speed));
+    double v = (player.dir_abs - sense.headAngle - sense.speedDir) * DEG;
+    Point self{player.x_abs + sense.speed * std::cos(v), player.y_abs + sense.speed * std::sin(v)};
+
+    // Cara respecto al cuerpo (antihoraria) y anchura para el próximo see
+    ViewWidth width = ViewWidth::Wide;
+    double face;
+    if (ball.valid) {
+        Point b{ball.pos.x + ball.vel.x, ball.pos.y + ball.vel.y};
+        double dist = std::hypot(b.x - self.x, b.y - self.y);
+        double ballRel = normalizaAngulo(std::atan2(b.y - self.y, b.x - self.x) / DEG - body);
+        double err = BALL_ERROR_BASE + BALL_ERROR_PER_CYCLE * (next - ball.time);
+        bool felt = dist + err < VISIBLE_DISTANCE;
+        double margin = felt ? 0.0 : dist > err ? std::asin(err / dist) / DEG : 90.0;
+
+        // La anchura más estrecha en la que el balón cabe con su margen; lo..hi
+        // son las caras que lo dejan dentro del cono
+        double lo = -NECK_MAX_ANGLE, hi = NECK_MAX_ANGLE;
+        bool fits = false;
+        for (ViewWidth w : {ViewWidth::Narrow, ViewWidth::Normal, ViewWidth::Wide}) {
+            if (w == ViewWidth::Narrow && dist > BALL_FAR_DIST)
+                continue;
+            if (felt) {
+                width = w;
+                fits = true;
+                break;
+            }
+            double slack = viewHalfAngle(w) - margin;
+            double l = std::max(ballRel - slack, -NECK_MAX_ANGLE);
+            double h = std::min(ballRel + slack, NECK_MAX_ANGLE);
+            if (slack >= 0.0 && l <= h) {
+                width = w;
+                lo = l;
+                hi = h;
+                fits = true;
+                break;
+            }
+        }
+
+        face = std::clamp(ballRel, -NECK_MAX_ANGLE, NECK_MAX_ANGLE);
+        if (fits) {
+            if (const Opponent *o = stalestOpponent(self, next)) {
+                double oppRel = normalizaAngulo(std::atan2(o->pos.y - self.y, o->pos.x - self.x) / DEG - body);
+                face = std::clamp(oppRel, lo, hi);
+            } else {
+                face = std::clamp(ballRel, lo, hi);
+            }
+        }
+    } else {
+        // Sin balón: vista amplia y el cuello a un lado, al otro tras cada see.
+        // El barrido empieza hacia donde se vio por última vez.
+        if (!searching_ && ball.time >= 0)
+            searchSide_ = normalizaAngulo(std::atan2(ball.pos.y - self.y, ball.pos.x - self.x) / DEG - body) < 0.0 ? -1.0 : 1.0;
+        else if (lastSeeTime_ == sense.time)
+            searchSide_ = -searchSide_;
+        face = searchSide_ * NECK_MAX_ANGLE;
+    }
+    searching_ = !ball.valid;
+
+    // El servidor mide el cuello en sentido horario: cara = cuerpo - cuello
+    double turn = -face - sense.headAngle;
+    if (std::fabs(turn) >= NECK_MIN_TURN)
+        frame.turnNeck = Command::turnNeck(turn);
+    if (width != sense.viewWidth || sense.viewQuality != ViewQuality::High)
+        frame.changeView = Command::changeView(width, ViewQuality::High);
+}
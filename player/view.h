@@ -0,0 +1,50 @@
+#pragma once
+
+#include "types.h"
+#include "command.h"
+#include "motion.h"
+#include <array>
+#include <cstdint>
+
+// Planificador de la percepción: en cada ciclo elige la anchura de vista y
+// hacia dónde mira el cuello, con independencia del cuerpo.
+//
+// Con (synch_see) el servidor manda el see junto al sense_body, al comienzo
+// del ciclo, cada 1, 2 o 3 ciclos según la anchura (estrecha, normal o
+// amplia): cuanto más estrecha la vista, más sees y menos campo. Se elige la
+// anchura más estrecha en la que cabe el balón con su incertidumbre (que crece
+// con los ciclos sin verlo) girando el cuello hasta NECK_MAX_ANGLE, y la
+// holgura que queda dentro del cono desplaza la cara hacia el rival cercano
+// visto hace más tiempo. Sin balón conocido se abre la vista y el cuello barre
+// a uno y otro lado.
+
+// Ángulo máximo del cuello respecto al cuerpo (maxneckang; minneckang = -maxneckang)
+inline constexpr double NECK_MAX_ANGLE = 90.0;
+
+class ViewScheduler
+{
+public:
+    // Tras cada see, con la pose y el balón ya actualizados: anota los rivales vistos
+    void onSee(const PlayerInfo &player);
+
+    // Con el comando de cuerpo del ciclo ya en frame, añade el turn_neck y el
+    // change_view que orientan el próximo see (balón e inercia, de motion)
+    void decide(const PlayerInfo &player, const MotionModel &motion, CommandFrame &frame);
+
+private:
+    // Último avistamiento de un rival (posición absoluta)
+    struct Opponent
+    {
+        Point pos{};
+        int time{-1};
+        std::int8_t number{-1};   // -1 si el dorsal no se distinguía
+    };
+
+    // Rival cercano a self visto hace más tiempo (nullptr si no hay ninguno que vigilar)
+    const Opponent *stalestOpponent(Point self, int time) const;
+
+    std::array<Opponent, 11> opponents_{};
+    int lastSeeTime_{-1};
+    double searchSide_{1.0};      // lado del barrido del cuello sin balón (+1 izquierda, -1 derecha)
+    bool searching_{false};       // el ciclo anterior ya se buscaba el balón
+};